@@ -55,6 +55,9 @@
 #include <crypto_hash.h>
 #include <malloc.h>
 #include <boot_stats.h>
+#include <init_graph.h>
+#include <lib/evtrace.h>
+#include <lib/bio.h>
 #include <sha.h>
 #include <platform/iomap.h>
 #include <platform/msm_shared.h>
@@ -82,6 +85,7 @@
 #include "recovery.h"
 #include "bootimg.h"
 #include "fastboot.h"
+#include "prefetch.h"
 #include "sparse_format.h"
 #include "mmc.h"
 #include "devinfo.h"
@@ -194,26 +198,14 @@ struct atag_ptbl_entry
 };
 
 /*
- * Partition info, required to be published
- * for fastboot
+ * Partitions whose type is published for fastboot and which are
+ * listed by getvar:all. The size of any partition can be queried.
  */
-struct getvar_partition_info {
-	const char part_name[MAX_GPT_NAME_SIZE]; /* Partition name */
-	char getvar_size[MAX_GET_VAR_NAME_SIZE]; /* fastboot get var name for size */
-	char getvar_type[MAX_GET_VAR_NAME_SIZE]; /* fastboot get var name for type */
-	char size_response[MAX_RSP_SIZE];        /* fastboot response for size */
-	char type_response[MAX_RSP_SIZE];        /* fastboot response for type */
-};
-
-/*
- * Right now, we are publishing the info for only
- * three partitions
- */
-struct getvar_partition_info part_info[] =
+static const char *getvar_partitions[] =
 {
-	{ "system"  , "partition-size:", "partition-type:", "", "ext4" },
-	{ "userdata", "partition-size:", "partition-type:", "", "ext4" },
-	{ "cache"   , "partition-size:", "partition-type:", "", "ext4" },
+	"system",
+	"userdata",
+	"cache",
 };
 
 char max_download_size[MAX_RSP_SIZE];
@@ -243,6 +235,31 @@ void update_ker_tags_rdisk_addr(struct boot_img_hdr *hdr, bool is_arm64)
 #endif
 }
 
+#if DISPLAY_SPLASH_SCREEN
+static void aboot_display_init(void)
+{
+	dprintf(SPEW, "Display Init: Start\n");
+	target_display_init(device.display_panel);
+	dprintf(SPEW, "Display Init: Done\n");
+}
+
+/* panel power up and DSI sequencing run alongside the boot image load */
+static struct init_task display_task = {
+	.name = "display",
+	.func = aboot_display_init,
+};
+#endif
+
+/* anything that draws on the panel, names it on the kernel command line,
+ * hands it to another loader or shuts it down waits for the display task
+ * first */
+void aboot_display_join(void)
+{
+#if DISPLAY_SPLASH_SCREEN
+	init_task_join(&display_task);
+#endif
+}
+
 static void ptentry_to_tag(unsigned **ptr, struct ptentry *ptn)
 {
 	struct atag_ptbl_entry atag_ptn;
@@ -662,7 +679,9 @@ void boot_linux(void *kernel, unsigned *tags,
 	char *final_cmdline;
 #if DEVICE_TREE
 	int ret = 0;
+	int bs_dtb;
 #endif
+	int bs_scope = bs_scope_begin("boot_linux");
 
 	void (*entry)(unsigned, unsigned, unsigned*) = (entry_func_ptr*)(PA((addr_t)kernel));
 	uint32_t tags_phys = PA((addr_t)tags);
@@ -670,6 +689,8 @@ void boot_linux(void *kernel, unsigned *tags,
 
 	ramdisk = (void *)PA((addr_t)ramdisk);
 
+	aboot_display_join();
+
 	final_cmdline = update_cmdline(cmdline);
 
 #if DEVICE_TREE
@@ -677,7 +698,9 @@ void boot_linux(void *kernel, unsigned *tags,
 		dprintf(INFO, "Updating device tree: start\n");
 
 		/* Update the Device Tree */
+		bs_dtb = bs_scope_begin("dtb_fixup");
 		ret = update_device_tree((void *)tags, final_cmdline, ramdisk, ramdisk_size);
+		bs_scope_end(bs_dtb);
 		if(ret)
 		{
 			dprintf(CRITICAL, "ERROR: Updating Device Tree Failed \n");
@@ -721,6 +744,9 @@ void boot_linux(void *kernel, unsigned *tags,
 	display_server_stop();
 #endif
 
+	/* nothing drains the debug log once the kernel runs */
+	dlog_flush();
+
 	enter_critical_section();
 
 	/* do any platform specific cleanup before kernel entry */
@@ -731,6 +757,7 @@ void boot_linux(void *kernel, unsigned *tags,
 #if ARM_WITH_MMU
 	arch_disable_mmu();
 #endif
+	bs_scope_end(bs_scope);
 	bs_set_timestamp(BS_KERNEL_ENTRY);
 
 	if (IS_ARM64(kptr))
@@ -847,6 +874,7 @@ out:
 static void verify_signed_bootimg(uint32_t bootimg_addr, uint32_t bootimg_size)
 {
 	int ret;
+	int bs_scope;
 #if IMAGE_VERIF_ALGO_SHA1
 	uint32_t auth_algo = CRYPTO_AUTH_ALG_SHA1;
 #else
@@ -857,6 +885,7 @@ static void verify_signed_bootimg(uint32_t bootimg_addr, uint32_t bootimg_size)
 	device.is_tampered = 1;
 
 	dprintf(INFO, "Authenticating boot image (%d): start\n", bootimg_size);
+	bs_scope = bs_scope_begin("verify");
 
 #if VERIFIED_BOOT
 	if(bootmode==BOOTMODE_RECOVERY)
@@ -876,6 +905,7 @@ static void verify_signed_bootimg(uint32_t bootimg_addr, uint32_t bootimg_size)
 					   bootimg_size,
 					   auth_algo);
 #endif
+	bs_scope_end(bs_scope);
 	dprintf(INFO, "Authenticating boot image: done return value = %d\n", ret);
 
 	if (ret)
@@ -1077,7 +1107,7 @@ int boot_linux_from_mmc(void)
                 return -1;
 	}
 
-	if (mmc_read(ptn + offset, (uint32_t *) buf, page_size)) {
+	if (boot_prefetch_read(ptn + offset, (uint32_t *) buf, page_size)) {
 		dprintf(CRITICAL, "ERROR: Cannot read boot image header\n");
                 return -1;
 	}
@@ -1101,11 +1131,14 @@ int boot_linux_from_mmc(void)
 	 * which lives in the second page for arm64 targets.
 	 */
 
-	if (mmc_read(ptn + page_size, (uint32_t *) kbuf, page_size)) {
+	if (boot_prefetch_read(ptn + page_size, (uint32_t *) kbuf, page_size)) {
 		dprintf(CRITICAL, "ERROR: Cannot read boot image header\n");
                 return -1;
 	}
 
+	/* everything from here on is bulk image data */
+	boot_prefetch_release();
+
 	/*
 	 * Update the kernel/ramdisk/tags address if the boot image header
 	 * has default values, these default values come from mkbootimg when
@@ -1768,6 +1801,12 @@ void write_device_info_mmc(device_info *dev)
 
 	blocksize = mmc_get_device_blocksize();
 
+#if VERIFIED_BOOT
+	boot_prefetch_invalidate(ptn, blocksize);
+#else
+	boot_prefetch_invalidate(ptn + size - blocksize, blocksize);
+#endif
+
 #if VERIFIED_BOOT
 	if(mmc_write(ptn, blocksize, (void *)info_buf))
 #else
@@ -1808,9 +1847,9 @@ void read_device_info_mmc(device_info *dev)
 	blocksize = mmc_get_device_blocksize();
 
 #if VERIFIED_BOOT
-	if(mmc_read(ptn, (void *)info_buf, blocksize))
+	if(boot_prefetch_read(ptn, (void *)info_buf, blocksize))
 #else
-	if(mmc_read((ptn + size - blocksize), (void *)info_buf, blocksize))
+	if(boot_prefetch_read((ptn + size - blocksize), (void *)info_buf, blocksize))
 #endif
 	{
 		dprintf(CRITICAL, "ERROR: Cannot read device info\n");
@@ -2802,6 +2841,60 @@ void cmd_oem_lk_log(const char *arg, void *data, unsigned sz)
 }
 #endif
 
+void cmd_oem_boot_stats(const char *arg, void *data, unsigned sz)
+{
+	/* leave room for the INFO prefix */
+	char response[MAX_RSP_SIZE - 4];
+	unsigned i;
+
+	for (i = 0; i < bs_scope_count(); i++) {
+		bs_scope_format(i, response, sizeof(response));
+		fastboot_info(response);
+	}
+	fastboot_okay("");
+}
+
+static void bio_stats_info_cb(const char *name)
+{
+	/* leave room for the INFO prefix */
+	char response[MAX_RSP_SIZE - 4];
+	bdev_t *dev = bio_open(name);
+	unsigned i;
+
+	if (!dev)
+		return;
+
+	for (i = 0; bio_stats_format(dev, i, response, sizeof(response)) == 0; i++)
+		fastboot_info(response);
+
+	bio_close(dev);
+}
+
+void cmd_oem_bio_stats(const char *arg, void *data, unsigned sz)
+{
+	bio_foreach(&bio_stats_info_cb, false);
+	fastboot_okay("");
+}
+
+#if WITH_LIB_EVTRACE
+void cmd_oem_trace(const char *arg, void *unused, unsigned sz)
+{
+	size_t size = evtrace_export_size();
+	void *buf = malloc(size);
+
+	if (!buf) {
+		fastboot_fail("out of memory");
+		return;
+	}
+
+	size = evtrace_export(buf, size);
+	fastboot_send_data(buf, size);
+	free(buf);
+
+	fastboot_okay("");
+}
+#endif
+
 void cmd_oem_screenshot(const char *arg, void *unused, unsigned sz)
 {
 	struct fbcon_config* config = fbcon_display();
@@ -2822,10 +2915,81 @@ struct fbimage* splash_screen_flash(void);
 
 int splash_screen_check_header(struct fbimage *logo)
 {
-	if (memcmp(logo->header.magic, LOGO_IMG_MAGIC, 8))
+	if (memcmp(logo->header.magic, LOGO_IMG_MAGIC, 8) &&
+		memcmp(logo->header.magic, LOGO_IMG_MAGIC_PACKED, 8))
 		return -1;
 	if (logo->header.width == 0 || logo->header.height == 0)
 		return -1;
+	if (!memcmp(logo->header.magic, LOGO_IMG_MAGIC_PACKED, 8) && logo->header.size == 0)
+		return -1;
+	return 0;
+}
+
+static bool splash_screen_is_packed(struct fbimage *logo)
+{
+	return !memcmp(logo->header.magic, LOGO_IMG_MAGIC_PACKED, 8);
+}
+
+static uint8_t *splash_screen_base(struct fbimage *logo, struct fbcon_config *fb_display)
+{
+	uint8_t *base = (uint8_t *) fb_display->base;
+
+	if (logo->header.width != fb_display->width || logo->header.height != fb_display->height)
+		base += LOGO_IMG_OFFSET;
+
+	return base;
+}
+
+/* Expand a compressed payload straight into the framebuffer */
+static int splash_screen_decode(struct fbimage *logo, struct fbcon_config *fb_display,
+	const void *payload, uint8_t *base)
+{
+	uint32_t bytes_per_pixel = fb_display->bpp / 8;
+	bool swap_rb = false;
+
+#if DISPLAY_USE_BGR
+	swap_rb = true;
+#endif
+
+	if (fbcon_decode_image(logo->header.type, payload, logo->header.size, base,
+		logo->header.width * logo->header.height * bytes_per_pixel,
+		bytes_per_pixel, swap_rb)) {
+		fbcon_clear();
+		dprintf(CRITICAL, "ERROR: Cannot decode splash image\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * The payload of raw and packed images alike starts LOGO_IMG_HEADER_SIZE
+ * bytes into the splash partition. Storage is read in whole nand pages or
+ * mmc blocks, so reads start at the unit holding the payload and the rest
+ * of the header is skipped in memory.
+ */
+static uint32_t splash_screen_payload_len(struct fbimage *logo, struct fbcon_config *fb_display)
+{
+	if (splash_screen_is_packed(logo))
+		return logo->header.size;
+
+	return logo->header.width * logo->header.height * fb_display->bpp/8;
+}
+
+/* Put a payload that starts skip bytes into buf on the screen at base */
+static int splash_screen_show(struct fbimage *logo, struct fbcon_config *fb_display,
+	const uint8_t *buf, uint32_t skip, uint8_t *base)
+{
+	if (splash_screen_is_packed(logo))
+		return splash_screen_decode(logo, fb_display, buf + skip, base);
+
+	if (buf != base)
+		memcpy(base, buf + skip, splash_screen_payload_len(logo, fb_display));
+
+#if DISPLAY_USE_BGR
+	fbcon_swap_rb(base, logo->header.width * logo->header.height);
+#endif
+
 	return 0;
 }
 
@@ -2835,6 +2999,7 @@ struct fbimage* splash_screen_flash(void)
 	struct ptable *ptable;
 	struct fbcon_config *fb_display = NULL;
 	struct fbimage *logo = NULL;
+	void *payload = NULL;
 
 
 	logo = (struct fbimage *) malloc(ROUNDUP(page_size, sizeof(struct fbimage)));
@@ -2863,41 +3028,39 @@ struct fbimage* splash_screen_flash(void)
 
 	fb_display = fbcon_display();
 	if (fb_display) {
-		uint8_t *base = (uint8_t *) fb_display->base;
-		if (logo->header.width != fb_display->width || logo->header.height != fb_display->height) {
-				base += LOGO_IMG_OFFSET;
+		uint8_t *base = splash_screen_base(logo, fb_display);
+		uint32_t unit = flash_page_size();
+		uint32_t start = ROUNDDOWN(LOGO_IMG_HEADER_SIZE, unit);
+		uint32_t skip = LOGO_IMG_HEADER_SIZE - start;
+		uint32_t readsize = ROUNDUP(skip + splash_screen_payload_len(logo, fb_display), unit);
+		uint8_t *buf = base;
+
+		if (splash_screen_is_packed(logo) || skip) {
+			payload = memalign(CACHE_LINE, ROUNDUP(readsize, CACHE_LINE));
+			if (!payload) {
+				dprintf(CRITICAL, "ERROR: No memory for splash image\n");
+				goto err;
+			}
+			buf = payload;
 		}
 
-		if (flash_read(ptn + sizeof(logo->header), 0,
-			base,
-			((((logo->header.width * logo->header.height * fb_display->bpp/8) + 511) >> 9) << 9))) {
+		if (flash_read(ptn, start, buf, readsize)) {
 			fbcon_clear();
 			dprintf(CRITICAL, "ERROR: Cannot read splash image from partition\n");
 			goto err;
 		}
 
-#if DISPLAY_USE_BGR
-		unsigned i;
-		for(i=0; i<(logo->header.width*fb_display->height); i++) {
-			int r,g,b;
-			char* color = (char*) base + i*3;
-
-			r = color[0];
-			g = color[1];
-			b = color[2];
-
-			color[0] = b;
-			color[1] = g;
-			color[2] = r;
-		}
-#endif
+		if (splash_screen_show(logo, fb_display, buf, skip, base))
+			goto err;
 
+		free(payload);
 		logo->image = base;
 	}
 
 	return logo;
 
 err:
+	free(payload);
 	free(logo);
 	return NULL;
 }
@@ -2908,6 +3071,7 @@ struct fbimage* splash_screen_mmc(void)
 	unsigned long long ptn = 0;
 	struct fbcon_config *fb_display = NULL;
 	struct fbimage *logo = NULL;
+	void *payload = NULL;
 	uint32_t blocksize;
 	uint32_t readsize;
 	uint32_t ptn_size;
@@ -2931,7 +3095,7 @@ struct fbimage* splash_screen_mmc(void)
 	logo = (struct fbimage *)memalign(CACHE_LINE, ROUNDUP(readsize, CACHE_LINE));
 	ASSERT(logo);
 
-	if (mmc_read(ptn, (uint32_t *) logo, readsize)) {
+	if (boot_prefetch_read(ptn, (uint32_t *) logo, readsize)) {
 		dprintf(CRITICAL, "ERROR: Cannot read splash image header\n");
 		goto err;
 	}
@@ -2943,46 +3107,49 @@ struct fbimage* splash_screen_mmc(void)
 
 	fb_display = fbcon_display();
 	if (fb_display) {
-		uint8_t *base = (uint8_t *) fb_display->base;
-		uint32_t hdrsz = readsize;
-		readsize = ROUNDUP((logo->header.width * logo->header.height * fb_display->bpp/8), blocksize);
-		if (logo->header.width != fb_display->width || logo->header.height != fb_display->height)
-				base += LOGO_IMG_OFFSET;
+		uint8_t *base = splash_screen_base(logo, fb_display);
+		uint32_t start = ROUNDDOWN(LOGO_IMG_HEADER_SIZE, blocksize);
+		uint32_t skip = LOGO_IMG_HEADER_SIZE - start;
+		uint8_t *buf = base;
 
-		if (readsize > ptn_size)
+		readsize = ROUNDUP(skip + splash_screen_payload_len(logo, fb_display), blocksize);
+		if (start + readsize > ptn_size)
 		{
 			dprintf(CRITICAL, "@%d:Invalid logo header readsize:%u exceeds ptn_size:%u\n", __LINE__, readsize,ptn_size);
 			goto err;
 		}
 
-		if (mmc_read(ptn + hdrsz,(uint32_t *)base, readsize)) {
+		/*
+		 * Only a raw image starting on a block boundary is read in
+		 * place, a packed payload is expanded into the framebuffer
+		 * afterwards.
+		 */
+		if (splash_screen_is_packed(logo) || skip) {
+			payload = memalign(CACHE_LINE, ROUNDUP(readsize, CACHE_LINE));
+			if (!payload) {
+				dprintf(CRITICAL, "ERROR: No memory for splash image\n");
+				goto err;
+			}
+			buf = payload;
+		}
+
+		if (mmc_read(ptn + start, (uint32_t *)buf, readsize)) {
 			fbcon_clear();
 			dprintf(CRITICAL, "ERROR: Cannot read splash image from partition\n");
 			goto err;
 		}
 
-#if DISPLAY_USE_BGR
-		unsigned i;
-		for(i=0; i<(logo->header.width*fb_display->height); i++) {
-			int r,g,b;
-			char* color = (char*) base + i*3;
-
-			r = color[0];
-			g = color[1];
-			b = color[2];
-
-			color[0] = b;
-			color[1] = g;
-			color[2] = r;
-		}
-#endif
+		if (splash_screen_show(logo, fb_display, buf, skip, base))
+			goto err;
 
+		free(payload);
 		logo->image = base;
 	}
 
 	return logo;
 
 err:
+	free(payload);
 	free(logo);
 	return NULL;
 }
@@ -3001,7 +3168,7 @@ struct fbimage* fetch_image_from_partition(void)
 }
 
 /* Get the size from partiton name */
-static void get_partition_size(const char *arg, char *response)
+static int get_partition_size(const char *arg, char *response, unsigned len)
 {
 	uint64_t ptn = 0;
 	uint64_t size;
@@ -3012,7 +3179,7 @@ static void get_partition_size(const char *arg, char *response)
 	if (index == INVALID_PTN)
 	{
 		dprintf(CRITICAL, "Invalid partition index\n");
-		return;
+		return -1;
 	}
 
 	ptn = partition_get_offset(index);
@@ -3020,13 +3187,32 @@ static void get_partition_size(const char *arg, char *response)
 	if(!ptn)
 	{
 		dprintf(CRITICAL, "Invalid partition name %s\n", arg);
-		return;
+		return -1;
 	}
 
 	size = partition_get_size(index);
 
-	snprintf(response, MAX_RSP_SIZE, "\t 0x%llx", size);
-	return;
+	snprintf(response, len, "\t 0x%llx", size);
+	return 0;
+}
+
+static const char *getvar_partition_key(unsigned i)
+{
+	return i < ARRAY_SIZE(getvar_partitions) ? getvar_partitions[i] : NULL;
+}
+
+static int getvar_partition_type(const char *arg, char *response, unsigned len)
+{
+	unsigned i;
+
+	for (i = 0; i < ARRAY_SIZE(getvar_partitions); i++) {
+		if (!strcmp(arg, getvar_partitions[i])) {
+			snprintf(response, len, "ext4");
+			return 0;
+		}
+	}
+
+	return -1;
 }
 
 /*
@@ -3034,29 +3220,14 @@ static void get_partition_size(const char *arg, char *response)
  * fastboot getvar will publish the required information.
  * fastboot getvar partition_size:<partition_name>: partition size in hex
  * fastboot getvar partition_type:<partition_name>: partition type (ext/fat)
+ * Both are looked up in the partition table when asked for.
  */
-static void publish_getvar_partition_info(struct getvar_partition_info *info, uint8_t num_parts)
+static void publish_getvar_partition_info(void)
 {
-	uint8_t i;
-
-	for (i = 0; i < num_parts; i++) {
-		get_partition_size(info[i].part_name, info[i].size_response);
-
-		if (strlcat(info[i].getvar_size, info[i].part_name, MAX_GET_VAR_NAME_SIZE) >= MAX_GET_VAR_NAME_SIZE)
-		{
-			dprintf(CRITICAL, "partition size name truncated\n");
-			return;
-		}
-		if (strlcat(info[i].getvar_type, info[i].part_name, MAX_GET_VAR_NAME_SIZE) >= MAX_GET_VAR_NAME_SIZE)
-		{
-			dprintf(CRITICAL, "partition type name truncated\n");
-			return;
-		}
-
-		/* publish partition size & type info */
-		fastboot_publish((const char *) info[i].getvar_size, (const char *) info[i].size_response);
-		fastboot_publish((const char *) info[i].getvar_type, (const char *) info[i].type_response);
-	}
+	fastboot_publish_dynamic("partition-size:", get_partition_size,
+				 getvar_partition_key);
+	fastboot_publish_dynamic("partition-type:", getvar_partition_type,
+				 getvar_partition_key);
 }
 
 /* register commands and variables for fastboot */
@@ -3086,6 +3257,11 @@ void aboot_fastboot_register_commands(void)
 		{"oem device-info", cmd_oem_devinfo},
 	#if WITH_DEBUG_LOG_BUF
 		{"oem lk_log", cmd_oem_lk_log},
+	#endif
+		{"oem boot-stats", cmd_oem_boot_stats},
+		{"oem bio-stats", cmd_oem_bio_stats},
+	#if WITH_LIB_EVTRACE
+		{"oem trace", cmd_oem_trace},
 	#endif
 		{"oem screenshot", cmd_oem_screenshot},
 		{"preflash", cmd_preflash},
@@ -3113,7 +3289,7 @@ void aboot_fastboot_register_commands(void)
 	 * devices.
 	 */
 	if (target_is_emmc_boot())
-		publish_getvar_partition_info(part_info, ARRAY_SIZE(part_info));
+		publish_getvar_partition_info();
 
 	/* Max download size supported */
 	snprintf(max_download_size, MAX_RSP_SIZE, "\t0x%x",
@@ -3201,6 +3377,8 @@ void aboot_continue_boot(void) {
 			error = 1;
 			break;
 		case BOOTMODE_GRUB:
+			/* grub draws through the uboot api display calls */
+			aboot_display_join();
 			grub_boot();
 			break;
 
@@ -3211,12 +3389,17 @@ void aboot_continue_boot(void) {
 	}
 
 	if(error && !fastboot_initialized) {
+		aboot_display_join();
+
 		/* register aboot specific fastboot commands */
 		aboot_fastboot_register_commands();
 
 		/* dump partition table for debug info */
 		partition_dump();
 
+		/* flashing may rewrite anything that was prefetched */
+		boot_prefetch_release();
+
 		/* initialize and start fastboot */
 		fastboot_init(target_get_scratch_address(), target_get_max_flash_size());
 
@@ -3270,13 +3453,22 @@ void aboot_init(const struct app_descriptor *app)
 
 	ASSERT((MEMBASE + MEMSIZE) > MEMBASE);
 
+	/* pull in the headers and flags the boot decision needs in one pass */
+	if (target_is_emmc_boot())
+		boot_prefetch();
+
 	read_device_info(&device);
 
 	/* Display splash screen if enabled */
 #if DISPLAY_SPLASH_SCREEN
-	dprintf(SPEW, "Display Init: Start\n");
-	target_display_init(device.display_panel);
-	dprintf(SPEW, "Display Init: Done\n");
+#if DISPLAY_INIT_TASK
+	/* only eMMC reads are safe from two threads: ufs keeps the selected
+	 * lun in global state and the nand driver has no locking at all */
+	if (target_is_emmc_boot() && platform_boot_dev_isemmc())
+		init_task_start(&display_task);
+	else
+#endif
+		aboot_display_init();
 #endif
 
 #if BOOT_2NDSTAGE
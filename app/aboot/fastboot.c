@@ -37,6 +37,7 @@
 #include <target.h>
 #include <kernel/thread.h>
 #include <kernel/event.h>
+#include <kernel/mutex.h>
 #include <dev/udc.h>
 #include <app/aboot.h>
 #include "fastboot.h"
@@ -70,7 +71,26 @@ usb_controller_interface_t usb_if;
 #define MAX_USBFS_BULK_SIZE (32 * 1024)
 #define MAX_USBSS_BULK_SIZE (0x1000000)
 
+/*
+ * Large hsusb reads keep this many requests of FASTBOOT_HSUSB_RX_CHUNK
+ * bytes queued on the OUT endpoint, so the controller always has TDs to
+ * fill while completed chunks are accounted for.
+ */
+#ifndef FASTBOOT_HSUSB_RX_CHUNK
+#define FASTBOOT_HSUSB_RX_CHUNK (1024 * 1024)
+#endif
+#define HSUSB_RX_DEPTH 4
+
+/*
+ * Short hsusb writes (responses) are copied into one of this many
+ * preallocated requests and queued without waiting for the host to
+ * collect them, so a chatty command like getvar:all goes out as
+ * back-to-back packets instead of one round-trip per INFO line.
+ */
+#define HSUSB_TX_DEPTH 8
+
 void boot_linux(void *bootimg, unsigned sz);
+#if WITH_PLATFORM_MSM_SHARED
 static void fastboot_notify(struct udc_gadget *gadget, unsigned event);
 static struct udc_endpoint *fastboot_endpoints[2];
 
@@ -91,6 +111,7 @@ static struct udc_gadget fastboot_gadget = {
 	.ifc_string    = "fastboot",
 	.ept           = fastboot_endpoints,
 };
+#endif
 
 /* todo: give lk strtoul and nuke this */
 static unsigned hex2unsigned(const char *x)
@@ -124,6 +145,7 @@ struct fastboot_cmd {
 	struct fastboot_cmd *next;
 	const char *prefix;
 	unsigned prefix_len;
+	unsigned seq;
 	void (*handle)(const char *arg, void *data, unsigned sz);
 };
 
@@ -131,38 +153,212 @@ struct fastboot_var {
 	struct fastboot_var *next;
 	const char *name;
 	const char *value;
+	/* set for a family of variables computed when read */
+	int (*get)(const char *key, char *value, unsigned len);
+	const char *(*key)(unsigned i);
 };
 
+/*
+ * Commands and variables are kept on their lists (newest first) for help
+ * and getvar:all, and indexed by a character trie for lookup. A node
+ * holds whatever entry's name ends there. Nodes are filled in before
+ * they are linked, so the transport threads can look up while more is
+ * registered.
+ */
+struct fastboot_trie {
+	struct fastboot_trie *child;
+	struct fastboot_trie *next;
+	void *entry;
+	char c;
+};
+
+static struct fastboot_trie *fastboot_trie_child(struct fastboot_trie *parent,
+						   struct fastboot_trie *first, char c)
+{
+	struct fastboot_trie *node;
+
+	for (node = first; node; node = node->next)
+		if (node->c == c)
+			return node;
+
+	node = calloc(1, sizeof(*node));
+	if (!node)
+		return NULL;
+
+	node->c = c;
+	node->next = first;
+	parent->child = node;
+
+	return node;
+}
+
+/* the node for key, created along with any missing ancestors */
+static struct fastboot_trie *fastboot_trie_insert(struct fastboot_trie *root,
+						    const char *key, unsigned len)
+{
+	struct fastboot_trie *node = root;
+
+	while (node && len--)
+		node = fastboot_trie_child(node, node->child, *key++);
+
+	return node;
+}
+
 static struct fastboot_cmd *cmdlist;
+static struct fastboot_trie cmdtrie;
+static unsigned cmdseq;
+static bool cmdtrie_partial;
 
 void fastboot_register(const char *prefix,
 		       void (*handle)(const char *arg, void *data, unsigned sz))
 {
 	struct fastboot_cmd *cmd;
+	struct fastboot_trie *node;
+
 	cmd = malloc(sizeof(*cmd));
 	if (cmd) {
 		cmd->prefix = prefix;
 		cmd->prefix_len = strlen(prefix);
+		cmd->seq = ++cmdseq;
 		cmd->handle = handle;
 		cmd->next = cmdlist;
 		cmdlist = cmd;
+
+		/* a later registration of the same prefix shadows the earlier */
+		node = fastboot_trie_insert(&cmdtrie, prefix, cmd->prefix_len);
+		if (node)
+			node->entry = cmd;
+		else
+			cmdtrie_partial = true;
 	}
 }
 
+/*
+ * Every registered prefix of the command lies on the path the command
+ * spells out. As with the list this replaces, the most recently
+ * registered of them wins.
+ */
+static struct fastboot_cmd *fastboot_find_command(const char *buf)
+{
+	struct fastboot_trie *node = &cmdtrie;
+	struct fastboot_cmd *match = NULL;
+	struct fastboot_cmd *cmd;
+
+	if (cmdtrie_partial) {
+		for (cmd = cmdlist; cmd; cmd = cmd->next)
+			if (!memcmp(buf, cmd->prefix, cmd->prefix_len))
+				return cmd;
+		return NULL;
+	}
+
+	for (;;) {
+		cmd = node->entry;
+		if (cmd && (!match || cmd->seq > match->seq))
+			match = cmd;
+
+		if (!*buf)
+			break;
+		for (node = node->child; node; node = node->next)
+			if (node->c == *buf)
+				break;
+		if (!node)
+			break;
+		buf++;
+	}
+
+	return match;
+}
+
 static struct fastboot_var *varlist;
+static struct fastboot_trie vartrie;
+static bool vartrie_partial;
 
-void fastboot_publish(const char *name, const char *value)
+static void fastboot_publish_var(const char *name, const char *value,
+				 int (*get)(const char *key, char *value, unsigned len),
+				 const char *(*key)(unsigned i))
 {
 	struct fastboot_var *var;
+	struct fastboot_trie *node;
+
 	var = malloc(sizeof(*var));
 	if (var) {
 		var->name = name;
 		var->value = value;
+		var->get = get;
+		var->key = key;
 		var->next = varlist;
 		varlist = var;
+
+		node = fastboot_trie_insert(&vartrie, name, strlen(name));
+		if (node)
+			node->entry = var;
+		else
+			vartrie_partial = true;
 	}
 }
 
+void fastboot_publish(const char *name, const char *value)
+{
+	fastboot_publish_var(name, value, NULL, NULL);
+}
+
+void fastboot_publish_dynamic(const char *prefix,
+			      int (*get)(const char *key, char *value, unsigned len),
+			      const char *(*key)(unsigned i))
+{
+	fastboot_publish_var(prefix, NULL, get, key);
+}
+
+/*
+ * An exact match on a plain variable wins, otherwise the longest dynamic
+ * prefix of name. *key is left pointing past the prefix.
+ */
+static struct fastboot_var *fastboot_find_var(const char *name, const char **key)
+{
+	struct fastboot_trie *node = &vartrie;
+	struct fastboot_var *var, *match = NULL;
+	const char *c;
+
+	if (vartrie_partial) {
+		for (var = varlist; var; var = var->next) {
+			if (!var->get) {
+				if (!strcmp(var->name, name)) {
+					*key = name + strlen(name);
+					return var;
+				}
+			} else if (!strncmp(var->name, name, strlen(var->name)) &&
+				   (!match || strlen(var->name) > strlen(match->name))) {
+				match = var;
+			}
+		}
+		if (match)
+			*key = name + strlen(match->name);
+		return match;
+	}
+
+	for (c = name; ; c++) {
+		var = node->entry;
+		if (var && var->get) {
+			match = var;
+			*key = c;
+		}
+		if (!*c)
+			break;
+		for (node = node->child; node; node = node->next)
+			if (node->c == *c)
+				break;
+		if (!node)
+			return match;
+	}
+
+	if (var && !var->get) {
+		*key = c;
+		return var;
+	}
+
+	return match;
+}
+
 
 static event_t usb_online;
 static event_t txn_done;
@@ -179,7 +375,19 @@ static unsigned download_size;
 #define STATE_COMPLETE	2
 #define STATE_ERROR	3
 
-static unsigned fastboot_state = STATE_OFFLINE;
+static int usb_wait_online(void);
+
+static struct fastboot_transport usb_transport = {
+	.name        = "usb",
+	.wait_online = usb_wait_online,
+	.state       = STATE_OFFLINE,
+};
+
+/* transport whose command is currently being handled */
+static struct fastboot_transport *transport = &usb_transport;
+
+/* serializes command handling between transports sharing download_base */
+static mutex_t fastboot_lock;
 
 static void req_complete(struct udc_request *req, unsigned actual, int status)
 {
@@ -189,6 +397,151 @@ static void req_complete(struct udc_request *req, unsigned actual, int status)
 	event_signal(&txn_done, 0);
 }
 
+struct hsusb_rx_slot {
+	struct udc_request *req;
+	unsigned xfer;
+	int status;
+	volatile bool done;
+};
+
+static struct hsusb_rx_slot hsusb_rx[HSUSB_RX_DEPTH];
+static unsigned hsusb_rx_depth;
+static unsigned hsusb_rx_chunk = FASTBOOT_HSUSB_RX_CHUNK;
+static char hsusb_rx_chunk_str[MAX_RSP_SIZE];
+static event_t rx_done;
+
+static void rx_req_complete(struct udc_request *req, unsigned actual, int status)
+{
+	struct hsusb_rx_slot *slot = req->context;
+
+	slot->status = status;
+	req->length = actual;
+	slot->done = true;
+
+	event_signal(&rx_done, 0);
+}
+
+struct hsusb_tx_slot {
+	struct udc_request *req;
+	unsigned char *buf;
+	int status;
+	volatile bool done;
+};
+
+static struct hsusb_tx_slot hsusb_tx[HSUSB_TX_DEPTH];
+static unsigned hsusb_tx_depth;
+static unsigned hsusb_tx_head;
+static unsigned hsusb_tx_inflight;
+static event_t tx_done;
+
+static void tx_req_complete(struct udc_request *req, unsigned actual, int status)
+{
+	struct hsusb_tx_slot *slot = req->context;
+
+	slot->status = status;
+	req->length = actual;
+	slot->done = true;
+
+	event_signal(&tx_done, 0);
+}
+
+/* preallocate the receive requests and their TD chains */
+static void hsusb_rx_init(void)
+{
+	unsigned i;
+
+	for (i = 0; i < HSUSB_RX_DEPTH; i++) {
+		hsusb_rx[i].req = udc_request_alloc();
+		if (!hsusb_rx[i].req)
+			break;
+		if (udc_request_reserve(hsusb_rx[i].req, hsusb_rx_chunk)) {
+			udc_request_free(hsusb_rx[i].req);
+			break;
+		}
+		hsusb_rx[i].req->context = &hsusb_rx[i];
+	}
+	hsusb_rx_depth = i;
+
+	event_init(&rx_done, 0, EVENT_FLAG_AUTOUNSIGNAL);
+
+	snprintf(hsusb_rx_chunk_str, MAX_RSP_SIZE, "0x%x",
+		 hsusb_rx_depth ? hsusb_rx_chunk : MAX_USBFS_BULK_SIZE);
+	fastboot_publish("usb-rx-chunk-size", hsusb_rx_chunk_str);
+}
+
+/* preallocate the response requests, each with a cache line aligned buffer */
+static void hsusb_tx_init(void)
+{
+	unsigned i;
+
+	for (i = 0; i < HSUSB_TX_DEPTH; i++) {
+		hsusb_tx[i].buf = memalign(CACHE_LINE, ROUNDUP(MAX_RSP_SIZE, CACHE_LINE));
+		if (!hsusb_tx[i].buf)
+			break;
+		hsusb_tx[i].req = udc_request_alloc();
+		if (!hsusb_tx[i].req) {
+			free(hsusb_tx[i].buf);
+			break;
+		}
+		hsusb_tx[i].req->context = &hsusb_tx[i];
+	}
+	hsusb_tx_depth = i;
+
+	event_init(&tx_done, 0, EVENT_FLAG_AUTOUNSIGNAL);
+}
+
+/* wait for the oldest queued response to go out */
+static int hsusb_tx_retire(void)
+{
+	struct hsusb_tx_slot *slot = &hsusb_tx[hsusb_tx_head];
+
+	while (!slot->done)
+		event_wait(&tx_done);
+
+	hsusb_tx_head = (hsusb_tx_head + 1) % hsusb_tx_depth;
+	hsusb_tx_inflight--;
+
+	if (slot->status < 0) {
+		dprintf(INFO, "usb_write() transaction failed\n");
+		return -1;
+	}
+	return 0;
+}
+
+/* anything else on the endpoints goes after the queued responses */
+static int hsusb_tx_drain(void)
+{
+	int r = 0;
+
+	while (hsusb_tx_inflight)
+		if (hsusb_tx_retire())
+			r = -1;
+
+	return r;
+}
+
+static int hsusb_tx_queue(const void *buf, unsigned len)
+{
+	struct hsusb_tx_slot *slot;
+
+	if (hsusb_tx_inflight == hsusb_tx_depth && hsusb_tx_retire())
+		return -1;
+
+	slot = &hsusb_tx[(hsusb_tx_head + hsusb_tx_inflight) % hsusb_tx_depth];
+	memcpy(slot->buf, buf, len);
+	slot->done = false;
+	slot->req->buf = (unsigned char *)PA((addr_t)slot->buf);
+	slot->req->length = len;
+	slot->req->complete = tx_req_complete;
+	if (udc_request_queue(in, slot->req) < 0) {
+		dprintf(INFO, "usb_write() queue failed\n");
+		return -1;
+	}
+	hsusb_tx_inflight++;
+
+	return len;
+}
+
 #ifdef USB30_SUPPORT
 static int usb30_usb_read(void *_buf, unsigned len)
 {
@@ -202,7 +555,7 @@ static int usb30_usb_read(void *_buf, unsigned len)
 	ASSERT(buf);
 	ASSERT(len);
 
-	if (fastboot_state == STATE_ERROR)
+	if (usb_transport.state == STATE_ERROR)
 		goto oops;
 
 	dprintf(SPEW, "usb_read(): len = %d\n", len);
@@ -256,7 +609,7 @@ static int usb30_usb_read(void *_buf, unsigned len)
 	return count;
 
 oops:
-	fastboot_state = STATE_ERROR;
+	usb_transport.state = STATE_ERROR;
 	dprintf(CRITICAL, "usb_read(): DONE: ERROR: len = %d\n", len);
 	return -1;
 }
@@ -269,7 +622,7 @@ static int usb30_usb_write(void *buf, unsigned len)
 	ASSERT(buf);
 	ASSERT(len);
 
-	if (fastboot_state == STATE_ERROR)
+	if (usb_transport.state == STATE_ERROR)
 		goto oops;
 
 	dprintf(SPEW, "usb_write(): len = %d str = %s\n", len, (char *) buf);
@@ -300,12 +653,70 @@ static int usb30_usb_write(void *buf, unsigned len)
 	return req.length;
 
 oops:
-	fastboot_state = STATE_ERROR;
+	usb_transport.state = STATE_ERROR;
 	dprintf(CRITICAL, "usb_write(): DONE: ERROR: len = %d\n", len);
 	return -1;
 }
 #endif
 
+/*
+ * Streaming receive: keep up to hsusb_rx_depth chunks queued and refill
+ * the queue as the oldest one completes. Completions arrive in order.
+ */
+static int hsusb_usb_read_stream(unsigned char *buf, unsigned len)
+{
+	struct hsusb_rx_slot *slot;
+	unsigned queued = 0, inflight = 0;
+	unsigned head = 0, tail = 0;
+	int count = 0;
+
+	while ((unsigned) count < len) {
+		while (inflight < hsusb_rx_depth && queued < len) {
+			slot = &hsusb_rx[tail];
+			slot->xfer = (len - queued > hsusb_rx_chunk) ?
+				hsusb_rx_chunk : len - queued;
+			slot->done = false;
+			slot->req->buf = (unsigned char *)PA((addr_t)(buf + queued));
+			slot->req->length = slot->xfer;
+			slot->req->complete = rx_req_complete;
+			if (udc_request_queue(out, slot->req) < 0) {
+				dprintf(INFO, "usb_read() queue failed\n");
+				goto oops;
+			}
+			queued += slot->xfer;
+			inflight++;
+			tail = (tail + 1) % hsusb_rx_depth;
+		}
+
+		slot = &hsusb_rx[head];
+		while (!slot->done)
+			event_wait(&rx_done);
+		inflight--;
+		head = (head + 1) % hsusb_rx_depth;
+
+		if (slot->status < 0) {
+			dprintf(INFO, "usb_read() transaction failed\n");
+			goto oops;
+		}
+
+		count += slot->req->length;
+
+		/* short transfer? drop whatever is queued behind it */
+		if (slot->req->length != slot->xfer) {
+			if (inflight)
+				udc_request_cancel(out, slot->req);
+			break;
+		}
+	}
+
+	return count;
+
+oops:
+	if (inflight)
+		udc_request_cancel(out, slot->req);
+	return -1;
+}
+
 static int hsusb_usb_read(void *_buf, unsigned len)
 {
 	int r;
@@ -313,9 +724,19 @@ static int hsusb_usb_read(void *_buf, unsigned len)
 	unsigned char *buf = _buf;
 	int count = 0;
 
-	if (fastboot_state == STATE_ERROR)
+	if (usb_transport.state == STATE_ERROR)
 		goto oops;
 
+	if (hsusb_tx_drain())
+		goto oops;
+
+	if (hsusb_rx_depth && len > MAX_USBFS_BULK_SIZE) {
+		count = hsusb_usb_read_stream(buf, len);
+		if (count < 0)
+			goto oops;
+		len = 0;
+	}
+
 	while (len > 0) {
 		xfer = (len > MAX_USBFS_BULK_SIZE) ? MAX_USBFS_BULK_SIZE : len;
 		req->buf = (unsigned char *)PA((addr_t)buf);
@@ -348,7 +769,7 @@ static int hsusb_usb_read(void *_buf, unsigned len)
 	return count;
 
 oops:
-	fastboot_state = STATE_ERROR;
+	usb_transport.state = STATE_ERROR;
 	return -1;
 }
 
@@ -359,7 +780,17 @@ static int hsusb_usb_write(void *buf, unsigned len)
 	unsigned char *_buf = buf;
 	int count = 0;
 
-	if (fastboot_state == STATE_ERROR)
+	if (usb_transport.state == STATE_ERROR)
+		goto oops;
+
+	if (hsusb_tx_depth && len && len <= MAX_RSP_SIZE) {
+		count = hsusb_tx_queue(buf, len);
+		if (count < 0)
+			goto oops;
+		return count;
+	}
+
+	if (hsusb_tx_drain())
 		goto oops;
 
 	while (len > 0) {
@@ -389,26 +820,38 @@ static int hsusb_usb_write(void *buf, unsigned len)
 	return count;
 
 oops:
-	fastboot_state = STATE_ERROR;
+	usb_transport.state = STATE_ERROR;
 	return -1;
 }
 
+static int hsusb_usb_flush(void)
+{
+	if (hsusb_tx_drain()) {
+		usb_transport.state = STATE_ERROR;
+		return -1;
+	}
+	return 0;
+}
+
 static void fastboot_ack(const char *code, const char *reason)
 {
 	STACKBUF_DMA_ALIGN(__response, MAX_RSP_SIZE);
 	char* response = (char*)__response;
 
-	if (fastboot_state != STATE_COMMAND)
+	if (transport->state != STATE_COMMAND)
 		return;
 
 	if (reason == 0)
 		reason = "";
 
 	snprintf((char *)response, MAX_RSP_SIZE, "%s%s", code, reason);
-	fastboot_state = STATE_COMPLETE;
+	transport->state = STATE_COMPLETE;
 
-	usb_if.usb_write(response, strlen((const char *)response));
+	transport->write(response, strlen((const char *)response));
 
+	/* handlers may stop the link right after completing */
+	if (transport->flush)
+		transport->flush();
 }
 
 void fastboot_code(const char *code, const char *reason)
@@ -416,7 +859,7 @@ void fastboot_code(const char *code, const char *reason)
 	STACKBUF_DMA_ALIGN(__response, MAX_RSP_SIZE);
 	char* response = (char*)__response;
 
-	if (fastboot_state != STATE_COMMAND)
+	if (transport->state != STATE_COMMAND)
 		return;
 
 	if (reason == 0)
@@ -424,7 +867,7 @@ void fastboot_code(const char *code, const char *reason)
 
 	snprintf(response, MAX_RSP_SIZE, "%s%s", code, reason);
 
-	usb_if.usb_write(response, strlen(response));
+	transport->write(response, strlen(response));
 }
 
 void fastboot_info(const char *reason)
@@ -432,7 +875,7 @@ void fastboot_info(const char *reason)
 	STACKBUF_DMA_ALIGN(__response, MAX_RSP_SIZE);
 	char* response = (char*)__response;
 
-	if (fastboot_state != STATE_COMMAND)
+	if (transport->state != STATE_COMMAND)
 		return;
 
 	if (reason == 0)
@@ -440,7 +883,7 @@ void fastboot_info(const char *reason)
 
 	snprintf((char *)response, MAX_RSP_SIZE, "INFO%s", reason);
 
-	usb_if.usb_write(response, strlen((const char *)response));
+	transport->write(response, strlen((const char *)response));
 }
 
 void fastboot_write(void *data, unsigned len)
@@ -448,7 +891,7 @@ void fastboot_write(void *data, unsigned len)
 	STACKBUF_DMA_ALIGN(__response, MAX_RSP_SIZE);
 	char* response = (char*)__response;
 
-	if (fastboot_state != STATE_COMMAND)
+	if (transport->state != STATE_COMMAND)
 		return;
 
 	if (!data)
@@ -457,7 +900,7 @@ void fastboot_write(void *data, unsigned len)
 	snprintf(response, MAX_RSP_SIZE, "PRNT");
 	memcpy(response+4, data, len);
 
-	usb_if.usb_write(response, len+4);
+	transport->write(response, len+4);
 }
 
 void fastboot_send_data(void *data, unsigned len)
@@ -465,7 +908,7 @@ void fastboot_send_data(void *data, unsigned len)
 	STACKBUF_DMA_ALIGN(__response, MAX_RSP_SIZE);
 	char* response = (char*)__response;
 
-	if (fastboot_state != STATE_COMMAND)
+	if (transport->state != STATE_COMMAND)
 		return;
 
 	if (!data)
@@ -476,10 +919,10 @@ void fastboot_send_data(void *data, unsigned len)
 
 	// send header
 	snprintf(response, MAX_RSP_SIZE, "DATA%016x", len);
-	usb_if.usb_write(response, 20);
+	transport->write(response, 20);
 
 	// send data
-	usb_if.usb_write(data, len);
+	transport->write(data, len);
 }
 
 void fastboot_fail(const char *reason)
@@ -497,17 +940,36 @@ static void cmd_getvar(const char *arg, void *data, unsigned sz)
 	struct fastboot_var *var;
 	bool all = false;
 	char response[128];
+	char value[MAX_RSP_SIZE];
+	const char *key;
+	unsigned i;
 
 	all = !strcmp("all", arg);
 
+	if (!all) {
+		var = fastboot_find_var(arg, &key);
+		if (var && var->get) {
+			if (var->get(key, value, sizeof(value)))
+				value[0] = '\0';
+			fastboot_okay(value);
+		} else {
+			fastboot_okay(var ? var->value : "");
+		}
+		return;
+	}
+
 	for (var = varlist; var; var = var->next) {
-		if (all) {
+		if (!var->get) {
 			snprintf(response, sizeof(response), "\t%s: [%s]", var->name, var->value);
 			fastboot_info(response);
+			continue;
 		}
-		else if (!strcmp(var->name, arg)) {
-			fastboot_okay(var->value);
-			return;
+
+		for (i = 0; var->key && (key = var->key(i)); i++) {
+			if (var->get(key, value, sizeof(value)))
+				continue;
+			snprintf(response, sizeof(response), "\t%s%s: [%s]", var->name, key, value);
+			fastboot_info(response);
 		}
 	}
 	fastboot_okay("");
@@ -549,23 +1011,23 @@ static void cmd_download(const char *arg, void *data, unsigned sz)
 	}
 
 	snprintf((char *)response, MAX_RSP_SIZE, "DATA%08x", len);
-	if (usb_if.usb_write(response, strlen((const char *)response)) < 0)
+	if (transport->write(response, strlen((const char *)response)) < 0)
 		return;
 
-	r = usb_if.usb_read(download_base, len);
+	r = transport->read(download_base, len);
 	if ((r < 0) || ((unsigned) r != len)) {
-		fastboot_state = STATE_ERROR;
+		transport->state = STATE_ERROR;
 		return;
 	}
 	download_size = len;
 	fastboot_okay("");
 }
 
-static void fastboot_command_loop(void)
+static void fastboot_command_loop(struct fastboot_transport *t)
 {
 	struct fastboot_cmd *cmd;
 	int r;
-	dprintf(INFO,"fastboot: processing commands\n");
+	dprintf(INFO,"fastboot: processing commands on %s\n", t->name);
 
 	uint8_t *buffer = (uint8_t *)memalign(CACHE_LINE, ROUNDUP(4096, CACHE_LINE));
 	if (!buffer)
@@ -574,7 +1036,7 @@ static void fastboot_command_loop(void)
 		ASSERT(0);
 	}
 again:
-	while (fastboot_state != STATE_ERROR) {
+	while (t->state != STATE_ERROR) {
 
 		/* Read buffer must be cleared first. If buffer is not cleared,
 		 * the original data in buf trailing the received command is
@@ -583,19 +1045,19 @@ again:
 		memset(buffer, 0, MAX_RSP_SIZE);
 		arch_clean_invalidate_cache_range((addr_t) buffer, MAX_RSP_SIZE);
 
-		r = usb_if.usb_read(buffer, MAX_RSP_SIZE);
+		r = t->read(buffer, MAX_RSP_SIZE);
 		if (r < 0) break;
 		buffer[r] = 0;
 		if(strcmp((const char*)buffer, "oem screenshot")
 		&& strcmp((const char*)buffer, "getvar:screen-resolution"))
 			dprintf(INFO,"fastboot: %s\n", buffer);
 
-		fastboot_state = STATE_COMMAND;
-
-		for (cmd = cmdlist; cmd; cmd = cmd->next) {
-			if (memcmp(buffer, cmd->prefix, cmd->prefix_len))
-				continue;
+		mutex_acquire(&fastboot_lock);
+		transport = t;
+		t->state = STATE_COMMAND;
 
+		cmd = fastboot_find_command((const char*) buffer);
+		if (cmd) {
 #if WITH_APP_DISPLAY_SERVER
 			display_server_pause();
 #endif
@@ -605,30 +1067,55 @@ again:
 			display_server_unpause();
 #endif
 
-			if (fastboot_state == STATE_COMMAND)
+			if (t->state == STATE_COMMAND)
 				fastboot_fail("unknown reason");
+			mutex_release(&fastboot_lock);
 			goto again;
 		}
 
 		fastboot_info("unknown command");
 		fastboot_info("See 'fastboot oem help'");
 		fastboot_fail("");
+		mutex_release(&fastboot_lock);
 
 	}
-	fastboot_state = STATE_OFFLINE;
-	dprintf(INFO,"fastboot: oops!\n");
+	t->state = STATE_OFFLINE;
+	dprintf(INFO,"fastboot: %s oops!\n", t->name);
 	free(buffer);
 }
 
 static int fastboot_handler(void *arg)
 {
+	struct fastboot_transport *t = arg;
+
 	for (;;) {
-		event_wait(&usb_online);
-		fastboot_command_loop();
+		if (t->wait_online)
+			t->wait_online();
+		fastboot_command_loop(t);
 	}
 	return 0;
 }
 
+int fastboot_register_transport(struct fastboot_transport *t)
+{
+	thread_t *thr;
+
+	t->state = STATE_OFFLINE;
+
+	thr = thread_create(t->name, fastboot_handler, t, DEFAULT_PRIORITY, 4096);
+	if (!thr)
+		return -1;
+	thread_resume(thr);
+
+	return 0;
+}
+
+static int usb_wait_online(void)
+{
+	return event_wait(&usb_online);
+}
+
+#if WITH_PLATFORM_MSM_SHARED
 static void fastboot_notify(struct udc_gadget *gadget, unsigned event)
 {
 	if (event == UDC_EVENT_ONLINE) {
@@ -636,17 +1123,9 @@ static void fastboot_notify(struct udc_gadget *gadget, unsigned event)
 	}
 }
 
-int fastboot_init(void *base, unsigned size)
+static int fastboot_usb_init(void)
 {
 	char sn_buf[13];
-	thread_t *thr;
-	dprintf(INFO, "fastboot_init()\n");
-
-	download_base = base;
-	download_max = size;
-
-	/* target specific initialization before going into fastboot. */
-	target_fastboot_init();
 
 	/* setup serialno */
 	target_serialno((unsigned char *) sn_buf);
@@ -665,6 +1144,7 @@ int fastboot_init(void *base, unsigned size)
 		usb_if.udc_stop            = usb30_udc_stop;
 
 		usb_if.udc_endpoint_alloc  = usb30_udc_endpoint_alloc;
+		usb_if.udc_endpoint_free   = usb30_udc_endpoint_free;
 		usb_if.udc_request_alloc   = usb30_udc_request_alloc;
 		usb_if.udc_request_free    = usb30_udc_request_free;
 
@@ -684,6 +1164,7 @@ int fastboot_init(void *base, unsigned size)
 		usb_if.udc_stop            = udc_stop;
 
 		usb_if.udc_endpoint_alloc  = udc_endpoint_alloc;
+		usb_if.udc_endpoint_free   = udc_endpoint_free;
 		usb_if.udc_request_alloc   = udc_request_alloc;
 		usb_if.udc_request_free    = udc_request_free;
 
@@ -692,7 +1173,14 @@ int fastboot_init(void *base, unsigned size)
 	}
 
 	/* register udc device */
-	usb_if.udc_init(&surf_udc_device);
+	if (usb_if.udc_init(&surf_udc_device))
+		goto fail_udc_init;
+
+	if (usb_if.usb_write == hsusb_usb_write)
+	{
+		hsusb_rx_init();
+		hsusb_tx_init();
+	}
 
 	event_init(&usb_online, 0, EVENT_FLAG_AUTOUNSIGNAL);
 	event_init(&txn_done, 0, EVENT_FLAG_AUTOUNSIGNAL);
@@ -715,17 +1203,12 @@ int fastboot_init(void *base, unsigned size)
 	if (usb_if.udc_register_gadget(&fastboot_gadget))
 		goto fail_udc_register;
 
-	fastboot_register("oem help", cmd_help);
-	fastboot_register("getvar:", cmd_getvar);
-	fastboot_register("download:", cmd_download);
-	fastboot_publish("version", ABOOT_VERSION);
-
-	thr = thread_create("fastboot", fastboot_handler, 0, DEFAULT_PRIORITY, 4096);
-	if (!thr)
-	{
+	usb_transport.read  = usb_if.usb_read;
+	usb_transport.write = usb_if.usb_write;
+	if (usb_if.usb_write == hsusb_usb_write)
+		usb_transport.flush = hsusb_usb_flush;
+	if (fastboot_register_transport(&usb_transport))
 		goto fail_alloc_in;
-	}
-	thread_resume(thr);
 
 	usb_if.udc_start();
 
@@ -738,10 +1221,57 @@ fail_alloc_req:
 fail_alloc_out:
 	usb_if.udc_endpoint_free(in);
 fail_alloc_in:
+fail_udc_init:
+	/* nothing to stop later on */
+	memset(&usb_if, 0, sizeof(usb_if));
+	return -1;
+}
+#else
+/* the usb glue above drives the msm device controllers only */
+static int fastboot_usb_init(void)
+{
 	return -1;
 }
+#endif
+
+int fastboot_init(void *base, unsigned size)
+{
+	int transports = 0;
+	dprintf(INFO, "fastboot_init()\n");
+
+	download_base = base;
+	download_max = size;
+
+#if WITH_PLATFORM_MSM_SHARED
+	/* target specific initialization before going into fastboot. */
+	target_fastboot_init();
+#endif
+
+	mutex_init(&fastboot_lock);
+
+	fastboot_register("oem help", cmd_help);
+	fastboot_register("getvar:", cmd_getvar);
+	fastboot_register("download:", cmd_download);
+	fastboot_publish("version", ABOOT_VERSION);
+
+#if WITH_LIB_LWIP
+	/* the network transport does not need a usb device controller */
+	if (fastboot_udp_init())
+		dprintf(CRITICAL, "fastboot: udp transport not available\n");
+	else
+		transports++;
+#endif
+
+	if (fastboot_usb_init())
+		dprintf(CRITICAL, "fastboot: usb transport not available\n");
+	else
+		transports++;
+
+	return transports ? 0 : -1;
+}
 
 void fastboot_stop(void)
 {
-	usb_if.udc_stop();
+	if (usb_if.udc_stop)
+		usb_if.udc_stop();
 }
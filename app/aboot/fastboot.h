@@ -37,6 +37,31 @@
 int fastboot_init(void *xfer_buffer, unsigned max);
 void fastboot_stop(void);
 
+/* a carrier for the fastboot protocol
+ * - read() returns the next host message (command or download data)
+ * - write() sends one response back to the host
+ * - flush() waits until written responses have reached the host, may
+ *   be NULL if write() already does
+ * - wait_online() blocks until the link is usable, may be NULL
+ * each registered transport gets its own command loop thread; command
+ * handling itself is serialized since they share the download buffer
+ */
+struct fastboot_transport {
+	const char *name;
+	int (*wait_online)(void);
+	int (*read)(void *buf, unsigned len);
+	int (*write)(void *buf, unsigned len);
+	int (*flush)(void);
+	unsigned state;
+};
+
+int fastboot_register_transport(struct fastboot_transport *t);
+
+#if WITH_LIB_LWIP
+/* fastboot over udp (port 5554) on top of lwip */
+int fastboot_udp_init(void);
+#endif
+
 /* register a command handler
  * - command handlers will be called if their prefix matches
  * - they are expected to call fastboot_okay() or fastboot_fail()
@@ -48,6 +73,16 @@ void fastboot_register(const char *prefix,
 /* publish a variable readable by the built-in getvar command */
 void fastboot_publish(const char *name, const char *value);
 
+/* publish a family of variables <prefix><key> computed when read
+ * - get() formats the value for key into value, returning nonzero
+ *   if there is no such variable
+ * - key() names the i-th member listed by getvar:all and returns NULL
+ *   past the last one; NULL leaves the family out of the listing
+ */
+void fastboot_publish_dynamic(const char *prefix,
+			      int (*get)(const char *key, char *value, unsigned len),
+			      const char *(*key)(unsigned i));
+
 /* only callable from within a command handler */
 void fastboot_okay(const char *result);
 void fastboot_fail(const char *reason);
@@ -0,0 +1,64 @@
+/* Copyright (c) 2015, The Linux Foundation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of The Linux Fundation, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Entry point for FASTBOOT_STANDALONE builds: fastboot on its own, with
+ * only the core commands, for bringing up transports on targets that
+ * cannot boot android images.
+ */
+
+#include <app.h>
+#include <debug.h>
+#include <arch/defines.h>
+#include <malloc.h>
+#include "fastboot.h"
+
+#ifndef FASTBOOT_STANDALONE_BUFFER_SIZE
+#define FASTBOOT_STANDALONE_BUFFER_SIZE (8 * 1024 * 1024)
+#endif
+
+static void fastboot_app_init(const struct app_descriptor *app)
+{
+	void *buf;
+
+	buf = memalign(CACHE_LINE, FASTBOOT_STANDALONE_BUFFER_SIZE);
+	if (!buf) {
+		dprintf(CRITICAL, "fastboot: no memory for the download buffer\n");
+		return;
+	}
+
+	if (fastboot_init(buf, FASTBOOT_STANDALONE_BUFFER_SIZE)) {
+		dprintf(CRITICAL, "fastboot: no transport came up\n");
+		free(buf);
+	}
+}
+
+APP_START(fastboot)
+	.init = fastboot_app_init,
+APP_END
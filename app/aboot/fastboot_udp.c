@@ -0,0 +1,370 @@
+/*
+ * Copyright (c) 2015, The Linux Foundation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Fastboot UDP transport (protocol version 1, as spoken by "fastboot -s udp:<ip>").
+ *
+ * Every packet starts with a 4 byte header: id, flags and a big endian
+ * sequence number. The host drives the exchange; the device only ever
+ * sends a packet in reply to one it received, echoing its sequence number.
+ *
+ * The protocol is stop-and-wait: the host sends one packet and waits for
+ * its ack before sending the next, so there is no transfer window. Every
+ * host packet carrying data is acked as soon as its payload has been
+ * copied straight from the netbuf into the destination buffer, which keeps
+ * the per packet turnaround short. Only the expected sequence number is
+ * accepted; a retransmission of the previous packet gets the previous
+ * reply again and anything else is dropped.
+ */
+
+#if WITH_LIB_LWIP
+
+#include <debug.h>
+#include <string.h>
+#include <stdlib.h>
+#include <dev/class/netif.h>
+#include <lwip/api.h>
+#include <lwip/netbuf.h>
+#include <lwip/ip_addr.h>
+#include "fastboot.h"
+
+#define FB_UDP_PORT             5554
+#define FB_UDP_VERSION          1
+
+#define FB_UDP_HDR_SIZE         4
+#define FB_UDP_MIN_PACKET       512
+/* largest udp payload that fits a standard ethernet frame */
+#define FB_UDP_MAX_PACKET       1472
+
+#define FB_UDP_ID_ERROR         0x00
+#define FB_UDP_ID_QUERY         0x01
+#define FB_UDP_ID_INIT          0x02
+#define FB_UDP_ID_FASTBOOT      0x03
+
+#define FB_UDP_FLAG_CONTINUATION 0x01
+
+static struct netconn *conn;
+
+/* host currently owning the session */
+static ip_addr_t host_addr;
+static u16_t host_port;
+static bool host_valid;
+
+/* sequence number of the next new host packet */
+static u16_t next_seq;
+static unsigned max_packet = FB_UDP_MIN_PACKET;
+
+/* last reply sent, repeated verbatim when the host retransmits */
+static uint8_t last_reply[FB_UDP_MAX_PACKET];
+static unsigned last_reply_len;
+static u16_t last_reply_seq;
+static bool have_last_reply;
+
+/* only the fastboot-udp thread sends, so one transmit buffer will do */
+static uint8_t tx_pkt[FB_UDP_MAX_PACKET];
+
+static int udp_send(ip_addr_t *addr, u16_t port, const void *data, unsigned len)
+{
+	struct netbuf *nb;
+	void *p;
+	err_t err;
+
+	nb = netbuf_new();
+	if (!nb)
+		return -1;
+
+	p = netbuf_alloc(nb, len);
+	if (!p) {
+		netbuf_delete(nb);
+		return -1;
+	}
+	memcpy(p, data, len);
+
+	err = netconn_sendto(conn, nb, addr, port);
+	netbuf_delete(nb);
+
+	return (err == ERR_OK) ? 0 : -1;
+}
+
+static int udp_reply(ip_addr_t *addr, u16_t port, uint8_t id, uint8_t flags,
+		     u16_t seq, const void *data, unsigned len)
+{
+	uint8_t *pkt = tx_pkt;
+
+	if (len > sizeof(tx_pkt) - FB_UDP_HDR_SIZE)
+		len = sizeof(tx_pkt) - FB_UDP_HDR_SIZE;
+
+	pkt[0] = id;
+	pkt[1] = flags;
+	pkt[2] = seq >> 8;
+	pkt[3] = seq & 0xff;
+	if (len)
+		memcpy(pkt + FB_UDP_HDR_SIZE, data, len);
+
+	if (id == FB_UDP_ID_FASTBOOT) {
+		memcpy(last_reply, pkt, FB_UDP_HDR_SIZE + len);
+		last_reply_len = FB_UDP_HDR_SIZE + len;
+		last_reply_seq = seq;
+		have_last_reply = true;
+	}
+
+	return udp_send(addr, port, pkt, FB_UDP_HDR_SIZE + len);
+}
+
+static void udp_error(ip_addr_t *addr, u16_t port, u16_t seq, const char *msg)
+{
+	dprintf(INFO, "fastboot udp: %s\n", msg);
+	udp_reply(addr, port, FB_UDP_ID_ERROR, 0, seq, msg, strlen(msg));
+}
+
+static bool udp_handle_init(struct netbuf *nb, u16_t seq)
+{
+	uint8_t req[FB_UDP_HDR_SIZE + 4];
+	uint8_t rsp[4];
+	unsigned version, host_max;
+
+	if (netbuf_copy(nb, req, sizeof(req)) != sizeof(req)) {
+		udp_error(netbuf_fromaddr(nb), netbuf_fromport(nb), seq, "bad init packet");
+		return false;
+	}
+
+	version = (req[4] << 8) | req[5];
+	host_max = (req[6] << 8) | req[7];
+	if (version < FB_UDP_VERSION || host_max < FB_UDP_MIN_PACKET) {
+		udp_error(netbuf_fromaddr(nb), netbuf_fromport(nb), seq, "unsupported version");
+		return false;
+	}
+
+	/* a new host session replaces whatever was going on before */
+	ip_addr_copy(host_addr, *netbuf_fromaddr(nb));
+	host_port = netbuf_fromport(nb);
+	host_valid = true;
+	have_last_reply = false;
+	max_packet = MIN(host_max, FB_UDP_MAX_PACKET);
+	next_seq = seq + 1;
+
+	rsp[0] = FB_UDP_VERSION >> 8;
+	rsp[1] = FB_UDP_VERSION & 0xff;
+	rsp[2] = max_packet >> 8;
+	rsp[3] = max_packet & 0xff;
+	udp_reply(&host_addr, host_port, FB_UDP_ID_INIT, 0, seq, rsp, sizeof(rsp));
+
+	dprintf(INFO, "fastboot udp: session from %u.%u.%u.%u:%u, packet size %u\n",
+		ip4_addr1_16(&host_addr), ip4_addr2_16(&host_addr),
+		ip4_addr3_16(&host_addr), ip4_addr4_16(&host_addr),
+		host_port, max_packet);
+
+	return true;
+}
+
+/*
+ * Wait for the next in-order fastboot packet of the current session.
+ * Queries, session setup and retransmissions are answered in here.
+ * Returns 1 with *out set, 0 if the host started a new session, -1 on error.
+ */
+static int udp_next_packet(struct netbuf **out, uint8_t *flags)
+{
+	for (;;) {
+		struct netbuf *nb;
+		uint8_t hdr[FB_UDP_HDR_SIZE];
+		u16_t seq;
+		s16_t delta;
+
+		if (netconn_recv(conn, &nb) != ERR_OK)
+			return -1;
+
+		if (netbuf_copy(nb, hdr, sizeof(hdr)) != sizeof(hdr)) {
+			netbuf_delete(nb);
+			continue;
+		}
+		seq = (hdr[2] << 8) | hdr[3];
+
+		switch (hdr[0]) {
+		case FB_UDP_ID_QUERY: {
+			uint8_t rsp[2] = { next_seq >> 8, next_seq & 0xff };
+
+			udp_reply(netbuf_fromaddr(nb), netbuf_fromport(nb),
+				  FB_UDP_ID_QUERY, 0, seq, rsp, sizeof(rsp));
+			netbuf_delete(nb);
+			continue;
+		}
+		case FB_UDP_ID_INIT: {
+			bool ok = udp_handle_init(nb, seq);
+
+			netbuf_delete(nb);
+			if (ok)
+				return 0;
+			continue;
+		}
+		case FB_UDP_ID_FASTBOOT:
+			break;
+		default:
+			udp_error(netbuf_fromaddr(nb), netbuf_fromport(nb), seq, "unknown packet id");
+			netbuf_delete(nb);
+			continue;
+		}
+
+		if (!host_valid ||
+		    !ip_addr_cmp(netbuf_fromaddr(nb), &host_addr) ||
+		    netbuf_fromport(nb) != host_port) {
+			udp_error(netbuf_fromaddr(nb), netbuf_fromport(nb), seq, "no session");
+			netbuf_delete(nb);
+			continue;
+		}
+
+		delta = (s16_t)(seq - next_seq);
+		if (delta < 0) {
+			/* our reply got lost, the host is asking again */
+			if (have_last_reply && seq == last_reply_seq)
+				udp_send(&host_addr, host_port, last_reply, last_reply_len);
+			else
+				udp_reply(&host_addr, host_port, FB_UDP_ID_FASTBOOT, 0, seq, NULL, 0);
+			netbuf_delete(nb);
+			continue;
+		}
+		if (delta > 0) {
+			/* not the packet we are waiting for, the host will resend */
+			netbuf_delete(nb);
+			continue;
+		}
+
+		*flags = hdr[1];
+		*out = nb;
+		return 1;
+	}
+}
+
+/*
+ * Reads sized for a single packet (commands) complete at the end of the
+ * host message. Larger reads (download data) complete once len bytes have
+ * arrived, however the host chose to split its writes.
+ */
+static int udp_read(void *_buf, unsigned len)
+{
+	uint8_t *buf = _buf;
+	unsigned count = 0;
+	bool single = len <= max_packet - FB_UDP_HDR_SIZE;
+
+	while (count < len) {
+		struct netbuf *nb;
+		uint8_t flags;
+		unsigned n;
+		int r;
+
+		r = udp_next_packet(&nb, &flags);
+		if (r < 0)
+			return -1;
+		if (r == 0) {
+			/* a fresh session while idle is fine, mid-transfer it is not */
+			if (count)
+				return -1;
+			continue;
+		}
+
+		n = netbuf_len(nb) - FB_UDP_HDR_SIZE;
+		if (n > len - count) {
+			udp_error(&host_addr, host_port, next_seq, "message too large");
+			netbuf_delete(nb);
+			return -1;
+		}
+
+		/* single copy from the packet buffers into the destination */
+		if (n)
+			netbuf_copy_partial(nb, buf + count, n, FB_UDP_HDR_SIZE);
+		netbuf_delete(nb);
+
+		udp_reply(&host_addr, host_port, FB_UDP_ID_FASTBOOT, 0, next_seq, NULL, 0);
+		next_seq++;
+		count += n;
+
+		if (single && n && !(flags & FB_UDP_FLAG_CONTINUATION))
+			break;
+	}
+
+	return count;
+}
+
+/* each chunk of a response rides on the reply to the host's next poll */
+static int udp_write(void *_buf, unsigned len)
+{
+	uint8_t *buf = _buf;
+	unsigned sent = 0;
+
+	do {
+		struct netbuf *nb;
+		uint8_t flags;
+		unsigned n;
+		int r;
+
+		r = udp_next_packet(&nb, &flags);
+		if (r <= 0)
+			return -1;
+		netbuf_delete(nb);
+
+		n = MIN(len - sent, max_packet - FB_UDP_HDR_SIZE);
+		flags = (sent + n < len) ? FB_UDP_FLAG_CONTINUATION : 0;
+
+		if (udp_reply(&host_addr, host_port, FB_UDP_ID_FASTBOOT, flags,
+			      next_seq, buf + sent, n))
+			return -1;
+		next_seq++;
+		sent += n;
+	} while (sent < len);
+
+	return sent;
+}
+
+static int udp_wait_online(void)
+{
+	return class_netstack_wait_for_network(INFINITE_TIME);
+}
+
+static struct fastboot_transport udp_transport = {
+	.name        = "fastboot-udp",
+	.wait_online = udp_wait_online,
+	.read        = udp_read,
+	.write       = udp_write,
+};
+
+int fastboot_udp_init(void)
+{
+	conn = netconn_new(NETCONN_UDP);
+	if (!conn)
+		return -1;
+
+	if (netconn_bind(conn, IP_ADDR_ANY, FB_UDP_PORT) != ERR_OK) {
+		netconn_delete(conn);
+		conn = NULL;
+		return -1;
+	}
+
+	dprintf(INFO, "fastboot: listening on udp port %d\n", FB_UDP_PORT);
+
+	return fastboot_register_transport(&udp_transport);
+}
+
+#endif /* WITH_LIB_LWIP */
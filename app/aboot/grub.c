@@ -5,6 +5,7 @@
 #include <partition_parser.h>
 #include <malloc.h>
 #include <lib/bio.h>
+#include <lib/fs.h>
 #include <platform.h>
 #include <ext4.h>
 #include <ext4_types.h>
@@ -22,6 +23,7 @@
 #include "uboot_api/api_private.h"
 #include "uboot_api/uboot_part.h"
 #include "bootimg.h"
+#include <app/aboot.h>
 
 static char* grub_bootdev = NULL;
 void grub_get_bootdev(char **value) {
@@ -161,9 +163,17 @@ static int grub_load_from_mmc(void) {
 }
 #endif
 
+#if GRUB_MEMDISK_TARFS
+/* a sideloaded memdisk that is a tar archive is also served from here */
+#define GRUB_MEMDISK_MOUNTPOINT "/memdisk"
+#endif
+
 static int grub_sideload_handler(void *data)
 {
 	char* memdisk_name = NULL;
+#if GRUB_MEMDISK_TARFS
+	bool memdisk_mounted = false;
+#endif
 	struct boot_img_hdr *hdr =  (struct boot_img_hdr *)data;
 	unsigned kernel_size = ALIGN(hdr->kernel_size, hdr->page_size);
 	void* local_kernel_addr = data + hdr->page_size;
@@ -181,6 +191,14 @@ static int grub_sideload_handler(void *data)
 		create_membdev(memdisk_name, (void*)hdr->ramdisk_addr, hdr->ramdisk_size);
 		dev_stor_scan_devices();
 
+#if GRUB_MEMDISK_TARFS
+		// index it in place if it is a tar archive
+		if(fs_mount_type(GRUB_MEMDISK_MOUNTPOINT, memdisk_name, "tarfs")==0) {
+			memdisk_mounted = true;
+			dprintf(INFO, "memdisk: tar archive mounted at %s\n", GRUB_MEMDISK_MOUNTPOINT);
+		}
+#endif
+
 		// set bootdev
 		grub_bootdev = strdup(memdisk_name);
 		grub_bootpath = strdup("/grub");
@@ -200,6 +218,7 @@ static int grub_sideload_handler(void *data)
 	void (*entry)(unsigned, unsigned, unsigned*) = (void*)hdr->kernel_addr;
 	dprintf(INFO, "booting GRUB from sideload @ %p ramdisk @ %p\n", entry, (void*)hdr->ramdisk_addr);
 
+	aboot_display_join();
 #if WITH_APP_DISPLAY_SERVER
 	display_server_stop();
 #endif
@@ -207,6 +226,10 @@ static int grub_sideload_handler(void *data)
 	entry(0, board_machtype(), (void*)uboot_api_sig);
 
 	// delete ramdisk in cae we used one
+#if GRUB_MEMDISK_TARFS
+	if(memdisk_mounted)
+		fs_unmount(GRUB_MEMDISK_MOUNTPOINT);
+#endif
 	if(memdisk_name) {
 		bdev_t* dev = bio_open(memdisk_name);
 		if (dev) {
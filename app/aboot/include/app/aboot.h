@@ -53,6 +53,7 @@ extern device_info device;
 extern enum bootmode bootmode, bootmode_normal;
 const char* strbootmode(enum bootmode bm);
 void aboot_continue_boot(void);
+void aboot_display_join(void);
 #if WITH_XIAOMI_DUALBOOT
 bool is_dualboot_supported(void);
 enum bootmode get_dualboot_mode(void);
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2015, The Linux Foundation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of The Linux Foundation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <debug.h>
+#include <string.h>
+#include <stdlib.h>
+#include <arch/defines.h>
+#include <mmc.h>
+#include <mmc_wrapper.h>
+#include <partition_parser.h>
+#include <boot_stats.h>
+#include <kernel/mutex.h>
+#include "bootimg.h"
+#include "prefetch.h"
+
+#define BOOT_PREFETCH_MAX 8
+
+struct boot_prefetch_entry {
+	uint8_t lun;
+	unsigned long long offset;
+	uint32_t size;
+	uint8_t *buf;
+};
+
+static struct boot_prefetch_entry prefetch[BOOT_PREFETCH_MAX];
+static unsigned prefetch_count;
+/* the splash is read from the display init task while the boot path
+ * may be dropping entries */
+static mutex_t prefetch_lock = MUTEX_INITIAL_VALUE(prefetch_lock);
+
+/* queue a read relative to the start (or, with from_end, the end) of a partition */
+static void boot_prefetch_add(const char *name, bool from_end, uint32_t size)
+{
+	struct boot_prefetch_entry *e;
+	uint32_t blocksize = mmc_get_device_blocksize();
+	int index;
+
+	if (prefetch_count == BOOT_PREFETCH_MAX)
+		return;
+
+	index = partition_get_index(name);
+	if (index == INVALID_PTN)
+		return;
+
+	unsigned long long ptn = partition_get_offset(index);
+	unsigned long long ptn_size = partition_get_size(index);
+
+	size = ROUNDUP(size, blocksize);
+	if (ptn == 0 || ptn_size < size)
+		return;
+
+	e = &prefetch[prefetch_count];
+	e->lun = partition_get_lun(index);
+	e->offset = from_end ? ptn + ptn_size - size : ptn;
+	e->size = size;
+	e->buf = NULL;
+	prefetch_count++;
+}
+
+static int boot_prefetch_cmp(const void *a, const void *b)
+{
+	const struct boot_prefetch_entry *ea = a;
+	const struct boot_prefetch_entry *eb = b;
+
+	if (ea->lun != eb->lun)
+		return ea->lun - eb->lun;
+	if (ea->offset != eb->offset)
+		return (ea->offset < eb->offset) ? -1 : 1;
+	return 0;
+}
+
+void boot_prefetch(void)
+{
+	int bs_scope = bs_scope_begin("boot_prefetch");
+	uint8_t saved_lun = mmc_get_lun();
+	uint32_t page = mmc_page_size();
+	unsigned i;
+
+	boot_prefetch_release();
+
+	mutex_acquire(&prefetch_lock);
+
+	/* boot image header and the kernel64 header on the page after it */
+	boot_prefetch_add("boot", false, 2 * BOOT_IMG_MAX_PAGE_SIZE);
+	boot_prefetch_add("recovery", false, 2 * BOOT_IMG_MAX_PAGE_SIZE);
+	/* ffbm cookie and bootloader message */
+	boot_prefetch_add("misc", false, page);
+	/* device info, see read_device_info_mmc */
+#if BOOT_2NDSTAGE
+	boot_prefetch_add("boot", true, mmc_get_device_blocksize());
+#elif VERIFIED_BOOT
+	boot_prefetch_add("devinfo", false, mmc_get_device_blocksize());
+#else
+	boot_prefetch_add("aboot", true, mmc_get_device_blocksize());
+#endif
+	/* splash image header */
+	boot_prefetch_add(SPLASH_PARTITION_NAME, false, mmc_get_device_blocksize());
+
+	/* issue them in device order, one read per run of touching entries */
+	qsort(prefetch, prefetch_count, sizeof(prefetch[0]), boot_prefetch_cmp);
+
+	for (i = 0; i < prefetch_count; ) {
+		unsigned first = i;
+		unsigned long long start = prefetch[i].offset;
+		unsigned long long end = start + prefetch[i].size;
+
+		for (i++; i < prefetch_count; i++) {
+			if (prefetch[i].lun != prefetch[first].lun || prefetch[i].offset > end)
+				break;
+			end = MAX(end, prefetch[i].offset + prefetch[i].size);
+		}
+
+		uint8_t *run = memalign(CACHE_LINE, ROUNDUP(end - start, CACHE_LINE));
+		if (!run)
+			break;
+
+		mmc_set_lun(prefetch[first].lun);
+		if (mmc_read(start, (uint32_t *)run, end - start)) {
+			dprintf(CRITICAL, "boot prefetch: read at 0x%llx failed\n", start);
+			free(run);
+			continue;
+		}
+
+		/* every entry gets its own copy so it can be dropped on its own */
+		for (unsigned j = first; j < i; j++) {
+			prefetch[j].buf = memalign(CACHE_LINE, ROUNDUP(prefetch[j].size, CACHE_LINE));
+			if (prefetch[j].buf)
+				memcpy(prefetch[j].buf, run + (prefetch[j].offset - start), prefetch[j].size);
+		}
+		free(run);
+	}
+
+	mmc_set_lun(saved_lun);
+	mutex_release(&prefetch_lock);
+	bs_scope_end(bs_scope);
+}
+
+static void boot_prefetch_drop(struct boot_prefetch_entry *e)
+{
+	free(e->buf);
+	e->buf = NULL;
+}
+
+uint32_t boot_prefetch_read(unsigned long long offset, void *buf, uint32_t size)
+{
+	uint8_t lun = mmc_get_lun();
+	unsigned i;
+
+	mutex_acquire(&prefetch_lock);
+	for (i = 0; i < prefetch_count; i++) {
+		struct boot_prefetch_entry *e = &prefetch[i];
+
+		if (!e->buf || e->lun != lun)
+			continue;
+		if (offset < e->offset || offset + size > e->offset + e->size)
+			continue;
+
+		memcpy(buf, e->buf + (offset - e->offset), size);
+		mutex_release(&prefetch_lock);
+		return 0;
+	}
+	mutex_release(&prefetch_lock);
+
+	return mmc_read(offset, buf, size);
+}
+
+void boot_prefetch_invalidate(unsigned long long offset, uint32_t size)
+{
+	unsigned i;
+
+	mutex_acquire(&prefetch_lock);
+	for (i = 0; i < prefetch_count; i++) {
+		struct boot_prefetch_entry *e = &prefetch[i];
+
+		if (e->buf && offset < e->offset + e->size && e->offset < offset + size)
+			boot_prefetch_drop(e);
+	}
+	mutex_release(&prefetch_lock);
+}
+
+void boot_prefetch_release(void)
+{
+	unsigned i;
+
+	mutex_acquire(&prefetch_lock);
+	for (i = 0; i < prefetch_count; i++)
+		boot_prefetch_drop(&prefetch[i]);
+
+	prefetch_count = 0;
+	mutex_release(&prefetch_lock);
+}
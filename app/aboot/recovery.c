@@ -48,6 +48,7 @@
 
 #include "recovery.h"
 #include "bootimg.h"
+#include "prefetch.h"
 #include "smem.h"
 
 #define BOOT_FLAGS	1
@@ -536,7 +537,7 @@ static int read_misc(unsigned page_offset, void *buf, unsigned size)
 			return -1;
 		}
 
-		if (mmc_read(ptn + offset, (unsigned int *)buf, size))
+		if (boot_prefetch_read(ptn + offset, (unsigned int *)buf, size))
 		{
 			dprintf(CRITICAL, "Reading MMC failed\n");
 			return -1;
@@ -588,6 +589,7 @@ int write_misc(unsigned page_offset, void *buf, unsigned size)
 
 		if (scratch_addr != buf)
 			memcpy(scratch_addr, buf, size);
+		boot_prefetch_invalidate(ptn + offset, aligned_size);
 		if (mmc_write(ptn + offset, aligned_size, (unsigned int *)scratch_addr))
 		{
 			dprintf(CRITICAL, "Writing MMC failed\n");
@@ -2,19 +2,29 @@ LOCAL_DIR := $(GET_LOCAL_DIR)
 
 MODULE := $(LOCAL_DIR)
 
+GLOBAL_INCLUDES += $(LOCAL_DIR)/include
+
+ifeq ($(FASTBOOT_STANDALONE),1)
+# fastboot protocol and transports only, without the android boot path.
+# Lets targets with no msm storage (pc-x86 under qemu) run fastboot udp.
+MODULE_SRCS += \
+	$(LOCAL_DIR)/fastboot.c \
+	$(LOCAL_DIR)/fastboot_udp.c \
+	$(LOCAL_DIR)/fastboot_app.c
+else
 MODULE_DEPS += \
 	lib/ext4 \
 	lib/bio \
 	lib/partition \
 	app/aboot/uboot_api
 
-GLOBAL_INCLUDES += $(LOCAL_DIR)/include
-
 GLOBAL_DEFINES += ASSERT_ON_TAMPER=1
 
 MODULE_SRCS += \
 	$(LOCAL_DIR)/aboot.c \
 	$(LOCAL_DIR)/fastboot.c \
+	$(LOCAL_DIR)/fastboot_udp.c \
+	$(LOCAL_DIR)/prefetch.c \
 	$(LOCAL_DIR)/recovery.c \
 	$(LOCAL_DIR)/grub.c
 	
@@ -24,17 +34,28 @@ GLOBAL_CFLAGS += -DGRUB_BOOT_PARTITION=\"$(GRUB_BOOT_PARTITION)\"
 GLOBAL_CFLAGS += -DGRUB_BOOT_PATH_PREFIX=\"$(GRUB_BOOT_PATH_PREFIX)\"
 endif
 
+# mount a sideloaded tar memdisk read-only at /memdisk before starting grub
+ifeq ($(ENABLE_GRUB_MEMDISK_TARFS),1)
+MODULE_DEPS += lib/fs/tarfs
+GLOBAL_DEFINES += GRUB_MEMDISK_TARFS=1
+endif
+
 ifeq ($(ENABLE_2NDSTAGE_BOOT),1)
 GLOBAL_DEFINES += BOOT_2NDSTAGE=1
 
 MODULE_SRCS += $(LOCAL_DIR)/2ndstage_tools.c
 endif
 
+ifneq ($(TARGET_BUILD_VARIANT),user)
+MODULE_DEPS += lib/evtrace
+endif
+
 ifneq ($(SPLASH_PARTITION_NAME),)
 GLOBAL_CFLAGS += -DSPLASH_PARTITION_NAME=$(SPLASH_PARTITION_NAME)
 else
 GLOBAL_CFLAGS += -DSPLASH_PARTITION_NAME=\"splash\"
 endif
 
+endif
 
 include make/module.mk
@@ -453,6 +453,8 @@ static int API_dev_read(va_list ap)
 			return API_EINVAL;
 
 		*act_len_stor = dev_read_stor(di->cookie, buf, *len_stor, *start);
+		if (*act_len_stor != *len_stor)
+			return API_EIO;
 
 	} else
 		return API_ENODEV;
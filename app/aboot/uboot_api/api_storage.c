@@ -12,6 +12,7 @@
 #include <api_public.h>
 #include <lib/bio.h>
 #include <malloc.h>
+#include <stdlib.h>
 #include <string.h>
 #include <assert.h>
 #include <printf.h>
@@ -39,6 +40,68 @@ static struct stor_spec specs[ENUM_MAX] = { { 0, 0, 0, 0, "" }, };
 
 static block_dev_desc_t* mmc_devices = NULL;
 
+/*
+ * GRUB walks ext4 with lots of small (mostly 4 KB) reads, many of them
+ * back to back. Each open device gets a read-ahead window: a small read
+ * that misses it but continues the previous one refills the window from
+ * there. Reads of at least a window go straight to the bdev, into the
+ * caller's buffer.
+ */
+#define STOR_READAHEAD_SIZE	(128 * 1024)
+
+struct stor_cache {
+	uint8_t		*buf;
+	lbaint_t	size;		/* window size in blocks */
+	lbaint_t	start;		/* first cached block */
+	lbaint_t	count;		/* cached blocks, 0 if empty */
+	lbaint_t	next;		/* block after the previous read */
+};
+
+static struct stor_cache *stor_cache_alloc(block_dev_desc_t *dd)
+{
+	struct stor_cache *cache;
+
+	if (!dd->blksz || dd->blksz > STOR_READAHEAD_SIZE)
+		return NULL;
+
+	cache = calloc(1, sizeof(*cache));
+	if (!cache)
+		return NULL;
+
+	cache->size = STOR_READAHEAD_SIZE / dd->blksz;
+	cache->buf = memalign(CACHE_LINE, ROUNDUP(STOR_READAHEAD_SIZE, CACHE_LINE));
+	if (!cache->buf) {
+		free(cache);
+		return NULL;
+	}
+
+	return cache;
+}
+
+static void stor_cache_free(struct stor_cache *cache)
+{
+	if (!cache)
+		return;
+
+	free(cache->buf);
+	free(cache);
+}
+
+/* read whole blocks from the bdev, returns the number of blocks read */
+static lbaint_t stor_bio_read(bdev_t *bdev, void *buffer, lbaint_t start, lbaint_t blkcnt)
+{
+	ssize_t ret;
+
+	ret = bio_read_block(bdev, buffer, start, blkcnt);
+	if (ret < 0) {
+		dprintf(CRITICAL, "%s: read of %lu blocks at %lu failed: %d\n",
+			bdev->name, (unsigned long)blkcnt, (unsigned long)start, (int)ret);
+		return 0;
+	}
+
+	return ret / bdev->block_size;
+}
+
 block_dev_desc_t *get_dev(const char *ifname, int dev) {
 	if(strcmp(ifname, "mmc")==0) {
 		if(dev>specs[ENUM_MMC].max_dev-1)
@@ -50,24 +113,67 @@ block_dev_desc_t *get_dev(const char *ifname, int dev) {
 	return NULL;
 }
 
+/* like U-Boot's block_read(), returns the number of blocks read */
 static unsigned long dev_mmc_block_read(int dev, lbaint_t start, lbaint_t blkcnt, void *buffer) {
 	block_dev_desc_t *ubootdev = get_dev("mmc", dev);
+	struct stor_cache *cache;
+	lbaint_t count;
+
 	if(!ubootdev || !ubootdev->biodev)
-		return API_EIO;
+		return 0;
+
+	if(start >= ubootdev->lba || blkcnt > ubootdev->lba - start)
+		return 0;
 
-	bio_read_block(ubootdev->biodev, buffer, start, blkcnt);
+	cache = ubootdev->priv;
+	if(!cache || blkcnt >= cache->size)
+		return stor_bio_read(ubootdev->biodev, buffer, start, blkcnt);
 
-	return 0;
+	// hit
+	if(cache->count && start >= cache->start && start + blkcnt <= cache->start + cache->count)
+		goto copy;
+
+	// random access: don't pull in a window nobody will use
+	if(start != cache->next) {
+		cache->next = start + blkcnt;
+		return stor_bio_read(ubootdev->biodev, buffer, start, blkcnt);
+	}
+
+	count = MIN(cache->size, ubootdev->lba - start);
+	cache->count = stor_bio_read(ubootdev->biodev, cache->buf, start, count);
+	cache->start = start;
+	if(cache->count < blkcnt) {
+		cache->count = 0;
+		return 0;
+	}
+
+copy:
+	memcpy(buffer, cache->buf + (start - cache->start) * ubootdev->blksz,
+	       blkcnt * ubootdev->blksz);
+	cache->next = start + blkcnt;
+
+	return blkcnt;
 }
 
+/* returns the number of blocks written */
 static unsigned long dev_mmc_block_write(int dev, lbaint_t start, lbaint_t blkcnt, const void *buffer) {
 	block_dev_desc_t *ubootdev = get_dev("mmc", dev);
+	struct stor_cache *cache;
+	ssize_t ret;
+
 	if(!ubootdev || !ubootdev->biodev)
-		return API_EIO;
+		return 0;
 
-	bio_write_block(ubootdev->biodev, buffer, start, blkcnt);
+	cache = ubootdev->priv;
+	if(cache && cache->count && start < cache->start + cache->count &&
+	   start + blkcnt > cache->start)
+		cache->count = 0;
 
-	return 0;
+	ret = bio_write_block(ubootdev->biodev, buffer, start, blkcnt);
+	if(ret < 0)
+		return 0;
+
+	return ret / ubootdev->blksz;
 }
 
 void bio_foreach_cb(const char* name) {
@@ -82,6 +188,7 @@ void bio_foreach_cb(const char* name) {
 	mmc_devices[id].blksz = dev->block_size;
 	mmc_devices[id].lba = dev->size/mmc_devices[id].blksz;
 	mmc_devices[id].biodev = NULL;
+	mmc_devices[id].priv = NULL;
 	mmc_devices[id].block_read = &dev_mmc_block_read;
 	mmc_devices[id].block_write = &dev_mmc_block_write;
 
@@ -356,10 +463,16 @@ int dev_open_stor(void *cookie)
 	if (!dev_stor_is_valid(type, ubootdev))
 		return API_ENODEV;
 
+	if(ubootdev->biodev)
+		return 0;
+
 	ubootdev->biodev = bio_open(ubootdev->name);
 	if(!ubootdev->biodev)
 		return API_ENODEV;
 
+	// without a window every read goes straight to the device
+	ubootdev->priv = stor_cache_alloc(ubootdev);
+
 	return 0;
 }
 
@@ -378,9 +491,12 @@ int dev_close_stor(void *cookie)
 	if(!ubootdev->biodev)
 		return 0;
 
+	stor_cache_free(ubootdev->priv);
+	ubootdev->priv = NULL;
+
 	bio_close(ubootdev->biodev);
 	ubootdev->biodev = NULL;
-	
+
 	return 0;
 }
 
@@ -9,6 +9,7 @@
 #define LOG_COLOR_BLUE 0,0,255
 
 void menu_putc(char c);
+void menu_puts(const char *str, size_t len);
 void menu_set_color(uint8_t r, uint8_t g, uint8_t b);
 
 #endif
@@ -62,18 +62,9 @@ unsigned logbuf_posx = 0;
 static mutex_t logbuf_mutex;
 static bool is_initialized = false;
 
-void menu_putc(char c) {
-	struct fbcon_config *config = fbcon_display();
-	static int in_putc = 0;
-
-	if(in_putc) return;
-
-	// lock
-	if(is_initialized && !in_critical_section())
-		mutex_acquire(&logbuf_mutex);
-	else enter_critical_section();
-
-	in_putc = 1;
+/* append one char to logbuf, returns true if a line got completed */
+static bool menu_putc_locked(struct fbcon_config *config, char c) {
+	bool newline = false;
 
 	// automatic line break
 	int cwidth = pf2font_get_cwidth(c);
@@ -81,7 +72,7 @@ void menu_putc(char c) {
 		logbuf_row++;
 		logbuf_col = 0;
 		logbuf_posx = 0;
-		display_server_refresh();
+		newline = true;
 	}
 
 	// scroll down
@@ -112,9 +103,36 @@ void menu_putc(char c) {
 		logbuf_row++;
 		logbuf_col = 0;
 		logbuf_posx = 0;
-		display_server_refresh();
+		newline = true;
+	}
+
+	return newline;
+}
+
+/* takes the lock and refreshes the display once for the whole run */
+void menu_puts(const char *str, size_t len) {
+	struct fbcon_config *config = fbcon_display();
+	static int in_putc = 0;
+	bool refresh = false;
+	size_t i;
+
+	if(in_putc) return;
+
+	// lock
+	if(is_initialized && !in_critical_section())
+		mutex_acquire(&logbuf_mutex);
+	else enter_critical_section();
+
+	in_putc = 1;
+
+	for(i=0; i<len; i++) {
+		if(menu_putc_locked(config, str[i]))
+			refresh = true;
 	}
 
+	if(refresh)
+		display_server_refresh();
+
 	// unlock
 	in_putc = 0;
 	if(is_initialized && !in_critical_section())
@@ -122,6 +140,10 @@ void menu_putc(char c) {
 	else exit_critical_section();
 }
 
+void menu_putc(char c) {
+	menu_puts(&c, 1);
+}
+
 void menu_set_color(uint8_t r, uint8_t g, uint8_t b)
 {
 	color_r = r;
@@ -185,7 +207,7 @@ static void menu_renderer(int keycode) {
 	int y = 1;
 	unsigned i;
 	int fh = pf2font_get_fontheight();
-	struct fbcon_config *config = fbcon_display();
+	struct fbcon_config *config;
 
 	// input handling
 	if(!block_user) {
@@ -224,8 +246,10 @@ static void menu_renderer(int keycode) {
 		}
 	}
 
-	// clear
+	// clear, then fetch the framebuffer so the full redraw skips the
+	// back buffer copy
 	fbcon_clear();
+	config = fbcon_display();
 
 	// title
 	menu_set_color(NORMAL_TEXT_COLOR);
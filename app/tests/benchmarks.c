@@ -32,6 +32,7 @@
 #include <kernel/semaphore.h>
 #include <kernel/event.h>
 #include <platform.h>
+#include <arch/ops.h>
 
 #if ARCH_ARM
 void bench_set_overhead(void)
@@ -176,6 +177,46 @@ void bench_memcpy(void)
 }
 #endif
 
+#if ARCH_ARM64 && ARM_WITH_CACHE
+static lk_bigtime_t bench_cache_memset_memcpy(uint8_t *buf, size_t len, uint iter)
+{
+	lk_bigtime_t t = current_time_hires();
+
+	for (uint i = 0; i < iter; i++) {
+		memset(buf, i, len / 2);
+		memcpy(buf + len / 2, buf, len / 2);
+	}
+
+	return current_time_hires() - t;
+}
+
+/* same workload with the data cache on and off */
+void bench_cache_modes(void)
+{
+	const size_t BUFSIZE = 1024 * 1024;
+	const uint ITER = 16;
+	uint8_t *buf = memalign(CACHE_LINE, BUFSIZE);
+	lk_bigtime_t cached, uncached;
+
+	if (!buf)
+		return;
+	printf("buf %p\n", buf);
+
+	cached = bench_cache_memset_memcpy(buf, BUFSIZE, ITER);
+
+	enter_critical_section();
+	arch_disable_cache(DCACHE);
+	uncached = bench_cache_memset_memcpy(buf, BUFSIZE, ITER);
+	arch_enable_cache(DCACHE);
+	exit_critical_section();
+
+	printf("memset+memcpy of %zu bytes %u times: %llu usecs cached, %llu usecs uncached (%llux)\n",
+	       BUFSIZE, ITER, cached, uncached, cached ? uncached / cached : 0);
+
+	free(buf);
+}
+#endif
+
 void benchmarks(void)
 {
 #if ARCH_ARM
@@ -189,5 +230,8 @@ void benchmarks(void)
 	bench_cset_stm();
 	bench_memcpy();
 #endif
+#if ARCH_ARM64 && ARM_WITH_CACHE
+	bench_cache_modes();
+#endif
 }
 
@@ -29,6 +29,9 @@
 #include <arch/ops.h>
 #include <lib/console.h>
 #include <platform.h>
+#if WITH_LIB_BIO
+#include <lib/bio.h>
+#endif
 
 static int cache_tests(int argc, const cmd_args *argv)
 {
@@ -59,8 +62,137 @@ static int cache_tests(int argc, const cmd_args *argv)
     return 0;
 }
 
+/* check the clean/invalidate contract the dma drivers rely on */
+static bool check_buf(const uint8_t *buf, uint8_t val, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        if (buf[i] != val)
+            return false;
+    }
+    return true;
+}
+
+#if WITH_LIB_BIO
+/*
+ * dirty every line of the destination, then let the device dma into it.
+ * a driver that skips the clean+invalidate either loses the dma data to
+ * a later eviction or reads back the stale pattern, so the result has to
+ * match a read done into a buffer with nothing dirty in it.
+ */
+static int cache_coherency_dma(const char *name)
+{
+#define COHERENCY_DMA_SIZE (64*1024)
+    static const uint8_t patterns[] = { 0x5a, 0xa5 };
+    int err = 0;
+    size_t len;
+    uint8_t *ref = NULL, *dst = NULL;
+
+    bdev_t *dev = bio_open(name);
+    if (!dev) {
+        printf("no block device %s, skipping dma check\n", name);
+        return 0;
+    }
+
+    len = MIN((off_t)COHERENCY_DMA_SIZE, dev->size);
+    len = ROUNDDOWN(len, dev->block_size);
+
+    ref = memalign(CACHE_LINE, ROUNDUP(len, CACHE_LINE));
+    dst = memalign(CACHE_LINE, ROUNDUP(len, CACHE_LINE));
+    if (!len || !ref || !dst) {
+        err = -1;
+        goto out;
+    }
+
+    /* known good copy: nothing dirty in the buffer while the device writes */
+    arch_clean_invalidate_cache_range((addr_t)ref, ROUNDUP(len, CACHE_LINE));
+    if (bio_read(dev, ref, 0, len) != (ssize_t)len) {
+        printf("reference read of %s failed\n", name);
+        err = -1;
+        goto out;
+    }
+
+    for (uint i = 0; i < countof(patterns); i++) {
+        memset(dst, patterns[i], len);
+        if (bio_read(dev, dst, 0, len) != (ssize_t)len) {
+            printf("read of %s into dirty lines failed\n", name);
+            err = -1;
+            break;
+        }
+
+        /* push out whatever is still cached, then look at memory */
+        arch_clean_invalidate_cache_range((addr_t)dst, ROUNDUP(len, CACHE_LINE));
+        if (memcmp(ref, dst, len)) {
+            printf("dma into dirty lines (pattern 0x%02x) returned stale data\n",
+                   patterns[i]);
+            err = -1;
+        }
+    }
+
+    if (!err)
+        printf("dma read of %zu bytes from %s into dirty lines ok\n", len, name);
+
+out:
+    free(dst);
+    free(ref);
+    bio_close(dev);
+
+    return err;
+}
+#endif
+
+static int cache_coherency(int argc, const cmd_args *argv)
+{
+#define COHERENCY_BUFSIZE (64*1024)
+    int err = 0;
+    uint8_t *buf = memalign(PAGE_SIZE, COHERENCY_BUFSIZE);
+    if (!buf)
+        return -1;
+
+    /* clean + invalidate must push the data out and read it back intact */
+    memset(buf, 0x5a, COHERENCY_BUFSIZE);
+    arch_clean_invalidate_cache_range((addr_t)buf, COHERENCY_BUFSIZE);
+    if (!check_buf(buf, 0x5a, COHERENCY_BUFSIZE)) {
+        printf("clean+invalidate lost data\n");
+        err = -1;
+    }
+
+    /* clean followed by invalidate must behave the same */
+    memset(buf, 0xa5, COHERENCY_BUFSIZE);
+    arch_clean_cache_range((addr_t)buf, COHERENCY_BUFSIZE);
+    arch_invalidate_cache_range((addr_t)buf, COHERENCY_BUFSIZE);
+    if (!check_buf(buf, 0xa5, COHERENCY_BUFSIZE)) {
+        printf("clean then invalidate lost data\n");
+        err = -1;
+    }
+
+    /*
+     * a bare invalidate discards dirty lines on a write back mapping and is
+     * a no-op on write through; report which one this buffer lives in.
+     */
+    memset(buf, 0x33, COHERENCY_BUFSIZE);
+    arch_invalidate_cache_range((addr_t)buf, COHERENCY_BUFSIZE);
+    if (check_buf(buf, 0xa5, COHERENCY_BUFSIZE))
+        printf("heap is mapped write back\n");
+    else if (check_buf(buf, 0x33, COHERENCY_BUFSIZE))
+        printf("heap is mapped write through\n");
+    else
+        printf("heap mapping is neither write back nor write through?\n");
+
+    free(buf);
+
+#if WITH_LIB_BIO
+    if (cache_coherency_dma(argc > 1 ? argv[1].str : "hd0") < 0)
+        err = -1;
+#endif
+
+    printf("cache coherency test %s\n", err ? "FAILED" : "passed");
+
+    return err;
+}
+
 STATIC_COMMAND_START
 STATIC_COMMAND("cache_tests", "tests of cpu cache", &cache_tests)
+STATIC_COMMAND("cache_coherency", "check cache clean/invalidate semantics and dma into dirty lines [bdev]", &cache_coherency)
 STATIC_COMMAND_END(cache_tests);
 
 #endif
@@ -29,6 +29,7 @@
 #include <kernel/mutex.h>
 #include <kernel/semaphore.h>
 #include <kernel/event.h>
+#include <kernel/timer.h>
 #include <platform.h>
 
 static int sleep_thread(void *arg)
@@ -480,6 +481,58 @@ static void preempt_test(void)
 	printf("done with preempt test, above time stamps should be very close\n");
 }
 
+static timer_t test_timers[64];
+static lk_time_t test_timer_due[64];
+static volatile int test_timers_pending;
+static volatile int test_timer_errors;
+
+static enum handler_return test_timer_cb(struct timer *t, lk_time_t now, void *arg)
+{
+	uint i = (uintptr_t)arg;
+
+	/* never early, and late by no more than the slack plus a tick */
+	if (TIME_LT(now, test_timer_due[i]) ||
+	    TIME_GT(now, test_timer_due[i] + TIMER_SLACK_MAX + 10)) {
+		printf("timer %u due %lu ran at %lu\n", i, test_timer_due[i], now);
+		test_timer_errors++;
+	}
+
+	test_timers_pending--;
+
+	return INT_NO_RESCHEDULE;
+}
+
+static void timer_test(void)
+{
+	uint i;
+
+	printf("testing timers\n");
+
+	test_timer_errors = 0;
+	test_timers_pending = countof(test_timers);
+
+	enter_critical_section();
+	for (i = 0; i < countof(test_timers); i++) {
+		lk_time_t delay = 1 + rand() % 300;
+
+		timer_initialize(&test_timers[i]);
+		test_timer_due[i] = current_time() + delay;
+		timer_set_oneshot(&test_timers[i], delay, test_timer_cb, (void *)(uintptr_t)i);
+	}
+
+	/* cancel every third one, from all over the queue */
+	for (i = 0; i < countof(test_timers); i += 3) {
+		timer_cancel(&test_timers[i]);
+		test_timers_pending--;
+	}
+	exit_critical_section();
+
+	while (test_timers_pending > 0)
+		thread_sleep(50);
+
+	printf("done with timer test, %d errors (should be zero)\n", test_timer_errors);
+}
+
 int thread_tests(void)
 {
 	mutex_test();
@@ -493,5 +546,7 @@ int thread_tests(void)
 
 	preempt_test();
 
+	timer_test();
+
 	return 0;
 }
@@ -144,6 +144,16 @@
 #define MMU_MEMORY_TYPE_NORMAL_WRITE_BACK_NO_ALLOCATE ((0x0 << 12) | (0x3 << 2))
 #define MMU_MEMORY_TYPE_NORMAL_WRITE_BACK_ALLOCATE    ((0x1 << 12) | (0x3 << 2))
 
+/* Memory type for the LK image, heap and scratch region. Write-back
+ * relies on every DMA master's driver doing its own cache maintenance,
+ * so it is opt-in with LK_MEMORY_WRITE_BACK=1.
+ */
+#if LK_MEMORY_WRITE_BACK
+#define MMU_MEMORY_TYPE_NORMAL_LK                     MMU_MEMORY_TYPE_NORMAL_WRITE_BACK_ALLOCATE
+#else
+#define MMU_MEMORY_TYPE_NORMAL_LK                     MMU_MEMORY_TYPE_NORMAL_WRITE_THROUGH
+#endif
+
 #define MMU_MEMORY_AP_NO_ACCESS     (0x0 << 10)
 #define MMU_MEMORY_AP_READ_ONLY     (0x7 << 10)
 #define MMU_MEMORY_AP_READ_WRITE    (0x3 << 10)
@@ -59,6 +59,7 @@ GLOBAL_DEFINES += \
 	ARM_ISA_ARMv7=1 \
 	ARM_ISA_ARMv7A=1 \
 	ARM_WITH_VFP=1 \
+	ARM_WITH_NEON=1 \
 	ARM_WITH_THUMB=1 \
 	ARM_WITH_THUMB2=1 \
 	ARM_WITH_CACHE=1 \
@@ -24,6 +24,7 @@
 #include <arch.h>
 #include <arch/ops.h>
 #include <arch/arm64.h>
+#include <arch/arm64/mmu.h>
 #include <platform.h>
 
 extern int _end_of_ram;
@@ -39,6 +40,16 @@ void arch_early_init(void)
     if (current_el > 1) {
         arm64_el3_to_el1();
     }
+
+#if ARM_WITH_MMU
+    /* turn off the cache */
+    arch_disable_cache(UCACHE);
+
+    arm64_mmu_init();
+
+    /* turn the cache back on */
+    arch_enable_cache(UCACHE);
+#endif
 }
 
 void arch_init(void)
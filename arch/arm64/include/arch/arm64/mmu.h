@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2014 Travis Geiselbrecht
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#pragma once
+
+#include <sys/types.h>
+#include <compiler.h>
+
+__BEGIN_CDECLS
+
+/* 4KB granule, 39 bit address space: translation starts at level 1 with
+ * 1GB blocks, level 2 tables map 2MB blocks.
+ */
+#define MMU_VA_BITS             39
+#define MMU_L1_BLOCK_SHIFT      30
+#define MMU_L2_BLOCK_SHIFT      21
+#define MMU_L1_BLOCK_SIZE       (1UL << MMU_L1_BLOCK_SHIFT)
+#define MMU_L2_BLOCK_SIZE       (1UL << MMU_L2_BLOCK_SHIFT)
+#define MMU_TABLE_ENTRIES       512
+
+/* descriptor types */
+#define MMU_PTE_DESCRIPTOR_INVALID  (0x0UL << 0)
+#define MMU_PTE_DESCRIPTOR_BLOCK    (0x1UL << 0)
+#define MMU_PTE_DESCRIPTOR_TABLE    (0x3UL << 0)
+#define MMU_PTE_DESCRIPTOR_MASK     (0x3UL << 0)
+
+/* block descriptor attribute bits */
+#define MMU_PTE_ATTR_INDEX(n)       ((uint64_t)(n) << 2)
+#define MMU_PTE_ATTR_INDEX_MASK     (0x7UL << 2)
+#define MMU_PTE_ATTR_AP_RW          (0x0UL << 6)
+#define MMU_PTE_ATTR_AP_RO          (0x2UL << 6)
+#define MMU_PTE_ATTR_SH_NON         (0x0UL << 8)
+#define MMU_PTE_ATTR_SH_OUTER       (0x2UL << 8)
+#define MMU_PTE_ATTR_SH_INNER       (0x3UL << 8)
+#define MMU_PTE_ATTR_AF             (0x1UL << 10)
+#define MMU_PTE_ATTR_PXN            (0x1UL << 53)
+#define MMU_PTE_ATTR_UXN            (0x1UL << 54)
+#define MMU_PTE_OUTPUT_ADDR_MASK    (0x0000fffffffff000UL)
+
+/* MAIR_EL1 slots, the attribute index in a descriptor selects one */
+#define MMU_MAIR_IDX_DEVICE         0
+#define MMU_MAIR_IDX_NORMAL_WB      1
+#define MMU_MAIR_IDX_NORMAL_UNCACHED 2
+#define MMU_MAIR_IDX_NORMAL_WT      3
+
+#define MMU_MAIR_VAL \
+    ((0x00UL << (MMU_MAIR_IDX_DEVICE * 8)) |          /* Device-nGnRnE */ \
+     (0xffUL << (MMU_MAIR_IDX_NORMAL_WB * 8)) |       /* Normal, WB RW-allocate */ \
+     (0x44UL << (MMU_MAIR_IDX_NORMAL_UNCACHED * 8)) | /* Normal, non-cacheable */ \
+     (0xbbUL << (MMU_MAIR_IDX_NORMAL_WT * 8)))        /* Normal, WT RW-allocate */
+
+/* memory types for mmu_section_t.flags, combine with an MMU_MEMORY_AP_* */
+#define MMU_MEMORY_TYPE_DEVICE \
+    (MMU_PTE_ATTR_INDEX(MMU_MAIR_IDX_DEVICE) | MMU_PTE_ATTR_PXN | MMU_PTE_ATTR_UXN)
+#define MMU_MEMORY_TYPE_NORMAL_WRITE_BACK \
+    (MMU_PTE_ATTR_INDEX(MMU_MAIR_IDX_NORMAL_WB) | MMU_PTE_ATTR_SH_INNER)
+#define MMU_MEMORY_TYPE_NORMAL_WRITE_THROUGH \
+    (MMU_PTE_ATTR_INDEX(MMU_MAIR_IDX_NORMAL_WT) | MMU_PTE_ATTR_SH_INNER)
+#define MMU_MEMORY_TYPE_NORMAL_UNCACHED \
+    (MMU_PTE_ATTR_INDEX(MMU_MAIR_IDX_NORMAL_UNCACHED) | MMU_PTE_ATTR_SH_INNER)
+
+#define MMU_MEMORY_AP_READ_WRITE    MMU_PTE_ATTR_AP_RW
+#define MMU_MEMORY_AP_READ_ONLY     MMU_PTE_ATTR_AP_RO
+#define MMU_MEMORY_XN               (MMU_PTE_ATTR_PXN | MMU_PTE_ATTR_UXN)
+
+/* TCR_EL1 for TTBR0 only, inner shareable write-back table walks */
+#define MMU_TCR_T0SZ(n)             ((uint64_t)(n) << 0)
+#define MMU_TCR_IRGN0_WBWA          (0x1UL << 8)
+#define MMU_TCR_ORGN0_WBWA          (0x1UL << 10)
+#define MMU_TCR_SH0_INNER           (0x3UL << 12)
+#define MMU_TCR_TG0_4K              (0x0UL << 14)
+#define MMU_TCR_EPD1                (0x1UL << 23)
+#define MMU_TCR_IPS(n)              ((uint64_t)(n) << 32)
+
+#define MMU_TCR_VAL \
+    (MMU_TCR_T0SZ(64 - MMU_VA_BITS) | MMU_TCR_IRGN0_WBWA | MMU_TCR_ORGN0_WBWA | \
+     MMU_TCR_SH0_INNER | MMU_TCR_TG0_4K | MMU_TCR_EPD1)
+
+/* SCTLR_EL1 bits */
+#define SCTLR_M     (1 << 0)
+#define SCTLR_A     (1 << 1)
+#define SCTLR_C     (1 << 2)
+#define SCTLR_I     (1 << 12)
+
+/* one platform memory map entry, addresses and size 2MB aligned */
+typedef struct {
+    uint64_t paddress;
+    uint64_t vaddress;
+    uint64_t size;
+    uint64_t flags;
+} mmu_section_t;
+
+void arm64_mmu_init(void);
+void arm64_mmu_map_section(const mmu_section_t *section);
+
+/* whole data cache maintenance by set/way, up to the point of coherency */
+void arm64_invalidate_dcache_all(void);
+void arm64_clean_invalidate_dcache_all(void);
+
+__END_CDECLS
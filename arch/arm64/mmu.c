@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2014 Travis Geiselbrecht
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <debug.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <compiler.h>
+#include <arch.h>
+#include <arch/ops.h>
+#include <arch/arm64.h>
+#include <arch/arm64/mmu.h>
+#include <platform.h>
+
+#if ARM_WITH_MMU
+
+/* level 2 tables for regions that are not 1GB aligned */
+#ifndef MMU_L2_TABLES
+#define MMU_L2_TABLES 8
+#endif
+
+static uint64_t mmu_l1_table[MMU_TABLE_ENTRIES] __ALIGNED(PAGE_SIZE);
+static uint64_t mmu_l2_tables[MMU_L2_TABLES][MMU_TABLE_ENTRIES] __ALIGNED(PAGE_SIZE);
+static uint mmu_l2_tables_used;
+
+static void arm64_invalidate_tlb(void)
+{
+    __asm__ volatile("dsb ishst" ::: "memory");
+    __asm__ volatile("tlbi vmalle1is" ::: "memory");
+    __asm__ volatile("dsb ish" ::: "memory");
+    ISB;
+}
+
+/* return the level 2 table behind a level 1 entry, splitting a 1GB block
+ * into 2MB blocks with the same attributes if there was one */
+static uint64_t *arm64_mmu_get_l2_table(uint l1_index)
+{
+    uint64_t entry = mmu_l1_table[l1_index];
+    uint64_t *l2;
+    uint i;
+
+    if ((entry & MMU_PTE_DESCRIPTOR_MASK) == MMU_PTE_DESCRIPTOR_TABLE)
+        return (uint64_t *)(uintptr_t)(entry & MMU_PTE_OUTPUT_ADDR_MASK);
+
+    if (mmu_l2_tables_used == MMU_L2_TABLES)
+        panic("arm64 mmu: out of level 2 tables, raise MMU_L2_TABLES\n");
+
+    l2 = mmu_l2_tables[mmu_l2_tables_used++];
+    for (i = 0; i < MMU_TABLE_ENTRIES; i++) {
+        if ((entry & MMU_PTE_DESCRIPTOR_MASK) == MMU_PTE_DESCRIPTOR_BLOCK)
+            l2[i] = entry + ((uint64_t)i << MMU_L2_BLOCK_SHIFT);
+        else
+            l2[i] = MMU_PTE_DESCRIPTOR_INVALID;
+    }
+
+    mmu_l1_table[l1_index] = (uintptr_t)l2 | MMU_PTE_DESCRIPTOR_TABLE;
+
+    return l2;
+}
+
+void arm64_mmu_map_section(const mmu_section_t *section)
+{
+    uint64_t paddr = section->paddress;
+    uint64_t vaddr = section->vaddress;
+    uint64_t size = section->size;
+    uint64_t attr = section->flags | MMU_PTE_ATTR_AF | MMU_PTE_DESCRIPTOR_BLOCK;
+    uint l1_index;
+    uint64_t *l2;
+
+    ASSERT(IS_ALIGNED(paddr, MMU_L2_BLOCK_SIZE));
+    ASSERT(IS_ALIGNED(vaddr, MMU_L2_BLOCK_SIZE));
+    ASSERT(IS_ALIGNED(size, MMU_L2_BLOCK_SIZE));
+    ASSERT(vaddr + size <= (1UL << MMU_VA_BITS));
+
+    while (size) {
+        l1_index = vaddr >> MMU_L1_BLOCK_SHIFT;
+
+        /* use a 1GB block wherever the region allows it */
+        if (IS_ALIGNED(paddr, MMU_L1_BLOCK_SIZE) && IS_ALIGNED(vaddr, MMU_L1_BLOCK_SIZE) &&
+            size >= MMU_L1_BLOCK_SIZE &&
+            (mmu_l1_table[l1_index] & MMU_PTE_DESCRIPTOR_MASK) != MMU_PTE_DESCRIPTOR_TABLE) {
+            mmu_l1_table[l1_index] = paddr | attr;
+            paddr += MMU_L1_BLOCK_SIZE;
+            vaddr += MMU_L1_BLOCK_SIZE;
+            size -= MMU_L1_BLOCK_SIZE;
+            continue;
+        }
+
+        l2 = arm64_mmu_get_l2_table(l1_index);
+        l2[(vaddr >> MMU_L2_BLOCK_SHIFT) & (MMU_TABLE_ENTRIES - 1)] = paddr | attr;
+        paddr += MMU_L2_BLOCK_SIZE;
+        vaddr += MMU_L2_BLOCK_SIZE;
+        size -= MMU_L2_BLOCK_SIZE;
+    }
+
+    arm64_invalidate_tlb();
+}
+
+void arm64_mmu_init(void)
+{
+    uint64_t pa_range;
+
+    /* the platform fills in its memory map, everything else faults */
+    platform_init_mmu_mappings();
+
+    /* output address size follows what the cpu implements */
+    pa_range = ARM64_READ_SYSREG(id_aa64mmfr0_el1) & 0xf;
+    if (pa_range > 5)
+        pa_range = 5;
+
+    ARM64_WRITE_SYSREG(mair_el1, MMU_MAIR_VAL);
+    ARM64_WRITE_SYSREG(tcr_el1, MMU_TCR_VAL | MMU_TCR_IPS(pa_range));
+    ARM64_WRITE_SYSREG(ttbr0_el1, (uint64_t)(uintptr_t)mmu_l1_table);
+
+    arm64_invalidate_tlb();
+
+    /* turn on the mmu, caches are enabled separately */
+    ARM64_WRITE_SYSREG(sctlr_el1, ARM64_READ_SYSREG(sctlr_el1) | SCTLR_M);
+}
+
+void arch_disable_mmu(void)
+{
+    DSB;
+    ARM64_WRITE_SYSREG(sctlr_el1, ARM64_READ_SYSREG(sctlr_el1) & ~SCTLR_M);
+    arm64_invalidate_tlb();
+}
+
+#endif // ARM_WITH_MMU
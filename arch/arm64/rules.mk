@@ -4,7 +4,9 @@ MODULE := $(LOCAL_DIR)
 
 GLOBAL_DEFINES += \
 	ARM64_CPU_$(ARM_CPU)=1 \
-	ARM_ISA_ARMV8=1
+	ARM_ISA_ARMV8=1 \
+	ARM_WITH_MMU=1 \
+	ARM_WITH_CACHE=1
 
 GLOBAL_INCLUDES += \
 	$(LOCAL_DIR)/include
@@ -12,8 +14,10 @@ GLOBAL_INCLUDES += \
 MODULE_SRCS += \
 	$(LOCAL_DIR)/arch.c \
 	$(LOCAL_DIR)/asm.S \
+	$(LOCAL_DIR)/cache-ops.S \
 	$(LOCAL_DIR)/exceptions.S \
 	$(LOCAL_DIR)/exceptions_c.c \
+	$(LOCAL_DIR)/mmu.c \
 	$(LOCAL_DIR)/thread.c \
 	$(LOCAL_DIR)/start.S \
 
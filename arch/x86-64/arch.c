@@ -41,6 +41,11 @@ void arch_early_init(void)
 	/* enable caches here for now */
 	clear_in_cr0(X86_CR0_NW | X86_CR0_CD);
 
+	/* let sse instructions run. xmm state is not part of the thread
+	 * context, code that uses it directly must save it around itself */
+	clear_in_cr0(X86_CR0_EM);
+	set_in_cr4(X86_CR4_OSFXSR | X86_CR4_OSXMMEXCPT);
+
 	memset(&system_tss, 0, sizeof(tss_t));
 
 	system_tss.esp0 = 0;
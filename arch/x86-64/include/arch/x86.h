@@ -77,6 +77,9 @@ typedef struct {
 #define X86_CR0_CD      0x40000000 /* cache disable */
 #define X86_CR0_PG      0x80000000 /* enable paging */
 
+#define X86_CR4_OSFXSR     0x00000200 /* fxsave/fxrstor and sse enable */
+#define X86_CR4_OSXMMEXCPT 0x00000400 /* unmasked simd fp exceptions */
+
 static inline void set_in_cr0(uint32_t mask)
 {
 	__asm__ __volatile__ (
@@ -97,6 +100,16 @@ static inline void clear_in_cr0(uint32_t mask)
 		: "ax");
 }
 
+static inline void set_in_cr4(uint32_t mask)
+{
+	__asm__ __volatile__ (
+		"movq %%cr4, %%rax	\n\t"
+		"orq %0, %%rax		\n\t"
+		"movq %%rax, %%cr4	\n\t"
+		: : "irg" ((uint64_t)mask)
+		: "ax");
+}
+
 static inline void x86_clts(void) {__asm__ __volatile__ ("clts"); }
 static inline void x86_hlt(void) {__asm__ __volatile__ ("hlt"); }
 static inline void x86_sti(void) {__asm__ __volatile__ ("sti"); }
@@ -0,0 +1,61 @@
+#ifndef __build_pc_x86_64_test_config_h_H
+#define __build_pc_x86_64_test_config_h_H
+#define LK 1
+#define PROJECT_PC_X86_64_TEST 1
+#define PROJECT "PC_X86_64_TEST"
+#define TARGET_PC_X86 1
+#define TARGET "PC_X86"
+#define PLATFORM_PC 1
+#define PLATFORM "PC"
+#define ARCH_X86_64 1
+#define ARCH "X86_64"
+#define WITH_APP 1
+#define WITH_DEV 1
+#define WITH_KERNEL 1
+#define WITH_LIB_CBUF 1
+#define WITH_LIB_DEBUG 1
+#define WITH_LIB_HEAP 1
+#define WITH_LIB_LIBC 1
+#define WITH_LIB_LWIP 1
+#define WITH_PLATFORM 1
+#define WITH_TARGET 1
+#define LK_DEBUGLEVEL 2
+#define GLOBAL_INCLUDES "_I__BUILD_PC_X86_64_TEST
+#define _I__INCLUDE
+#define _I__INCLUDE
+#define _IPLATFORM_PC_INCLUDE
+#define _IARCH_X86_64_INCLUDE
+#define _ILIB_LWIP_INCLUDE
+#define _ILIB_LWIP_INCLUDE_LWIP
+#define _ILIB_LWIP_INCLUDE_POSIX
+#define _ILIB_LWIP_INCLUDE_IPV4_"
+#define GLOBAL_COMPILEFLAGS "_G
+#define _FNO_BUILTIN
+#define _FINLINE
+#define _W
+#define _WALL
+#define _WNO_MULTICHAR
+#define _WNO_UNUSED_PARAMETER
+#define _WNO_UNUSED_FUNCTION
+#define _INCLUDE
+#define __BUILD_PC_X86_64_TEST_CONFIG_H
+#define _FFUNCTION_SECTIONS
+#define _FDATA_SECTIONS
+#define _FASYNCHRONOUS_UNWIND_TABLES
+#define _GDWARF_2
+#define _FNO_STACK_PROTECTOR_"
+#define GLOBAL_OPTFLAGS "_O2_"
+#define GLOBAL_CFLAGS "__STD GNU99
+#define _WERROR_IMPLICIT_FUNCTION_DECLARATION
+#define _WSTRICT_PROTOTYPES
+#define _WERROR
+#define _WEXTRA
+#define _WNO_ERROR STRICT_ALIASING_"
+#define GLOBAL_CPPFLAGS "_FNO_EXCEPTIONS
+#define _FNO_RTTI
+#define _FNO_THREADSAFE_STATICS_"
+#define GLOBAL_ASMFLAGS "_DASSEMBLY_"
+#define GLOBAL_LDFLAGS "_L
+#define _
+#define _GC_SECTIONS_"
+#endif
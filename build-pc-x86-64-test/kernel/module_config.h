@@ -0,0 +1,14 @@
+#ifndef __build_pc_x86_64_test_kernel_module_config_h_H
+#define __build_pc_x86_64_test_kernel_module_config_h_H
+#define MODULE_COMPILEFLAGS "_"
+#define MODULE_CFLAGS "_"
+#define MODULE_CPPFLAGS "_"
+#define MODULE_ASMFLAGS "_"
+#define MODULE_LDFLAGS "_"
+#define MODULE_OPTFLAGS "_"
+#define MODULE_INCLUDES "_"
+#define MODULE_SRCDEPS "_"
+#define MODULE_DEPS "LIB_LIBC
+#define LIB_DEBUG
+#define LIB_HEAP_"
+#endif
@@ -0,0 +1,34 @@
+#ifndef __build_pc_x86_fastboot_config_h_H
+#define __build_pc_x86_fastboot_config_h_H
+#define LK 1
+#define PROJECT_PC_X86_FASTBOOT 1
+#define PROJECT "PC_X86_FASTBOOT"
+#define TARGET_PC_X86 1
+#define TARGET "PC_X86"
+#define PLATFORM_PC 1
+#define PLATFORM "PC"
+#define ARCH_X86 1
+#define ARCH "X86"
+#define WITH_APP 1
+#define WITH_APP_ABOOT 1
+#define WITH_APP_SHELL 1
+#define WITH_DEV 1
+#define WITH_KERNEL 1
+#define WITH_LIB_CBUF 1
+#define WITH_LIB_CONSOLE 1
+#define WITH_LIB_DEBUG 1
+#define WITH_LIB_FFS 1
+#define WITH_LIB_HEAP 1
+#define WITH_LIB_LIBC 1
+#define WITH_LIB_LWIP 1
+#define WITH_PLATFORM 1
+#define WITH_TARGET 1
+#define LK_DEBUGLEVEL 2
+#define GLOBAL_INCLUDES "_I__BUILD_PC_X86_FASTBOOT__I__INCLUDE__I__INCLUDE__IPLATFORM_PC_INCLUDE__IARCH_X86_INCLUDE__IAPP_ABOOT_INCLUDE__ILIB_FFS_INCLUDE__ILIB_LWIP_INCLUDE__ILIB_LWIP_INCLUDE_LWIP__ILIB_LWIP_INCLUDE_POSIX__ILIB_LWIP_INCLUDE_IPV4__ILIB_CONSOLE_INCLUDE"
+#define GLOBAL_COMPILEFLAGS "_G__FNO_BUILTIN__FINLINE__W__WALL__WNO_MULTICHAR__WNO_UNUSED_PARAMETER__WNO_UNUSED_FUNCTION__INCLUDE___BUILD_PC_X86_FASTBOOT_CONFIG_H__FFUNCTION_SECTIONS__FDATA_SECTIONS__FASYNCHRONOUS_UNWIND_TABLES__GDWARF_2"
+#define GLOBAL_OPTFLAGS "_O2"
+#define GLOBAL_CFLAGS "__STD GNU99__WERROR_IMPLICIT_FUNCTION_DECLARATION__WSTRICT_PROTOTYPES__WERROR__WEXTRA__WNO_ERROR STRICT_ALIASING"
+#define GLOBAL_CPPFLAGS "_FNO_EXCEPTIONS__FNO_RTTI__FNO_THREADSAFE_STATICS"
+#define GLOBAL_ASMFLAGS "_DASSEMBLY"
+#define GLOBAL_LDFLAGS "_L____GC_SECTIONS"
+#endif
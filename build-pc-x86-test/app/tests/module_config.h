@@ -0,0 +1,12 @@
+#ifndef __build_pc_x86_test_app_tests_module_config_h_H
+#define __build_pc_x86_test_app_tests_module_config_h_H
+#define MODULE_COMPILEFLAGS "_WNO_FORMAT"
+#define MODULE_CFLAGS ""
+#define MODULE_CPPFLAGS ""
+#define MODULE_ASMFLAGS ""
+#define MODULE_LDFLAGS ""
+#define MODULE_OPTFLAGS ""
+#define MODULE_INCLUDES ""
+#define MODULE_SRCDEPS ""
+#define MODULE_DEPS ""
+#endif
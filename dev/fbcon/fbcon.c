@@ -94,33 +94,75 @@ void fbcon_flush(void)
 {
 	if (config->update_start)
 		config->update_start();
+	/* asynchronous flips complete in the background, see fbcon_sync() */
+	if (config->update_wait)
+		return;
 	if (config->update_done)
 		while (!config->update_done());
 }
 
-/* TODO: Take stride into account */
-static void fbcon_scroll_up(void)
+/* console text only touched rows y..y+count */
+static void fbcon_flush_rows(unsigned y, unsigned count)
+{
+	if (config->update_rows)
+		config->update_rows(y, count);
+	else
+		fbcon_flush();
+}
+
+/* make config->base safe to draw into after an asynchronous flush */
+static void fbcon_sync(bool keep)
 {
-	unsigned short *dst = config->base;
-	unsigned short *src = dst + (config->width * FONT_HEIGHT);
-	unsigned count = config->width * (config->height - FONT_HEIGHT);
+	if (config && config->update_wait)
+		config->update_wait(keep);
+}
 
-	while(count--) {
-		*dst++ = *src++;
+static void fbcon_scroll_up(void)
+{
+	unsigned bytes_per_bpp = config->bpp / 8;
+	unsigned pitch = (config->stride ? config->stride : config->width) * bytes_per_bpp;
+	unsigned row = config->width * bytes_per_bpp;
+	unsigned char *dst = config->base;
+	unsigned char *src = dst + pitch * FONT_HEIGHT;
+	unsigned i;
+
+	fbcon_sync(true);
+
+	/* whole rows move at once when there is no padding between them */
+	if (pitch == row) {
+		memmove(dst, src, pitch * (config->height - FONT_HEIGHT));
+		dst += pitch * (config->height - FONT_HEIGHT);
+	} else {
+		for (i = 0; i < config->height - FONT_HEIGHT; i++) {
+			memcpy(dst, src, row);
+			dst += pitch;
+			src += pitch;
+		}
 	}
 
-	count = config->width * FONT_HEIGHT;
-	while(count--) {
-		*dst++ = BGCOLOR;
+	for (i = 0; i < FONT_HEIGHT; i++) {
+		if (bytes_per_bpp == 2) {
+			uint16_t *pixels = (uint16_t *) dst;
+			unsigned count = config->width;
+
+			while (count--)
+				*pixels++ = BGCOLOR;
+		} else {
+			memset(dst, BGCOLOR, row);
+		}
+		dst += pitch;
 	}
 
-	fbcon_flush();
+	fbcon_flush_rows(0, config->height);
 }
 
 /* TODO: take stride into account */
 void fbcon_clear(void)
 {
 	unsigned count = config->width * config->height;
+
+	/* everything is about to be overwritten, skip the back buffer copy */
+	fbcon_sync(false);
 	memset(config->base, BGCOLOR, count * ((config->bpp) / 8));
 }
 
@@ -149,6 +191,7 @@ void fbcon_putc(char c)
 		return;
 	}
 
+	fbcon_sync(true);
 	pixels = config->base;
 	pixels += cur_pos.y * FONT_HEIGHT * config->width;
 	pixels += cur_pos.x * (FONT_WIDTH + 1);
@@ -166,7 +209,7 @@ newline:
 		cur_pos.y = max_pos.y - 1;
 		fbcon_scroll_up();
 	} else
-		fbcon_flush();
+		fbcon_flush_rows((cur_pos.y - 1) * FONT_HEIGHT, FONT_HEIGHT);
 }
 
 void fbcon_setup(struct fbcon_config *_config)
@@ -206,6 +249,7 @@ void fbcon_setup(struct fbcon_config *_config)
 
 struct fbcon_config* fbcon_display(void)
 {
+    fbcon_sync(true);
     return config;
 }
 
@@ -217,6 +261,11 @@ void display_image_on_screen(void)
 {
 	struct fbimage default_fbimg, *fbimg;
 	bool flag = true;
+	bool swap_rb = false;
+	unsigned char *image = NULL;
+	const unsigned char *packed;
+	size_t packed_len;
+	unsigned bytes_per_pixel;
 
 	fbcon_clear();
 	fbimg = fetch_image_from_partition();
@@ -227,31 +276,37 @@ void display_image_on_screen(void)
 		fbimg->header.width = SPLASH_IMAGE_WIDTH;
 		fbimg->header.height = SPLASH_IMAGE_HEIGHT;
 #if DISPLAY_TYPE_MIPI
-		fbimg->image = (unsigned char *)imageBuffer_rgb888;
-
+		packed = imageBuffer_rgb888;
+		packed_len = sizeof(imageBuffer_rgb888);
+		bytes_per_pixel = 3;
 	#if DISPLAY_USE_BGR
-			unsigned i;
-			for(i=0; i<(fbimg->header.width*fbimg->header.height); i++) {
-				int r,g,b;
-				char* color = (char*) fbimg->image + i*3;
-
-				r = color[0];
-				g = color[1];
-				b = color[2];
-
-				color[0] = b;
-				color[1] = g;
-				color[2] = r;
-			}
+		swap_rb = true;
 	#endif
 #else
-		fbimg->image = (unsigned char *)imageBuffer;
+		packed = imageBuffer;
+		packed_len = sizeof(imageBuffer);
+		bytes_per_pixel = 2;
 #endif
+		image = malloc(SPLASH_IMAGE_WIDTH * SPLASH_IMAGE_HEIGHT * bytes_per_pixel);
+		if (!image) {
+			dprintf(CRITICAL, "No memory for the default splash image\n");
+			return;
+		}
+
+		if (fbcon_decode_image(LOGO_IMG_TYPE_RLE, packed, packed_len, image,
+			SPLASH_IMAGE_WIDTH * SPLASH_IMAGE_HEIGHT * bytes_per_pixel,
+			bytes_per_pixel, swap_rb)) {
+			dprintf(CRITICAL, "Cannot decode the default splash image\n");
+			free(image);
+			return;
+		}
+		fbimg->image = image;
 	}
 
 	fbcon_putImage(fbimg, flag);
 	if (flag && fbimg)
 		free(fbimg);
+	free(image);
 }
 
 void fbcon_putImage(struct fbimage *fbimg, bool flag)
@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2015, The Linux Foundation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of The Linux Foundation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <debug.h>
+#include <err.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dev/fbcon.h>
+
+/*
+ * Decoders for the compressed splash formats. Both write straight into
+ * the destination (normally the framebuffer) and never run past dst_len,
+ * so a corrupt splash partition can at worst produce a garbled logo.
+ *
+ * RLE works on whole pixels: a control byte with bit 7 set is followed by
+ * one pixel repeated (c & 0x7f) + 1 times, otherwise (c + 1) literal
+ * pixels follow. LZ4 is the plain block format (no frame header).
+ */
+
+static inline void logo_put_pixel(uint8_t *dst, const uint8_t *px,
+	unsigned bytes_per_pixel, bool swap_rb)
+{
+	if (swap_rb && bytes_per_pixel == 3) {
+		dst[0] = px[2];
+		dst[1] = px[1];
+		dst[2] = px[0];
+	} else {
+		memcpy(dst, px, bytes_per_pixel);
+	}
+}
+
+static int logo_decode_rle(const uint8_t *src, size_t src_len,
+	uint8_t *dst, size_t dst_len, unsigned bytes_per_pixel, bool swap_rb)
+{
+	const uint8_t *ip = src;
+	const uint8_t *iend = src + src_len;
+	uint8_t *op = dst;
+	uint8_t *oend = dst + dst_len;
+
+	while (ip < iend && op < oend) {
+		unsigned ctrl = *ip++;
+		size_t count = (ctrl & 0x7f) + 1;
+
+		if ((size_t)(oend - op) < count * bytes_per_pixel)
+			return ERR_BAD_LEN;
+
+		if (ctrl & 0x80) {
+			if ((size_t)(iend - ip) < bytes_per_pixel)
+				return ERR_BAD_LEN;
+
+			logo_put_pixel(op, ip, bytes_per_pixel, swap_rb);
+			ip += bytes_per_pixel;
+
+			/* replicate by doubling the already written pixels */
+			size_t done = bytes_per_pixel;
+			size_t total = count * bytes_per_pixel;
+			while (done < total) {
+				size_t n = MIN(done, total - done);
+				memcpy(op + done, op, n);
+				done += n;
+			}
+			op += total;
+		} else {
+			if ((size_t)(iend - ip) < count * bytes_per_pixel)
+				return ERR_BAD_LEN;
+
+			if (swap_rb && bytes_per_pixel == 3) {
+				while (count--) {
+					logo_put_pixel(op, ip, 3, true);
+					op += 3;
+					ip += 3;
+				}
+			} else {
+				memcpy(op, ip, count * bytes_per_pixel);
+				op += count * bytes_per_pixel;
+				ip += count * bytes_per_pixel;
+			}
+		}
+	}
+
+	return (op == oend) ? NO_ERROR : ERR_BAD_LEN;
+}
+
+static int logo_lz4_length(const uint8_t **ip, const uint8_t *iend, size_t *len)
+{
+	uint8_t b;
+
+	do {
+		if (*ip >= iend)
+			return ERR_BAD_LEN;
+		b = *(*ip)++;
+		*len += b;
+	} while (b == 255);
+
+	return NO_ERROR;
+}
+
+static int logo_decode_lz4(const uint8_t *src, size_t src_len,
+	uint8_t *dst, size_t dst_len)
+{
+	const uint8_t *ip = src;
+	const uint8_t *iend = src + src_len;
+	uint8_t *op = dst;
+	uint8_t *oend = dst + dst_len;
+
+	while (ip < iend) {
+		unsigned token = *ip++;
+		size_t len = token >> 4;
+
+		/* literals */
+		if (len == 15 && logo_lz4_length(&ip, iend, &len))
+			return ERR_BAD_LEN;
+		if ((size_t)(iend - ip) < len || (size_t)(oend - op) < len)
+			return ERR_BAD_LEN;
+		memcpy(op, ip, len);
+		ip += len;
+		op += len;
+
+		/* the last sequence carries literals only */
+		if (ip == iend)
+			break;
+
+		/* match */
+		if (iend - ip < 2)
+			return ERR_BAD_LEN;
+		size_t offset = ip[0] | (ip[1] << 8);
+		ip += 2;
+		if (offset == 0 || offset > (size_t)(op - dst))
+			return ERR_BAD_LEN;
+
+		len = token & 0xf;
+		if (len == 15 && logo_lz4_length(&ip, iend, &len))
+			return ERR_BAD_LEN;
+		len += 4;
+		if ((size_t)(oend - op) < len)
+			return ERR_BAD_LEN;
+
+		const uint8_t *match = op - offset;
+		if (offset >= len) {
+			memcpy(op, match, len);
+			op += len;
+		} else {
+			/* overlapping copy, must go byte by byte */
+			while (len--)
+				*op++ = *match++;
+		}
+	}
+
+	return (op == oend) ? NO_ERROR : ERR_BAD_LEN;
+}
+
+void fbcon_swap_rb(void *buf, size_t pixels)
+{
+	uint8_t *p = buf;
+	uint8_t t;
+
+	while (pixels--) {
+		t = p[0];
+		p[0] = p[2];
+		p[2] = t;
+		p += 3;
+	}
+}
+
+int fbcon_decode_image(uint32_t type, const void *src, size_t src_len,
+	void *dst, size_t dst_len, unsigned bytes_per_pixel, bool swap_rb)
+{
+	int ret;
+
+	if (!bytes_per_pixel || dst_len % bytes_per_pixel)
+		return ERR_INVALID_ARGS;
+
+	switch (type) {
+		case LOGO_IMG_TYPE_RAW:
+			if (src_len < dst_len)
+				return ERR_BAD_LEN;
+			if (src != dst)
+				memcpy(dst, src, dst_len);
+			ret = NO_ERROR;
+			break;
+		case LOGO_IMG_TYPE_RLE:
+			return logo_decode_rle(src, src_len, dst, dst_len,
+				bytes_per_pixel, swap_rb);
+		case LOGO_IMG_TYPE_LZ4:
+			/*
+			 * Matches may start mid-pixel, so channels cannot be
+			 * reordered while the stream is being expanded.
+			 */
+			ret = logo_decode_lz4(src, src_len, dst, dst_len);
+			break;
+		default:
+			dprintf(CRITICAL, "Unknown splash image type %u\n", type);
+			return ERR_NOT_SUPPORTED;
+	}
+
+	if (ret == NO_ERROR && swap_rb && bytes_per_pixel == 3)
+		fbcon_swap_rb(dst, dst_len / 3);
+
+	return ret;
+}
@@ -3,6 +3,7 @@ LOCAL_DIR := $(GET_LOCAL_DIR)
 MODULE := $(LOCAL_DIR)
 
 MODULE_SRCS += \
-	$(LOCAL_DIR)/fbcon.c
+	$(LOCAL_DIR)/fbcon.c \
+	$(LOCAL_DIR)/logo.c
 
 include make/module.mk
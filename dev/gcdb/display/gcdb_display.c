@@ -144,8 +144,12 @@ static int mdss_dsi_panel_pre_init(void)
 		}
 	}
 
-	if(panelstruct.paneldata->panel_init_delay)
-		udelay(panelstruct.paneldata->panel_init_delay);
+	/* panel_init_delay is in us but can run to tens of ms; the whole
+	 * milliseconds go through mdelay() so they do not hold the cpu */
+	if(panelstruct.paneldata->panel_init_delay) {
+		mdelay(panelstruct.paneldata->panel_init_delay / 1000);
+		udelay(panelstruct.paneldata->panel_init_delay % 1000);
+	}
 
 	dprintf(SPEW, "Panel pre init done\n");
 	return ret;
@@ -22,6 +22,8 @@
  */
 #include <dev/virtio/block.h>
 
+#include <stdlib.h>
+#include <stdio.h>
 #include <debug.h>
 #include <assert.h>
 #include <trace.h>
@@ -30,6 +32,7 @@
 #include <err.h>
 #include <kernel/thread.h>
 #include <kernel/event.h>
+#include <lib/bio.h>
 
 #define LOCAL_TRACE 1
 
@@ -68,9 +71,32 @@ struct virtio_blk_req {
 #define VIRTIO_BLK_S_IOERR      1
 #define VIRTIO_BLK_S_UNSUPP     2
 
-static enum handler_return virtio_block_irq_driver_callback(struct virtio_device *dev, uint ring, const struct vring_used_elem *e);
+#define VIRTIO_BLK_RING_LEN     128
+
+/* descriptors kept back for the synchronous read/write path */
+#define VIRTIO_BLK_SYNC_DESCS   3
+
+/* one transfer in flight, indexed by the head descriptor of its chain */
+struct virtio_blk_txn {
+    bio_request_t *req;
+    event_t *event;     /* synchronous reads wait on this for *result */
+    ssize_t *result;
+    size_t len;
+    struct virtio_blk_req blk_req;
+    uint8_t status;
+};
 
-static event_t *curr_event;
+struct virtio_block_dev {
+    bdev_t bdev;
+    struct virtio_device *dev;
+
+    struct virtio_blk_txn txn[VIRTIO_BLK_RING_LEN];
+};
+
+static enum handler_return virtio_block_irq_driver_callback(struct virtio_device *dev, uint ring, const struct vring_used_elem *e);
+static ssize_t virtio_bdev_read_block(struct bdev *bdev, void *buf, bnum_t block, uint count);
+static ssize_t virtio_bdev_write_block(struct bdev *bdev, const void *buf, bnum_t block, uint count);
+static status_t virtio_bdev_submit(struct bdev *bdev, bio_request_t *req);
 
 status_t virtio_block_init(struct virtio_device *dev, uint32_t host_features)
 {
@@ -83,17 +109,39 @@ status_t virtio_block_init(struct virtio_device *dev, uint32_t host_features)
     LTRACEF("seg_max  0x%x\n", config->seg_max);
     LTRACEF("blk_size 0x%x\n", config->blk_size);
 
+    struct virtio_block_dev *bdev = calloc(1, sizeof(struct virtio_block_dev));
+    if (!bdev)
+        return ERR_NO_MEMORY;
+
+    bdev->dev = dev;
+    dev->priv = bdev;
+
     /* allocate a virtio ring */
-    virtio_alloc_ring(dev, 0, 128);
+    virtio_alloc_ring(dev, 0, VIRTIO_BLK_RING_LEN);
 
     /* set our irq handler */
     dev->irq_driver_callback = &virtio_block_irq_driver_callback;
 
+    /* publish a block device that keeps as many requests in flight as the ring allows */
+    char name[16];
+    snprintf(name, sizeof(name), "virtio%u", dev->index);
+    bio_initialize_bdev(&bdev->bdev, name, 512, config->capacity);
+
+    bdev->bdev.read_block = &virtio_bdev_read_block;
+    bdev->bdev.write_block = &virtio_bdev_write_block;
+    bdev->bdev.submit = &virtio_bdev_submit;
+    bdev->bdev.queue_depth = (VIRTIO_BLK_RING_LEN - VIRTIO_BLK_SYNC_DESCS) / (BIO_MAX_IOV + 2);
+
+    bio_register_device(&bdev->bdev);
+
     return NO_ERROR;
 }
 
 static enum handler_return virtio_block_irq_driver_callback(struct virtio_device *dev, uint ring, const struct vring_used_elem *e)
 {
+    struct virtio_block_dev *bdev = (struct virtio_block_dev *)dev->priv;
+    struct virtio_blk_txn *txn = &bdev->txn[e->id];
+
     LTRACEF("dev %p, ring %u, e %p, id %u, len %u\n", dev, ring, e, e->id, e->len);
 
     /* parse our descriptor chain, add back to the free queue */
@@ -116,66 +164,145 @@ static enum handler_return virtio_block_irq_driver_callback(struct virtio_device
         i = next;
     }
 
-    /* signal our event */
-    event_signal(curr_event, false);
+    /* finish the request or wake up the synchronous reader */
+    ssize_t result = (txn->status == VIRTIO_BLK_S_OK) ? (ssize_t)txn->len : ERR_IO;
+    if (txn->req) {
+        bio_request_complete(txn->req, result);
+    } else if (txn->event) {
+        *txn->result = result;
+        event_signal(txn->event, false);
+    }
 
     return INT_RESCHEDULE;
 }
 
-ssize_t virtio_block_read(struct virtio_device *dev, void *buf, off_t offset, size_t len)
+/* queue a chain of header, data segments and status */
+static status_t virtio_block_queue(struct virtio_block_dev *bdev, uint32_t type, uint64_t sector,
+                                   const iovec_t *iov, uint iov_cnt,
+                                   bio_request_t *req, event_t *event, ssize_t *result)
 {
-    uint16_t i;
+    struct virtio_device *dev = bdev->dev;
     struct vring_desc *desc;
+    struct virtio_blk_txn *txn;
+    uint16_t i;
 
-    LTRACEF("dev %p, buf %p, offset 0x%llx, len %zu\n", dev, buf, offset, len);
-
-    /* set up the request */
-    struct virtio_blk_req blk_req;
-    blk_req.type = VIRTIO_BLK_T_IN;
-    blk_req.ioprio = 0;
-    blk_req.sector = offset / 512;
+    enter_critical_section();
 
     /* put together a transfer */
-    desc = virtio_alloc_desc_chain(dev, 0, 3, &i);
+    desc = virtio_alloc_desc_chain(dev, 0, iov_cnt + 2, &i);
+    if (!desc) {
+        exit_critical_section();
+        return ERR_BUSY;
+    }
+
     LTRACEF("after alloc chain desc %p, i %u\n", desc, i);
 
+    txn = &bdev->txn[i];
+    txn->req = req;
+    txn->event = event;
+    txn->result = result;
+    txn->len = iovec_size(iov, iov_cnt);
+    txn->blk_req.type = type;
+    txn->blk_req.ioprio = 0;
+    txn->blk_req.sector = sector;
+    txn->status = 0xff;
+
     /* set up the descriptor pointing to the head */
-    desc->addr = (uint64_t)(uintptr_t)&blk_req;
-    desc->len = sizeof(blk_req);
+    desc->addr = (uint64_t)(uintptr_t)&txn->blk_req;
+    desc->len = sizeof(txn->blk_req);
     desc->flags |= VRING_DESC_F_NEXT;
     virtio_dump_desc(desc);
 
-    /* set up the descriptor pointing to the buffer */
-    desc = virtio_desc_index_to_desc(dev, 0, desc->next);
-    desc->addr = (uint64_t)(uintptr_t)buf;
-    desc->len = len;
-    desc->flags |= VRING_DESC_F_NEXT | VRING_DESC_F_WRITE;
-    virtio_dump_desc(desc);
+    /* set up the descriptors pointing to the buffer */
+    for (uint seg = 0; seg < iov_cnt; seg++) {
+        desc = virtio_desc_index_to_desc(dev, 0, desc->next);
+        desc->addr = (uint64_t)(uintptr_t)iov[seg].iov_base;
+        desc->len = iov[seg].iov_len;
+        desc->flags |= VRING_DESC_F_NEXT;
+        if (type == VIRTIO_BLK_T_IN)
+            desc->flags |= VRING_DESC_F_WRITE;
+        virtio_dump_desc(desc);
+    }
 
     /* set up the descriptor pointing to the response */
-    uint8_t blk_response;
     desc = virtio_desc_index_to_desc(dev, 0, desc->next);
-    desc->addr = (uint64_t)(uintptr_t)&blk_response;
+    desc->addr = (uint64_t)(uintptr_t)&txn->status;
     desc->len = 1;
     desc->flags = VRING_DESC_F_WRITE;
     virtio_dump_desc(desc);
 
-    /* set up an event to block on */
-    event_t event;
-    event_init(&event, false, 0);
-    curr_event = &event;
-
     /* submit the transfer */
     virtio_submit_chain(dev, 0, i);
 
     /* kick it off */
     virtio_kick(dev, 0);
 
+    exit_critical_section();
+
+    return NO_ERROR;
+}
+
+/* queue a single buffer and wait for it, for the synchronous entry points */
+static ssize_t virtio_block_sync(struct virtio_device *dev, uint32_t type, void *buf, off_t offset, size_t len)
+{
+    struct virtio_block_dev *bdev = (struct virtio_block_dev *)dev->priv;
+    iovec_t iov = { buf, len };
+    ssize_t result = 0;
+    status_t err;
+
+    LTRACEF("dev %p, type %u, buf %p, offset 0x%llx, len %zu\n", dev, type, buf, offset, len);
+
+    /* set up an event to block on */
+    event_t event;
+    event_init(&event, false, 0);
+
+    err = virtio_block_queue(bdev, type, offset / 512, &iov, 1, NULL, &event, &result);
+    if (err < 0) {
+        event_destroy(&event);
+        return err;
+    }
+
     /* wait for the transfer to complete */
     event_wait(&event);
+    event_destroy(&event);
+
+    LTRACEF("result %ld\n", (long)result);
+
+    return result;
+}
+
+ssize_t virtio_block_read(struct virtio_device *dev, void *buf, off_t offset, size_t len)
+{
+    return virtio_block_sync(dev, VIRTIO_BLK_T_IN, buf, offset, len);
+}
+
+ssize_t virtio_block_write(struct virtio_device *dev, const void *buf, off_t offset, size_t len)
+{
+    return virtio_block_sync(dev, VIRTIO_BLK_T_OUT, (void *)buf, offset, len);
+}
+
+static ssize_t virtio_bdev_read_block(struct bdev *_bdev, void *buf, bnum_t block, uint count)
+{
+    struct virtio_block_dev *bdev = (struct virtio_block_dev *)_bdev;
+
+    return virtio_block_read(bdev->dev, buf, (off_t)block * 512, (size_t)count * 512);
+}
+
+static ssize_t virtio_bdev_write_block(struct bdev *_bdev, const void *buf, bnum_t block, uint count)
+{
+    struct virtio_block_dev *bdev = (struct virtio_block_dev *)_bdev;
+
+    return virtio_block_write(bdev->dev, buf, (off_t)block * 512, (size_t)count * 512);
+}
+
+static status_t virtio_bdev_submit(struct bdev *_bdev, bio_request_t *req)
+{
+    struct virtio_block_dev *bdev = (struct virtio_block_dev *)_bdev;
+    uint32_t type = (req->op == BIO_OP_READ) ? VIRTIO_BLK_T_IN : VIRTIO_BLK_T_OUT;
 
-    LTRACEF("status 0x%hhx\n", blk_response);
+    LTRACEF("req %p, op %d, block %u, count %u\n", req, req->op, req->block, req->count);
 
-    return len;
+    /* the queue depth leaves enough descriptors for every request in flight */
+    return virtio_block_queue(bdev, type, req->block, req->iov, req->iov_cnt, req, NULL, NULL);
 }
 
@@ -32,18 +32,32 @@
 #define __DEV_FBCON_H
 
 #include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
 #define LOGO_IMG_OFFSET (12*1024*1024)
 #define LOGO_IMG_MAGIC "SPLASH!!"
 #define LOGO_IMG_MAGIC_SIZE sizeof(LOGO_IMG_MAGIC) - 1
+/* Compressed images, the header carries the type and size fields */
+#define LOGO_IMG_MAGIC_PACKED "SPLASHZ!"
 
+#define LOGO_IMG_TYPE_RAW 0
+#define LOGO_IMG_TYPE_RLE 1
+#define LOGO_IMG_TYPE_LZ4 2
 
 struct logo_img_header {
     unsigned char magic[LOGO_IMG_MAGIC_SIZE]; // "SPLASH!!"
     uint32_t width; // logo's width, little endian
     uint32_t height; // logo's height, little endian
     uint32_t offset;
+    /* only valid with LOGO_IMG_MAGIC_PACKED, raw images start here */
+    uint32_t type; // LOGO_IMG_TYPE_*
+    uint32_t size; // compressed payload size in bytes
 };
 
+/* the header is padded to this size on disk and the payload, raw or
+ * packed, follows it. keep in sync with scripts/logo_gen.py */
+#define LOGO_IMG_HEADER_SIZE 512
+
 struct fbimage {
 	struct logo_img_header  header;
 	void *image;
@@ -64,6 +78,12 @@ struct fbcon_config {
 
 	void        (*update_start)(void);
 	int     (*update_done)(void);
+	/* set when update_start() flips buffers asynchronously; blocks until
+	 * the flip completed and, if keep is set, base holds the last frame */
+	void        (*update_wait)(bool keep);
+	/* optional, console text changed rows y..y+count of base; makes them
+	 * visible without the full update_start() */
+	void        (*update_rows)(unsigned y, unsigned count);
 };
 
 void fbcon_setup(struct fbcon_config *cfg);
@@ -71,5 +91,8 @@ void fbcon_putc(char c);
 void fbcon_clear(void);
 void fbcon_flush(void);
 struct fbcon_config* fbcon_display(void);
+int fbcon_decode_image(uint32_t type, const void *src, size_t src_len,
+	void *dst, size_t dst_len, unsigned bytes_per_pixel, bool swap_rb);
+void fbcon_swap_rb(void *buf, size_t pixels);
 
 #endif /* __DEV_FBCON_H */
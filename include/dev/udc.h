@@ -47,6 +47,7 @@ struct udc_request *udc_request_alloc(void);
 void udc_request_free(struct udc_request *req);
 int udc_request_queue(struct udc_endpoint *ept, struct udc_request *req);
 int udc_request_cancel(struct udc_endpoint *ept, struct udc_request *req);
+int udc_request_reserve(struct udc_request *req, unsigned len);
 
 #define UDC_TYPE_BULK_IN    1
 #define UDC_TYPE_BULK_OUT   2
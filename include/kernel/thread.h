@@ -45,6 +45,7 @@ typedef int (*thread_start_routine)(void *arg);
 
 /* thread local storage */
 enum thread_tls_list {
+	TLS_ENTRY_BOOT_SCOPE,	/* innermost open boot_stats scope, plus one */
 	MAX_TLS_ENTRY
 };
 
@@ -199,6 +200,11 @@ struct thread_stats {
 	int interrupts; /* platform code increment this */
 	int timer_ints; /* timer code increment this */
 	int timers; /* timer code increment this */
+	int timer_sets; /* timer code increment this */
+	int timer_cancels; /* timer code increment this */
+	int timers_coalesced; /* timers run by an interrupt after the first one */
+	int timers_queued; /* currently pending */
+	int timers_queued_max;
 };
 
 extern struct thread_stats thread_stats;
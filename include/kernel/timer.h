@@ -33,11 +33,21 @@ typedef enum handler_return (*timer_callback)(struct timer *, lk_time_t now, voi
 
 #define TIMER_MAGIC 'timr'
 
+/* upper bound on how late a timer may be run to share an interrupt, ms */
+#define TIMER_SLACK_MAX 10
+
 typedef struct timer {
 	int magic;
-	struct list_node node;
 
-	lk_time_t scheduled_time;
+	/* pairing heap links: first child, next sibling, and the parent for a
+	 * first child or the previous sibling otherwise. heap_prev is NULL for
+	 * the root and for timers that are not queued */
+	struct timer *heap_child;
+	struct timer *heap_next;
+	struct timer *heap_prev;
+
+	lk_time_t scheduled_time;	/* earliest the callback may run */
+	lk_time_t deadline;		/* latest, the queue is ordered on this */
 	lk_time_t periodic_time;
 
 	timer_callback callback;
@@ -47,8 +57,11 @@ typedef struct timer {
 #define TIMER_INITIAL_VALUE(t) \
 { \
 	.magic = TIMER_MAGIC, \
-	.node = LIST_INITIAL_CLEARED_VALUE, \
+	.heap_child = NULL, \
+	.heap_next = NULL, \
+	.heap_prev = NULL, \
 	.scheduled_time = 0, \
+	.deadline = 0, \
 	.periodic_time = 0, \
 	.callback = NULL, \
 	.arg = NULL, \
@@ -59,6 +72,9 @@ typedef struct timer {
  * - Timers may be programmed or canceled from interrupt or thread context
  * - Timers may be canceled or reprogrammed from within their callback
  * - Timers currently are dispatched from a 10ms periodic tick
+ * - With PLATFORM_HAS_DYNAMIC_TIMER a timer may run up to 1/16th of its
+ *   delay (at most TIMER_SLACK_MAX ms) late, so nearby deadlines share
+ *   one interrupt
 */
 void timer_initialize(timer_t *);
 void timer_set_oneshot(timer_t *, lk_time_t delay, timer_callback, void *arg);
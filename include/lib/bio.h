@@ -24,9 +24,57 @@
 
 #include <sys/types.h>
 #include <list.h>
+#include <iovec.h>
+#include <lib/dpc.h>
 
 typedef uint32_t bnum_t;
 
+struct bdev;
+
+/* asynchronous, vectored block requests */
+#define BIO_OP_READ  0
+#define BIO_OP_WRITE 1
+
+/* most iovec segments adjacent requests are merged into */
+#define BIO_MAX_IOV 16
+
+typedef struct bio_request bio_request_t;
+typedef void (*bio_callback_t)(bio_request_t *req, ssize_t result);
+
+struct bio_request {
+	struct list_node node;
+
+	/* filled in by the caller */
+	int op;
+	bnum_t block;
+	const iovec_t *iov; /* every segment a whole number of blocks */
+	uint iov_cnt;
+	bio_callback_t callback;
+	void *cookie;
+
+	/* filled in by bio_submit */
+	struct bdev *dev;
+	uint count;
+	ssize_t result;
+	lk_bigtime_t submit_time;
+};
+
+/* per device io statistics */
+#define BIO_STATS_SIZE_BUCKETS 12 /* log2 of the transfer size, 512 bytes and up */
+#define BIO_STATS_LAT_BUCKETS  20 /* log2 of the latency in usecs */
+
+struct bio_stats {
+	uint64_t ops[2];      /* indexed by BIO_OP_READ/BIO_OP_WRITE */
+	uint64_t bytes[2];
+	uint32_t errors;
+	uint32_t sequential;
+	uint32_t random;
+	lk_bigtime_t busy_time;
+	off_t next_offset;    /* end of the previous transfer */
+	uint32_t size_hist[BIO_STATS_SIZE_BUCKETS];
+	uint32_t lat_hist[BIO_STATS_LAT_BUCKETS];
+};
+
 typedef struct bdev {
 	struct list_node node;
 	volatile int ref;
@@ -49,8 +97,27 @@ typedef struct bdev {
 	ssize_t (*erase)(struct bdev *, off_t offset, size_t len);
 	int (*ioctl)(struct bdev *, int request, void *argp);
 	void (*close)(struct bdev *);
+
+	/* asynchronous request queue. drivers that can overlap requests set
+	 * submit and a queue_depth > 1; submit must not block and the driver
+	 * calls bio_request_complete() when the transfer is done. without a
+	 * submit hook requests are run one at a time on read/write_block. */
+	status_t (*submit)(struct bdev *, bio_request_t *req);
+	uint queue_depth;
+	uint in_flight;
+	struct list_node queue;
+	struct list_node done_queue;
+	dpc_t queue_dpc; /* runs the queue, always available to a completion */
+
+	struct bio_stats stats;
 } bdev_t;
 
+/* ioctls */
+enum bio_ioctl_num {
+	BIO_IOCTL_NULL = 0,
+	BIO_IOCTL_GET_MEM_MAP, /* if supported, return a pointer to the memory backing the device */
+};
+
 /* user api */
 bdev_t *bio_open(const char *name);
 bdev_t *bio_open_by_label(const char *label);
@@ -62,6 +129,15 @@ ssize_t bio_write_block(bdev_t *dev, const void *buf, bnum_t block, uint count);
 ssize_t bio_erase(bdev_t *dev, off_t offset, size_t len);
 int bio_ioctl(bdev_t *dev, int request, void *argp);
 
+/* queue a request, the callback runs on the dpc thread once it completes */
+status_t bio_submit(bdev_t *dev, bio_request_t *req);
+/* blocking vectored transfers built on bio_submit, not callable from a dpc */
+ssize_t bio_read_block_iovec(bdev_t *dev, const iovec_t *iov, uint iov_cnt, bnum_t block);
+ssize_t bio_write_block_iovec(bdev_t *dev, const iovec_t *iov, uint iov_cnt, bnum_t block);
+
+/* called by drivers with a submit hook, safe from interrupt context */
+void bio_request_complete(bio_request_t *req, ssize_t result);
+
 /* register a block device */
 void bio_register_device(bdev_t *dev);
 void bio_unregister_device(bdev_t *dev);
@@ -72,6 +148,14 @@ void bio_initialize_bdev(bdev_t *dev, const char *name, size_t block_size, bnum_
 /* debug stuff */
 void bio_dump_devices(void);
 
+/* io statistics */
+void bio_stats_record(bdev_t *dev, int op, off_t offset, ssize_t result, lk_bigtime_t start);
+void bio_stats_reset(bdev_t *dev);
+/* format line 'line' of a device's statistics, short enough for a fastboot
+ * INFO response. returns 0, or < 0 once past the last line. */
+int bio_stats_format(const bdev_t *dev, uint line, char *buf, size_t len);
+void bio_stats_dump(const bdev_t *dev);
+
 /* iterate over all registered devices */
 void bio_foreach(void (*cb)(const char*), bool subdevs);
 
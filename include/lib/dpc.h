@@ -28,9 +28,42 @@
 
 typedef void (*dpc_callback)(void *arg);
 
+/* a work item. dpc_queue() takes them from its own pool, callers that must
+ * never fail to queue embed one and use dpc_queue_item(). */
+typedef struct dpc {
+	struct list_node node;
+
+	dpc_callback cb;
+	void *arg;
+} dpc_t;
+
 #define DPC_FLAG_NORESCHED 0x1
+/* skip queueing if the same callback and arg are already pending */
+#define DPC_FLAG_COALESCE  0x2
+/* run ahead of / behind normal priority work */
+#define DPC_FLAG_PRIO_HIGH 0x4
+#define DPC_FLAG_PRIO_LOW  0x8
 
+/* Work items come from a fixed pool, so dpc_queue() never touches the heap
+ * and may be called from interrupt context (with DPC_FLAG_NORESCHED).
+ * Work queued before the workers are started runs once they are.
+ * Returns ERR_NO_MEMORY if the pool is exhausted.
+ */
 status_t dpc_queue(dpc_callback, void *arg, uint flags);
 
+/* Queue a caller owned item, initialized with dpc_init_item(). Does nothing
+ * if the item is already pending, so it cannot fail and is safe from
+ * interrupt context (with DPC_FLAG_NORESCHED). The item can be queued again
+ * as soon as its callback has started.
+ */
+void dpc_queue_item(dpc_t *dpc, dpc_callback, void *arg, uint flags);
+
+static inline void dpc_init_item(dpc_t *dpc)
+{
+	list_clear_node(&dpc->node);
+	dpc->cb = NULL;
+	dpc->arg = NULL;
+}
+
 #endif
 
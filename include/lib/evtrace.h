@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2015, The Linux Foundation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of The Linux Foundation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __LIB_EVTRACE_H
+#define __LIB_EVTRACE_H
+
+#include <inttypes.h>
+#include <sys/types.h>
+
+/*
+ * Binary event trace. Every record is four words, like the kernel evlog:
+ * timestamp (usecs, current_time_hires), event id, arg0, arg1.
+ * Each category records into its own fixed size ring so a chatty source
+ * (usb, thread switches) can't push out the rare ones (boot milestones).
+ */
+enum evtrace_cat {
+	EVTRACE_CAT_KERNEL = 0,
+	EVTRACE_CAT_STORAGE,
+	EVTRACE_CAT_USB,
+	EVTRACE_CAT_BOOT,
+	EVTRACE_CAT_MAX,
+};
+
+/* event ids, unique across all categories */
+enum evtrace_id {
+	EVTRACE_ID_THREAD_SWITCH = 1,	/* from thread, to thread */
+	EVTRACE_ID_STORAGE_READ,	/* byte offset / 512, length in bytes */
+	EVTRACE_ID_STORAGE_READ_DONE,	/* return code, length in bytes */
+	EVTRACE_ID_STORAGE_WRITE,	/* byte offset / 512, length in bytes */
+	EVTRACE_ID_STORAGE_WRITE_DONE,	/* return code, length in bytes */
+	EVTRACE_ID_SDHCI_CMD,		/* command index, argument */
+	EVTRACE_ID_UFS_SCSI_CMD,	/* cdb opcode, lun */
+	EVTRACE_ID_USB_QUEUE,		/* request, length */
+	EVTRACE_ID_USB_COMPLETE,	/* request, actual length or negative status */
+	EVTRACE_ID_BOOT_STAMP,		/* boot_stats id, sclk count */
+};
+
+/* records per category */
+#ifndef EVTRACE_RING_SHIFT
+#define EVTRACE_RING_SHIFT 8
+#endif
+
+/*
+ * Layout produced by evtrace_export(), all fields native endian:
+ * struct evtrace_export_hdr, then num_cats struct evtrace_export_cat,
+ * then for every category in that order its records, oldest first.
+ */
+#define EVTRACE_EXPORT_MAGIC   0x43525445 /* "ETRC" */
+#define EVTRACE_EXPORT_VERSION 1
+
+struct evtrace_export_hdr {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t word_size;	/* size of one record word in bytes */
+	uint32_t num_cats;
+	uint32_t ticks_per_sec;	/* timestamp resolution */
+};
+
+struct evtrace_export_cat {
+	uint32_t cat;
+	uint32_t count;		/* records that follow */
+};
+
+#if WITH_LIB_EVTRACE
+
+void evtrace_add(uint cat, uint id, uintptr_t arg0, uintptr_t arg1);
+void evtrace_clear(void);
+
+/* worst case size of an export */
+size_t evtrace_export_size(void);
+/* snapshot every ring into buf, returns the number of bytes used */
+size_t evtrace_export(void *buf, size_t len);
+
+#else
+
+static inline void evtrace_add(uint cat, uint id, uintptr_t arg0, uintptr_t arg1) {}
+static inline void evtrace_clear(void) {}
+static inline size_t evtrace_export_size(void) { return 0; }
+static inline size_t evtrace_export(void *buf, size_t len) { return 0; }
+
+#endif
+
+#define EVTRACE_THREAD_SWITCH(from, to) \
+	evtrace_add(EVTRACE_CAT_KERNEL, EVTRACE_ID_THREAD_SWITCH, (uintptr_t)(from), (uintptr_t)(to))
+#define EVTRACE_STORAGE_READ(offset, len) \
+	evtrace_add(EVTRACE_CAT_STORAGE, EVTRACE_ID_STORAGE_READ, (uintptr_t)((offset) >> 9), (uintptr_t)(len))
+#define EVTRACE_STORAGE_READ_DONE(ret, len) \
+	evtrace_add(EVTRACE_CAT_STORAGE, EVTRACE_ID_STORAGE_READ_DONE, (uintptr_t)(ret), (uintptr_t)(len))
+#define EVTRACE_STORAGE_WRITE(offset, len) \
+	evtrace_add(EVTRACE_CAT_STORAGE, EVTRACE_ID_STORAGE_WRITE, (uintptr_t)((offset) >> 9), (uintptr_t)(len))
+#define EVTRACE_STORAGE_WRITE_DONE(ret, len) \
+	evtrace_add(EVTRACE_CAT_STORAGE, EVTRACE_ID_STORAGE_WRITE_DONE, (uintptr_t)(ret), (uintptr_t)(len))
+#define EVTRACE_SDHCI_CMD(index, arg) \
+	evtrace_add(EVTRACE_CAT_STORAGE, EVTRACE_ID_SDHCI_CMD, (uintptr_t)(index), (uintptr_t)(arg))
+#define EVTRACE_UFS_SCSI_CMD(opcode, lun) \
+	evtrace_add(EVTRACE_CAT_STORAGE, EVTRACE_ID_UFS_SCSI_CMD, (uintptr_t)(opcode), (uintptr_t)(lun))
+#define EVTRACE_USB_QUEUE(req, len) \
+	evtrace_add(EVTRACE_CAT_USB, EVTRACE_ID_USB_QUEUE, (uintptr_t)(req), (uintptr_t)(len))
+#define EVTRACE_USB_COMPLETE(req, actual, status) \
+	evtrace_add(EVTRACE_CAT_USB, EVTRACE_ID_USB_COMPLETE, (uintptr_t)(req), \
+		    (status) < 0 ? (uintptr_t)(status) : (uintptr_t)(actual))
+#define EVTRACE_BOOT_STAMP(bs_id, sclk) \
+	evtrace_add(EVTRACE_CAT_BOOT, EVTRACE_ID_BOOT_STAMP, (uintptr_t)(bs_id), (uintptr_t)(sclk))
+
+#endif
@@ -35,6 +35,7 @@ typedef void *filecookie;
 typedef void *fscookie;
 
 int fs_mount(const char *path, const char *device);
+int fs_mount_type(const char *path, const char *device, const char *name);
 int fs_unmount(const char *path);
 
 /* file api */
@@ -106,5 +106,14 @@ void gfx_surface_destroy(struct gfx_surface *surface);
 // utility routine to fill the display with a little moire pattern
 void gfx_draw_pattern(void);
 
+// pixel span kernels, accelerated with NEON or SSE2 where available
+void gfx_fill16(uint16_t *dst, uint16_t color, size_t count);
+void gfx_fill32(uint32_t *dst, uint32_t color, size_t count);
+void gfx_copy_pixels(void *dst, const void *src, size_t len);
+void gfx_blend32(uint32_t *dst, const uint32_t *src, size_t count);
+void gfx_swizzle_rgb888(uint8_t *dst, const uint8_t *src, size_t count);
+void gfx_convert_8888_to_565(uint16_t *dst, const uint32_t *src, size_t count);
+uint32_t alpha32_add_ignore_destalpha(uint32_t dest, uint32_t src);
+
 #endif
 
@@ -43,6 +43,7 @@ struct tar_io {
 	void		*priv;		/* driver private struct pointer */
 };
 
+uint64_t tar_header_size(const struct posix_header *hd);
 int tar_get_fileinfo(struct tar_io *tio, const char *path, struct tar_fileinfo *fi);
 int tar_read_file(struct tar_io *tio, struct tar_fileinfo *fi, void* buf);
 
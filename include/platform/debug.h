@@ -35,6 +35,15 @@ void platform_halt(void);
 void platform_dputc(char c);
 int platform_dgetc(char *c, bool wait);
 
+/* write a run of characters, platforms may buffer them */
+void platform_dputs(const char *str, size_t len);
+
+/* called before a panic prints anything, output has to be synchronous from here on */
+void platform_panic_start(void);
+
+/* write out buffered output before leaving lk, synchronous afterwards */
+void dlog_flush(void);
+
 __END_CDECLS
 
 #endif
@@ -71,8 +71,19 @@ static int cmd_threads(int argc, const cmd_args *argv)
 #endif
 
 #if THREAD_STATS
+/* events per second since boot, uptime in ms */
+static uint threadstats_rate(int count, lk_time_t uptime)
+{
+	if (!uptime)
+		return 0;
+
+	return (uint)(((uint64_t)count * 1000) / uptime);
+}
+
 static int cmd_threadstats(int argc, const cmd_args *argv)
 {
+	lk_time_t uptime = current_time();
+
 	printf("thread stats:\n");
 	printf("\ttotal idle time: %lld\n", thread_stats.idle_time);
 	printf("\ttotal busy time: %lld\n", current_time_hires() - thread_stats.idle_time);
@@ -80,9 +91,14 @@ static int cmd_threadstats(int argc, const cmd_args *argv)
 	printf("\tcontext_switches: %d\n", thread_stats.context_switches);
 	printf("\tpreempts: %d\n", thread_stats.preempts);
 	printf("\tyields: %d\n", thread_stats.yields);
-	printf("\tinterrupts: %d\n", thread_stats.interrupts);
-	printf("\ttimer interrupts: %d\n", thread_stats.timer_ints);
-	printf("\ttimers: %d\n", thread_stats.timers);
+	printf("\tinterrupts: %d (%u/s)\n", thread_stats.interrupts,
+	       threadstats_rate(thread_stats.interrupts, uptime));
+	printf("\ttimer interrupts: %d (%u/s)\n", thread_stats.timer_ints,
+	       threadstats_rate(thread_stats.timer_ints, uptime));
+	printf("\ttimers: %d (%u/s), %d sharing an interrupt\n", thread_stats.timers,
+	       threadstats_rate(thread_stats.timers, uptime), thread_stats.timers_coalesced);
+	printf("\ttimer sets: %d, cancels: %d\n", thread_stats.timer_sets, thread_stats.timer_cancels);
+	printf("\ttimers queued: %d, max %d\n", thread_stats.timers_queued, thread_stats.timers_queued_max);
 
 	return 0;
 }
@@ -102,11 +118,14 @@ static enum handler_return threadload(struct timer *t, lk_time_t now, void *arg)
 	uint busypercent = (busy_time * 10000) / (1000000);
 
 //	printf("idle_time %lld, busytime %lld\n", idle_time - last_idle_time, busy_time);
-	printf("LOAD: %d.%02d%%, cs %d, ints %d, timer ints %d, timers %d\n", busypercent / 100, busypercent % 100,
+	printf("LOAD: %d.%02d%%, cs %d, ints %d, timer ints %d, timers %d, timer sets %d, queued %d\n",
+	       busypercent / 100, busypercent % 100,
 	       thread_stats.context_switches - old_stats.context_switches,
 	       thread_stats.interrupts - old_stats.interrupts,
 	       thread_stats.timer_ints - old_stats.timer_ints,
-	       thread_stats.timers - old_stats.timers);
+	       thread_stats.timers - old_stats.timers,
+	       thread_stats.timer_sets - old_stats.timer_sets,
+	       thread_stats.timers_queued);
 
 	old_stats = thread_stats;
 	last_idle_time = idle_time;
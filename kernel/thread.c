@@ -45,6 +45,7 @@
 #include <platform.h>
 #include <target.h>
 #include <lib/heap.h>
+#include <lib/evtrace.h>
 
 #if LK_DEBUGLEVEL > 1
 #define THREAD_CHECKS 1
@@ -446,6 +447,7 @@ void thread_resched(void)
 #endif
 
 	KEVLOG_THREAD_SWITCH(oldthread, newthread);
+	EVTRACE_THREAD_SWITCH(oldthread, newthread);
 
 #if THREAD_CHECKS
 	ASSERT(critical_section_count > 0);
@@ -48,7 +48,13 @@
 
 #define LOCAL_TRACE 0
 
-static struct list_node timer_queue;
+/*
+ * Pending timers live in a pairing heap ordered on their deadline:
+ * insertion is O(1) and taking the head or cancelling an arbitrary timer
+ * is O(log n) amortized, where the sorted list this replaces walked the
+ * whole queue on every timer_set.
+ */
+static timer_t *timer_queue;
 
 static enum handler_return timer_tick(void *arg, lk_time_t now);
 
@@ -60,21 +66,124 @@ void timer_initialize(timer_t *timer)
 	*timer = (timer_t)TIMER_INITIAL_VALUE(*timer);
 }
 
+static bool timer_queued(timer_t *timer)
+{
+	return timer == timer_queue || timer->heap_prev != NULL;
+}
+
+/* link two detached heaps, the later root becomes the first child of the
+ * earlier one; on a tie the first argument stays on top */
+static timer_t *heap_meld(timer_t *a, timer_t *b)
+{
+	if (!a)
+		return b;
+	if (!b)
+		return a;
+
+	if (TIME_LT(b->deadline, a->deadline)) {
+		timer_t *t = a;
+		a = b;
+		b = t;
+	}
+
+	b->heap_prev = a;
+	b->heap_next = a->heap_child;
+	if (a->heap_child)
+		a->heap_child->heap_prev = b;
+	a->heap_child = b;
+
+	return a;
+}
+
+/* standard two pass merge of a sibling list into one detached heap */
+static timer_t *heap_merge_pairs(timer_t *first)
+{
+	timer_t *pairs = NULL;
+	timer_t *root = NULL;
+
+	/* left to right, meld neighbours and stack up the results */
+	while (first) {
+		timer_t *a = first;
+		timer_t *b = a->heap_next;
+
+		first = b ? b->heap_next : NULL;
+		a->heap_next = a->heap_prev = NULL;
+		if (b)
+			b->heap_next = b->heap_prev = NULL;
+
+		a = heap_meld(a, b);
+		a->heap_next = pairs;
+		pairs = a;
+	}
+
+	/* then right to left into a single heap */
+	while (pairs) {
+		timer_t *next = pairs->heap_next;
+
+		pairs->heap_next = NULL;
+		root = heap_meld(root, pairs);
+		pairs = next;
+	}
+
+	return root;
+}
+
 static void insert_timer_in_queue(timer_t *timer)
 {
-	timer_t *entry;
+	LTRACEF("timer %p, scheduled %lu, deadline %lu, periodic %lu\n", timer,
+	        timer->scheduled_time, timer->deadline, timer->periodic_time);
 
-	LTRACEF("timer %p, scheduled %lu, periodic %lu\n", timer, timer->scheduled_time, timer->periodic_time);
+	timer->heap_child = timer->heap_next = timer->heap_prev = NULL;
+	timer_queue = heap_meld(timer_queue, timer);
 
-	list_for_every_entry(&timer_queue, entry, timer_t, node) {
-		if (TIME_GT(entry->scheduled_time, timer->scheduled_time)) {
-			list_add_before(&entry->node, &timer->node);
-			return;
-		}
+#if THREAD_STATS
+	if (++thread_stats.timers_queued > thread_stats.timers_queued_max)
+		thread_stats.timers_queued_max = thread_stats.timers_queued;
+#endif
+}
+
+static void remove_timer_from_queue(timer_t *timer)
+{
+	timer_t *rest = heap_merge_pairs(timer->heap_child);
+
+	if (timer == timer_queue) {
+		timer_queue = rest;
+	} else {
+		/* unhook it from its parent or its previous sibling */
+		if (timer->heap_prev->heap_child == timer)
+			timer->heap_prev->heap_child = timer->heap_next;
+		else
+			timer->heap_prev->heap_next = timer->heap_next;
+		if (timer->heap_next)
+			timer->heap_next->heap_prev = timer->heap_prev;
+
+		timer_queue = heap_meld(timer_queue, rest);
 	}
 
-	/* walked off the end of the list */
-	list_add_tail(&timer_queue, &timer->node);
+	timer->heap_child = timer->heap_next = timer->heap_prev = NULL;
+
+#if THREAD_STATS
+	thread_stats.timers_queued--;
+#endif
+}
+
+/* how late a timer may run so that it can share an interrupt with others */
+static lk_time_t timer_slack(lk_time_t delay)
+{
+#if PLATFORM_HAS_DYNAMIC_TIMER
+	lk_time_t slack = delay / 16;
+
+	return slack < TIMER_SLACK_MAX ? slack : TIMER_SLACK_MAX;
+#else
+	/* the periodic tick batches them anyway */
+	return 0;
+#endif
+}
+
+static void timer_schedule(timer_t *timer, lk_time_t now, lk_time_t delay)
+{
+	timer->scheduled_time = now + delay;
+	timer->deadline = timer->scheduled_time + timer_slack(delay);
 }
 
 static void timer_set(timer_t *timer, lk_time_t delay, lk_time_t period, timer_callback callback, void *arg)
@@ -85,12 +194,12 @@ static void timer_set(timer_t *timer, lk_time_t delay, lk_time_t period, timer_c
 
 	DEBUG_ASSERT(timer->magic == TIMER_MAGIC);
 
-	if (list_in_list(&timer->node)) {
+	if (timer_queued(timer)) {
 		panic("timer %p already in list\n", timer);
 	}
 
 	now = current_time();
-	timer->scheduled_time = now + delay;
+	timer_schedule(timer, now, delay);
 	timer->periodic_time = period;
 	timer->callback = callback;
 	timer->arg = arg;
@@ -99,11 +208,13 @@ static void timer_set(timer_t *timer, lk_time_t delay, lk_time_t period, timer_c
 
 	enter_critical_section();
 
+	THREAD_STATS_INC(timer_sets);
 	insert_timer_in_queue(timer);
 
 #if PLATFORM_HAS_DYNAMIC_TIMER
-	if (list_peek_head_type(&timer_queue, timer_t, node) == timer) {
+	if (timer_queue == timer) {
 		/* we just modified the head of the timer queue */
+		delay = timer->deadline - now;
 		LTRACEF("setting new timer for %u msecs\n", (uint)delay);
 		platform_set_oneshot_timer(timer_tick, NULL, delay);
 	}
@@ -164,11 +275,13 @@ void timer_cancel(timer_t *timer)
 	enter_critical_section();
 
 #if PLATFORM_HAS_DYNAMIC_TIMER
-	timer_t *oldhead = list_peek_head_type(&timer_queue, timer_t, node);
+	timer_t *oldhead = timer_queue;
 #endif
 
-	if (list_in_list(&timer->node))
-		list_delete(&timer->node);
+	if (timer_queued(timer)) {
+		THREAD_STATS_INC(timer_cancels);
+		remove_timer_from_queue(timer);
+	}
 
 	/* to keep it from being reinserted into the queue if called from
 	 * periodic timer callback.
@@ -179,7 +292,7 @@ void timer_cancel(timer_t *timer)
 
 #if PLATFORM_HAS_DYNAMIC_TIMER
 	/* see if we've just modified the head of the timer queue */
-	timer_t *newhead = list_peek_head_type(&timer_queue, timer_t, node);
+	timer_t *newhead = timer_queue;
 	if (newhead == NULL) {
 		LTRACEF("clearing old hw timer, nothing in the queue\n");
 		platform_stop_timer();
@@ -187,10 +300,10 @@ void timer_cancel(timer_t *timer)
 		lk_time_t delay;
 		lk_time_t now = current_time();
 
-		if (TIME_LT(newhead->scheduled_time, now))
+		if (TIME_LT(newhead->deadline, now))
 			delay = 0;
 		else
-			delay = newhead->scheduled_time - now;
+			delay = newhead->deadline - now;
 
 		LTRACEF("setting new timer to %u\n", (uint) delay);
 		platform_set_oneshot_timer(timer_tick, NULL, delay);
@@ -205,6 +318,7 @@ static enum handler_return timer_tick(void *arg, lk_time_t now)
 {
 	timer_t *timer;
 	enum handler_return ret = INT_NO_RESCHEDULE;
+	bool fired = false;
 
 	THREAD_STATS_INC(timer_ints);
 //	KEVLOG_TIMER_TICK(); // enable only if necessary
@@ -212,8 +326,10 @@ static enum handler_return timer_tick(void *arg, lk_time_t now)
 	LTRACEF("now %lu, sp %p\n", now, __GET_FRAME());
 
 	for (;;) {
-		/* see if there's an event to process */
-		timer = list_peek_head_type(&timer_queue, timer_t, node);
+		/* see if there's an event to process. the head has the earliest
+		 * deadline; anything it lets through whose window has opened
+		 * runs in this same interrupt */
+		timer = timer_queue;
 		if (likely(timer == 0))
 			break;
 		LTRACEF("next item on timer queue %p at %lu now %lu (%p, arg %p)\n", timer, timer->scheduled_time, now, timer->callback, timer->arg);
@@ -223,11 +339,14 @@ static enum handler_return timer_tick(void *arg, lk_time_t now)
 		/* process it */
 		LTRACEF("timer %p\n", timer);
 		DEBUG_ASSERT(timer && timer->magic == TIMER_MAGIC);
-		list_delete(&timer->node);
+		remove_timer_from_queue(timer);
 
 		LTRACEF("dequeued timer %p, scheduled %lu periodic %lu\n", timer, timer->scheduled_time, timer->periodic_time);
 
 		THREAD_STATS_INC(timers);
+		if (fired)
+			THREAD_STATS_INC(timers_coalesced);
+		fired = true;
 
 		bool periodic = timer->periodic_time > 0;
 
@@ -239,21 +358,21 @@ static enum handler_return timer_tick(void *arg, lk_time_t now)
 		/* if it was a periodic timer and it hasn't been requeued
 		 * by the callback put it back in the list
 		 */
-		if (periodic && !list_in_list(&timer->node) && timer->periodic_time > 0) {
+		if (periodic && !timer_queued(timer) && timer->periodic_time > 0) {
 			LTRACEF("periodic timer, period %u\n", (uint)timer->periodic_time);
-			timer->scheduled_time = now + timer->periodic_time;
+			timer_schedule(timer, now, timer->periodic_time);
 			insert_timer_in_queue(timer);
 		}
 	}
 
 #if PLATFORM_HAS_DYNAMIC_TIMER
 	/* reset the timer to the next event */
-	timer = list_peek_head_type(&timer_queue, timer_t, node);
+	timer = timer_queue;
 	if (timer) {
 		/* has to be the case or it would have fired already */
-		DEBUG_ASSERT(TIME_GT(timer->scheduled_time, now));
+		DEBUG_ASSERT(TIME_GT(timer->deadline, now));
 
-		lk_time_t delay = timer->scheduled_time - now;
+		lk_time_t delay = timer->deadline - now;
 
 		LTRACEF("setting new timer for %u msecs for event %p\n", (uint)delay, timer);
 		platform_set_oneshot_timer(timer_tick, NULL, delay);
@@ -271,7 +390,7 @@ static enum handler_return timer_tick(void *arg, lk_time_t now)
 
 void timer_init(void)
 {
-	list_initialize(&timer_queue);
+	timer_queue = NULL;
 
 #if !PLATFORM_HAS_DYNAMIC_TIMER
 	/* register for a periodic timer tick */
@@ -31,6 +31,7 @@
 #include <lib/bio.h>
 #include <kernel/mutex.h>
 #include <lk/init.h>
+#include <platform.h>
 
 #define LOCAL_TRACE 0
 
@@ -57,7 +58,7 @@ static ssize_t bio_default_read(struct bdev *dev, void *_buf, off_t offset, size
 	/* handle partial first block */
 	if ((offset % dev->block_size) != 0) {
 		/* read in the block */
-		err = bio_read_block(dev, temp, block, 1);
+		err = dev->read_block(dev, temp, block, 1);
 		if (err < 0)
 			goto err;
 
@@ -78,7 +79,7 @@ static ssize_t bio_default_read(struct bdev *dev, void *_buf, off_t offset, size
 	if (len >= dev->block_size) {
 		/* do the middle reads */
 		size_t block_count = len / dev->block_size;
-		err = bio_read_block(dev, buf, block, block_count);
+		err = dev->read_block(dev, buf, block, block_count);
 		if (err < 0)
 			goto err;
 
@@ -96,7 +97,7 @@ static ssize_t bio_default_read(struct bdev *dev, void *_buf, off_t offset, size
 	/* handle partial last block */
 	if (len > 0) {
 		/* read the block */
-		err = bio_read_block(dev, temp, block, 1);
+		err = dev->read_block(dev, temp, block, 1);
 		if (err < 0)
 			goto err;
 
@@ -126,7 +127,7 @@ static ssize_t bio_default_write(struct bdev *dev, const void *_buf, off_t offse
 	/* handle partial first block */
 	if ((offset % dev->block_size) != 0) {
 		/* read in the block */
-		err = bio_read_block(dev, temp, block, 1);
+		err = dev->read_block(dev, temp, block, 1);
 		if (err < 0)
 			goto err;
 
@@ -136,7 +137,7 @@ static ssize_t bio_default_write(struct bdev *dev, const void *_buf, off_t offse
 		memcpy(temp + block_offset, buf, tocopy);
 
 		/* write it back out */
-		err = bio_write_block(dev, temp, block, 1);
+		err = dev->write_block(dev, temp, block, 1);
 		if (err < 0)
 			goto err;
 
@@ -152,7 +153,7 @@ static ssize_t bio_default_write(struct bdev *dev, const void *_buf, off_t offse
 	if (len >= dev->block_size) {
 		/* do the middle writes */
 		size_t block_count = len / dev->block_size;
-		err = bio_write_block(dev, buf, block, block_count);
+		err = dev->write_block(dev, buf, block, block_count);
 		if (err < 0)
 			goto err;
 
@@ -170,7 +171,7 @@ static ssize_t bio_default_write(struct bdev *dev, const void *_buf, off_t offse
 	/* handle partial last block */
 	if (len > 0) {
 		/* read the block */
-		err = bio_read_block(dev, temp, block, 1);
+		err = dev->read_block(dev, temp, block, 1);
 		if (err < 0)
 			goto err;
 
@@ -178,7 +179,7 @@ static ssize_t bio_default_write(struct bdev *dev, const void *_buf, off_t offse
 		memcpy(temp, buf, len);
 
 		/* write it back out */
-		err = bio_write_block(dev, temp, block, 1);
+		err = dev->write_block(dev, temp, block, 1);
 		if (err < 0)
 			goto err;
 
@@ -335,7 +336,11 @@ ssize_t bio_read(bdev_t *dev, void *buf, off_t offset, size_t len)
 	if (len == 0)
 		return 0;
 
-	return dev->read(dev, buf, offset, len);
+	lk_bigtime_t start = current_time_hires();
+	ssize_t ret = dev->read(dev, buf, offset, len);
+	bio_stats_record(dev, BIO_OP_READ, offset, ret, start);
+
+	return ret;
 }
 
 ssize_t bio_read_block(bdev_t *dev, void *buf, bnum_t block, uint count)
@@ -349,7 +354,11 @@ ssize_t bio_read_block(bdev_t *dev, void *buf, bnum_t block, uint count)
 	if (count == 0)
 		return 0;
 
-	return dev->read_block(dev, buf, block, count);
+	lk_bigtime_t start = current_time_hires();
+	ssize_t ret = dev->read_block(dev, buf, block, count);
+	bio_stats_record(dev, BIO_OP_READ, (off_t)block << dev->block_shift, ret, start);
+
+	return ret;
 }
 
 ssize_t bio_write(bdev_t *dev, const void *buf, off_t offset, size_t len)
@@ -363,7 +372,11 @@ ssize_t bio_write(bdev_t *dev, const void *buf, off_t offset, size_t len)
 	if (len == 0)
 		return 0;
 
-	return dev->write(dev, buf, offset, len);
+	lk_bigtime_t start = current_time_hires();
+	ssize_t ret = dev->write(dev, buf, offset, len);
+	bio_stats_record(dev, BIO_OP_WRITE, offset, ret, start);
+
+	return ret;
 }
 
 ssize_t bio_write_block(bdev_t *dev, const void *buf, bnum_t block, uint count)
@@ -377,7 +390,11 @@ ssize_t bio_write_block(bdev_t *dev, const void *buf, bnum_t block, uint count)
 	if (count == 0)
 		return 0;
 
-	return dev->write_block(dev, buf, block, count);
+	lk_bigtime_t start = current_time_hires();
+	ssize_t ret = dev->write_block(dev, buf, block, count);
+	bio_stats_record(dev, BIO_OP_WRITE, (off_t)block << dev->block_shift, ret, start);
+
+	return ret;
 }
 
 ssize_t bio_erase(bdev_t *dev, off_t offset, size_t len)
@@ -428,6 +445,16 @@ void bio_initialize_bdev(bdev_t *dev, const char *name, size_t block_size, bnum_
 	dev->write_block = bio_default_write_block;
 	dev->erase = bio_default_erase;
 	dev->close = NULL;
+
+	/* synchronous drivers get the request queue emulated on top of read/write_block */
+	dev->submit = NULL;
+	dev->queue_depth = 1;
+	dev->in_flight = 0;
+	list_initialize(&dev->queue);
+	list_initialize(&dev->done_queue);
+	dpc_init_item(&dev->queue_dpc);
+
+	memset(&dev->stats, 0, sizeof(dev->stats));
 }
 
 void bio_register_device(bdev_t *dev)
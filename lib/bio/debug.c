@@ -42,6 +42,16 @@ STATIC_COMMAND_START
 STATIC_COMMAND("bio", "block io debug commands", &cmd_bio)
 STATIC_COMMAND_END(bio);
 
+static void bio_dump_stats_cb(const char *name)
+{
+	bdev_t *dev = bio_open(name);
+
+	if (dev) {
+		bio_stats_dump(dev);
+		bio_close(dev);
+	}
+}
+
 static int cmd_bio(int argc, const cmd_args *argv)
 {
 	int rc = 0;
@@ -51,6 +61,7 @@ notenoughargs:
 		printf("not enough arguments:\n");
 usage:
 		printf("%s list\n", argv[0].str);
+		printf("%s stats [device] [reset]\n", argv[0].str);
 		printf("%s read <device> <address> <offset> <len>\n", argv[0].str);
 		printf("%s write <device> <address> <offset> <len>\n", argv[0].str);
 		printf("%s erase <device> <offset> <len>\n", argv[0].str);
@@ -67,6 +78,24 @@ usage:
 
 	if (!strcmp(argv[1].str, "list")) {
 		bio_dump_devices();
+	} else if (!strcmp(argv[1].str, "stats")) {
+		if (argc < 3) {
+			bio_foreach(&bio_dump_stats_cb, false);
+			return 0;
+		}
+
+		bdev_t *dev = bio_open(argv[2].str);
+		if (!dev) {
+			printf("error opening block device\n");
+			return -1;
+		}
+
+		if (argc > 3 && !strcmp(argv[3].str, "reset"))
+			bio_stats_reset(dev);
+		else
+			bio_stats_dump(dev);
+
+		bio_close(dev);
 	} else if (!strcmp(argv[1].str, "read")) {
 		if (argc < 6) goto notenoughargs;
 
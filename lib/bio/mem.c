@@ -22,6 +22,7 @@
  */
 #include <debug.h>
 #include <trace.h>
+#include <err.h>
 #include <string.h>
 #include <stdlib.h>
 #include <lib/bio.h>
@@ -80,6 +81,22 @@ static ssize_t mem_bdev_write_block(struct bdev *bdev, const void *buf, bnum_t b
 	return count * BLOCKSIZE;
 }
 
+static int mem_bdev_ioctl(struct bdev *bdev, int request, void *argp)
+{
+	mem_bdev_t *mem = (mem_bdev_t *)bdev;
+
+	LTRACEF("bdev %s, request %d, argp %p\n", bdev->name, request, argp);
+
+	switch (request) {
+		case BIO_IOCTL_GET_MEM_MAP:
+			if (argp)
+				*(void **)argp = mem->ptr;
+			return NO_ERROR;
+		default:
+			return ERR_NOT_SUPPORTED;
+	}
+}
+
 int create_membdev(const char *name, void *ptr, size_t len)
 {
 	mem_bdev_t *mem = malloc(sizeof(mem_bdev_t));
@@ -93,6 +110,7 @@ int create_membdev(const char *name, void *ptr, size_t len)
 	mem->dev.read_block = mem_bdev_read_block;
 	mem->dev.write = mem_bdev_write;
 	mem->dev.write_block = mem_bdev_write_block;
+	mem->dev.ioctl = mem_bdev_ioctl;
 
 	/* register it */
 	bio_register_device(&mem->dev);
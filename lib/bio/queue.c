@@ -0,0 +1,334 @@
+/*
+ * Copyright (c) 2015 Travis Geiselbrecht
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <stdlib.h>
+#include <debug.h>
+#include <trace.h>
+#include <err.h>
+#include <string.h>
+#include <assert.h>
+#include <list.h>
+#include <lib/bio.h>
+#include <lib/dpc.h>
+#include <kernel/thread.h>
+#include <kernel/event.h>
+#include <platform.h>
+
+#define LOCAL_TRACE 0
+
+/* a run of adjacent requests dispatched to the driver as one */
+struct bio_merge {
+	bio_request_t req;
+	iovec_t iov[BIO_MAX_IOV];
+	struct list_node members;
+};
+
+static void bio_queue_run(void *arg);
+
+/* account a caller's request and hand it back */
+static void bio_request_finish(bio_request_t *req, ssize_t result)
+{
+	bio_stats_record(req->dev, req->op, (off_t)req->block << req->dev->block_shift, result, req->submit_time);
+	req->callback(req, result);
+}
+
+/* the queue only ever runs on the dpc thread, through the device's own
+ * work item so neither a submit nor a completion can fail to schedule it */
+static void bio_queue_kick(bdev_t *dev)
+{
+	dpc_queue_item(&dev->queue_dpc, &bio_queue_run, dev, DPC_FLAG_NORESCHED);
+}
+
+status_t bio_submit(bdev_t *dev, bio_request_t *req)
+{
+	ssize_t len;
+
+	DEBUG_ASSERT(dev->ref > 0);
+	DEBUG_ASSERT(req->callback);
+
+	len = iovec_size(req->iov, req->iov_cnt);
+	if (len <= 0 || (len % dev->block_size) != 0)
+		return ERR_INVALID_ARGS;
+	if (req->op != BIO_OP_READ && req->op != BIO_OP_WRITE)
+		return ERR_INVALID_ARGS;
+
+	req->dev = dev;
+	req->count = len >> dev->block_shift;
+	req->result = 0;
+	req->submit_time = current_time_hires();
+
+	if (bio_trim_block_range(dev, req->block, req->count) != req->count)
+		return ERR_OUT_OF_RANGE;
+
+	LTRACEF("dev '%s', op %d, block %u, count %u, iov_cnt %u\n",
+	        dev->name, req->op, req->block, req->count, req->iov_cnt);
+
+	enter_critical_section();
+	list_add_tail(&dev->queue, &req->node);
+	exit_critical_section();
+
+	bio_queue_kick(dev);
+
+	return NO_ERROR;
+}
+
+void bio_request_complete(bio_request_t *req, ssize_t result)
+{
+	bdev_t *dev = req->dev;
+
+	req->result = result;
+
+	enter_critical_section();
+	list_add_tail(&dev->done_queue, &req->node);
+	exit_critical_section();
+
+	/* callbacks run on the dpc thread rather than in the driver's irq */
+	bio_queue_kick(dev);
+}
+
+/* pull requests contiguous with head off the front of the queue, in a critical section */
+static void bio_collect_merge(bdev_t *dev, bio_request_t *head, struct list_node *members)
+{
+	bio_request_t *next;
+	bnum_t end = head->block + head->count;
+	uint iov_cnt = head->iov_cnt;
+
+	while ((next = list_peek_head_type(&dev->queue, bio_request_t, node))) {
+		if (next->op != head->op || next->block != end)
+			break;
+		if (iov_cnt + next->iov_cnt > BIO_MAX_IOV)
+			break;
+
+		list_delete(&next->node);
+		list_add_tail(members, &next->node);
+		end += next->count;
+		iov_cnt += next->iov_cnt;
+	}
+}
+
+/* fan the result of a merged transfer back out to its members, in order */
+static void bio_merge_callback(bio_request_t *req, ssize_t result)
+{
+	struct bio_merge *merge = req->cookie;
+	bio_request_t *member;
+
+	while ((member = list_remove_head_type(&merge->members, bio_request_t, node))) {
+		ssize_t len = (ssize_t)member->count << member->dev->block_shift;
+		ssize_t member_result;
+
+		if (result < 0) {
+			member_result = result;
+		} else {
+			member_result = MIN(result, len);
+			result -= member_result;
+		}
+
+		bio_request_finish(member, member_result);
+	}
+
+	free(merge);
+}
+
+static bio_request_t *bio_build_merge(bio_request_t *head, struct list_node *members)
+{
+	struct bio_merge *merge;
+	bio_request_t *member;
+	uint iov_cnt = 0;
+	uint count = 0;
+
+	merge = malloc(sizeof(*merge));
+	if (!merge)
+		return NULL;
+
+	list_initialize(&merge->members);
+	list_add_tail(&merge->members, &head->node);
+	while ((member = list_remove_head_type(members, bio_request_t, node)))
+		list_add_tail(&merge->members, &member->node);
+
+	list_for_every_entry(&merge->members, member, bio_request_t, node) {
+		memcpy(&merge->iov[iov_cnt], member->iov, member->iov_cnt * sizeof(iovec_t));
+		iov_cnt += member->iov_cnt;
+		count += member->count;
+	}
+
+	merge->req.op = head->op;
+	merge->req.block = head->block;
+	merge->req.iov = merge->iov;
+	merge->req.iov_cnt = iov_cnt;
+	merge->req.callback = &bio_merge_callback;
+	merge->req.cookie = merge;
+	merge->req.dev = head->dev;
+	merge->req.count = count;
+	merge->req.result = 0;
+
+	return &merge->req;
+}
+
+/* run a request on a driver without a submit hook */
+static ssize_t bio_sync_request(bdev_t *dev, bio_request_t *req)
+{
+	bnum_t block = req->block;
+	ssize_t total = 0;
+	uint i = 0;
+
+	while (i < req->iov_cnt) {
+		uint8_t *base = req->iov[i].iov_base;
+		size_t len = req->iov[i].iov_len;
+		ssize_t ret;
+
+		/* segments that follow each other in memory go down as one transfer */
+		for (i++; i < req->iov_cnt && req->iov[i].iov_base == base + len; i++)
+			len += req->iov[i].iov_len;
+
+		uint count = len >> dev->block_shift;
+		if (req->op == BIO_OP_READ)
+			ret = dev->read_block(dev, base, block, count);
+		else
+			ret = dev->write_block(dev, base, block, count);
+
+		if (ret < 0)
+			return ret;
+
+		total += ret;
+		if ((size_t)ret < len)
+			break;
+
+		block += count;
+	}
+
+	return total;
+}
+
+static void bio_queue_run(void *arg)
+{
+	bdev_t *dev = arg;
+	bio_request_t *req;
+	struct list_node members;
+	bool done;
+
+	for (;;) {
+		list_initialize(&members);
+
+		/* retire finished requests first, they free up queue slots */
+		enter_critical_section();
+		req = list_remove_head_type(&dev->done_queue, bio_request_t, node);
+		done = (req != NULL);
+		if (done) {
+			DEBUG_ASSERT(dev->in_flight > 0);
+			dev->in_flight--;
+		} else if (dev->in_flight < dev->queue_depth) {
+			req = list_remove_head_type(&dev->queue, bio_request_t, node);
+			if (req) {
+				dev->in_flight++;
+				bio_collect_merge(dev, req, &members);
+			}
+		}
+		exit_critical_section();
+
+		if (!req)
+			break;
+
+		if (done) {
+			/* merged runs account for each of their members */
+			if (req->callback == &bio_merge_callback)
+				req->callback(req, req->result);
+			else
+				bio_request_finish(req, req->result);
+			continue;
+		}
+
+		if (!list_is_empty(&members)) {
+			bio_request_t *merged = bio_build_merge(req, &members);
+			if (merged) {
+				req = merged;
+			} else {
+				/* no memory to merge, put the rest back and go one at a time */
+				bio_request_t *member;
+				enter_critical_section();
+				while ((member = list_remove_tail_type(&members, bio_request_t, node)))
+					list_add_head(&dev->queue, &member->node);
+				exit_critical_section();
+			}
+		}
+
+		LTRACEF("dispatch dev '%s', op %d, block %u, count %u\n", dev->name, req->op, req->block, req->count);
+
+		if (dev->submit) {
+			status_t err = dev->submit(dev, req);
+			if (err < 0)
+				bio_request_complete(req, err);
+		} else {
+			bio_request_complete(req, bio_sync_request(dev, req));
+		}
+	}
+}
+
+struct bio_sync_wait {
+	event_t event;
+	ssize_t result;
+};
+
+static void bio_sync_callback(bio_request_t *req, ssize_t result)
+{
+	struct bio_sync_wait *wait = req->cookie;
+
+	wait->result = result;
+	event_signal(&wait->event, false);
+}
+
+static ssize_t bio_block_iovec(bdev_t *dev, int op, const iovec_t *iov, uint iov_cnt, bnum_t block)
+{
+	struct bio_sync_wait wait;
+	bio_request_t req;
+	status_t err;
+
+	event_init(&wait.event, false, 0);
+	wait.result = 0;
+
+	req.op = op;
+	req.block = block;
+	req.iov = iov;
+	req.iov_cnt = iov_cnt;
+	req.callback = &bio_sync_callback;
+	req.cookie = &wait;
+
+	err = bio_submit(dev, &req);
+	if (err < 0)
+		return err;
+
+	event_wait(&wait.event);
+	event_destroy(&wait.event);
+
+	return wait.result;
+}
+
+ssize_t bio_read_block_iovec(bdev_t *dev, const iovec_t *iov, uint iov_cnt, bnum_t block)
+{
+	return bio_block_iovec(dev, BIO_OP_READ, iov, iov_cnt, block);
+}
+
+ssize_t bio_write_block_iovec(bdev_t *dev, const iovec_t *iov, uint iov_cnt, bnum_t block)
+{
+	return bio_block_iovec(dev, BIO_OP_WRITE, iov, iov_cnt, block);
+}
+
+// vim: set ts=4 sw=4 noexpandtab:
@@ -2,10 +2,16 @@ LOCAL_DIR := $(GET_LOCAL_DIR)
 
 MODULE := $(LOCAL_DIR)
 
+MODULE_DEPS += \
+	lib/dpc \
+	lib/iovec
+
 MODULE_SRCS += \
 	$(LOCAL_DIR)/bio.c \
 	$(LOCAL_DIR)/debug.c \
 	$(LOCAL_DIR)/mem.c \
+	$(LOCAL_DIR)/queue.c \
+	$(LOCAL_DIR)/stats.c \
 	$(LOCAL_DIR)/subdev.c 
 
 include make/module.mk
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2015 Travis Geiselbrecht
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <debug.h>
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <lib/bio.h>
+#include <kernel/thread.h>
+#include <platform.h>
+
+static uint bio_stats_log2(uint64_t val)
+{
+	uint l = 0;
+
+	while (val >>= 1)
+		l++;
+
+	return l;
+}
+
+void bio_stats_record(bdev_t *dev, int op, off_t offset, ssize_t result, lk_bigtime_t start)
+{
+	struct bio_stats *stats = &dev->stats;
+	lk_bigtime_t elapsed = current_time_hires() - start;
+	uint size_bucket, lat_bucket;
+
+	DEBUG_ASSERT(op == BIO_OP_READ || op == BIO_OP_WRITE);
+
+	/* a subdevice passes every transfer on to its parent, which counts it */
+	if (dev->is_subdev)
+		return;
+
+	/* bucket n holds sizes up to 512 << n, 512 bytes and under land in the first */
+	size_bucket = (result > 512) ? bio_stats_log2(result - 1) + 1 - 9 : 0;
+	size_bucket = MIN(size_bucket, BIO_STATS_SIZE_BUCKETS - 1);
+	lat_bucket = MIN(bio_stats_log2(elapsed), BIO_STATS_LAT_BUCKETS - 1);
+
+	enter_critical_section();
+
+	if (result < 0) {
+		stats->errors++;
+	} else {
+		stats->ops[op]++;
+		stats->bytes[op] += result;
+		stats->busy_time += elapsed;
+		stats->size_hist[size_bucket]++;
+		stats->lat_hist[lat_bucket]++;
+
+		if (offset == stats->next_offset)
+			stats->sequential++;
+		else
+			stats->random++;
+		stats->next_offset = offset + result;
+	}
+
+	exit_critical_section();
+}
+
+void bio_stats_reset(bdev_t *dev)
+{
+	enter_critical_section();
+	memset(&dev->stats, 0, sizeof(dev->stats));
+	exit_critical_section();
+}
+
+static void bio_stats_size_name(uint bucket, char *buf, size_t len)
+{
+	uint64_t size = 512ULL << bucket;
+
+	if (size >= 1024 * 1024)
+		snprintf(buf, len, "%lluM", (unsigned long long)(size / (1024 * 1024)));
+	else if (size >= 1024)
+		snprintf(buf, len, "%lluK", (unsigned long long)(size / 1024));
+	else
+		snprintf(buf, len, "%llu", (unsigned long long)size);
+}
+
+int bio_stats_format(const bdev_t *dev, uint line, char *buf, size_t len)
+{
+	const struct bio_stats *stats = &dev->stats;
+	char name[8];
+	uint i;
+
+	if (dev->is_subdev) {
+		if (line > 0)
+			return -1;
+		snprintf(buf, len, "%s: counted on the parent device", dev->name);
+		return 0;
+	}
+
+	switch (line) {
+		case 0:
+			snprintf(buf, len, "%s: rd %llu ops %llu KB", dev->name,
+			         (unsigned long long)stats->ops[BIO_OP_READ],
+			         (unsigned long long)(stats->bytes[BIO_OP_READ] / 1024));
+			return 0;
+		case 1:
+			snprintf(buf, len, "  wr %llu ops %llu KB, %u errors",
+			         (unsigned long long)stats->ops[BIO_OP_WRITE],
+			         (unsigned long long)(stats->bytes[BIO_OP_WRITE] / 1024), stats->errors);
+			return 0;
+		case 2:
+			snprintf(buf, len, "  seq %u rand %u busy %llu ms",
+			         stats->sequential, stats->random, stats->busy_time / 1000);
+			return 0;
+	}
+
+	/* then one line per populated histogram bucket, sizes first */
+	line -= 3;
+	for (i = 0; i < BIO_STATS_SIZE_BUCKETS; i++) {
+		if (!stats->size_hist[i])
+			continue;
+		if (line-- == 0) {
+			if (i == BIO_STATS_SIZE_BUCKETS - 1) {
+				bio_stats_size_name(i - 1, name, sizeof(name));
+				snprintf(buf, len, "  size >%s: %u", name, stats->size_hist[i]);
+			} else {
+				bio_stats_size_name(i, name, sizeof(name));
+				snprintf(buf, len, "  size <=%s: %u", name, stats->size_hist[i]);
+			}
+			return 0;
+		}
+	}
+
+	for (i = 0; i < BIO_STATS_LAT_BUCKETS; i++) {
+		if (!stats->lat_hist[i])
+			continue;
+		if (line-- == 0) {
+			snprintf(buf, len, "  lat %s%lu us: %u", (i == BIO_STATS_LAT_BUCKETS - 1) ? ">=" : "<",
+			         (i == BIO_STATS_LAT_BUCKETS - 1) ? (1UL << i) : (2UL << i), stats->lat_hist[i]);
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+void bio_stats_dump(const bdev_t *dev)
+{
+	char line[64];
+	uint i;
+
+	for (i = 0; bio_stats_format(dev, i, line, sizeof(line)) == 0; i++)
+		printf("%s\n", line);
+}
+
+// vim: set ts=4 sw=4 noexpandtab:
@@ -74,6 +74,17 @@ static void dump_history(void);
 /* list of installed commands */
 static cmd_block *command_list = NULL;
 
+/* hash index over command_list, newest registration first in each chain */
+#define COMMAND_HASH_SIZE 64
+
+struct command_hash_entry {
+	struct command_hash_entry *next;
+	const cmd *command;
+};
+
+static struct command_hash_entry *command_hash[COMMAND_HASH_SIZE];
+static bool command_hash_partial;
+
 /* a linear array of statically defined command blocks,
    defined in the linker script.
  */
@@ -211,11 +222,56 @@ static const char *prev_history(uint *cursor)
 }
 #endif
 
+/* FNV-1a */
+static uint command_hash_bucket(const char *str)
+{
+	uint32_t hash = 2166136261u;
+
+	while (*str) {
+		hash ^= (unsigned char)*str++;
+		hash *= 16777619u;
+	}
+
+	return hash % COMMAND_HASH_SIZE;
+}
+
+static void command_hash_add(const cmd_block *block)
+{
+	struct command_hash_entry *entry;
+	uint bucket;
+	size_t i;
+
+	/* walk the block backwards so its first entry ends up nearest the head */
+	for (i = block->count; i > 0; i--) {
+		entry = malloc(sizeof(*entry));
+		if (!entry) {
+			command_hash_partial = true;
+			return;
+		}
+
+		bucket = command_hash_bucket(block->list[i - 1].cmd_str);
+		entry->command = &block->list[i - 1];
+		entry->next = command_hash[bucket];
+		command_hash[bucket] = entry;
+	}
+}
+
 static const cmd *match_command(const char *command)
 {
+	struct command_hash_entry *entry;
 	cmd_block *block;
 	size_t i;
 
+	if (!command_hash_partial) {
+		entry = command_hash[command_hash_bucket(command)];
+		for (; entry != NULL; entry = entry->next) {
+			if (strcmp(command, entry->command->cmd_str) == 0)
+				return entry->command;
+		}
+
+		return NULL;
+	}
+
 	for (block = command_list; block != NULL; block = block->next) {
 		const cmd *curr_cmd = block->list;
 		for (i = 0; i < block->count; i++) {
@@ -753,6 +809,9 @@ void console_register_commands(cmd_block *block)
 
 	block->next = command_list;
 	command_list = block;
+
+	if (!command_hash_partial)
+		command_hash_add(block);
 }
 
 static int cmd_help(int argc, const cmd_args *argv)
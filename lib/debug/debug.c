@@ -73,6 +73,8 @@ void dump_frame(void *frame)
 
 void _panic(void *caller, const char *fmt, ...)
 {
+	platform_panic_start();
+
 	dprintf(ALWAYS, "panic (frame %p): \n", __GET_FRAME());
 	dump_frame(__GET_FRAME());
 	dprintf(ALWAYS, "panic (caller %p): ", caller);
@@ -132,18 +134,34 @@ FILE __stdio_FILEs[3] = {
 
 int _dputs(const char *str)
 {
-	while (*str != 0) {
-		_dputc(*str++);
-	}
+	platform_dputs(str, strlen(str));
 
 	return 0;
 }
 
+/* formatted output is collected here and handed to the platform in runs */
+struct dprintf_buf {
+	size_t len;
+	char data[128];
+};
+
+static void _dprintf_buf_flush(struct dprintf_buf *buf)
+{
+	if (buf->len) {
+		platform_dputs(buf->data, buf->len);
+		buf->len = 0;
+	}
+}
+
 static int _dprintf_output_func(const char *str, size_t len, void *state)
 {
+	struct dprintf_buf *buf = state;
 	size_t count = 0;
+
 	while (count < len && *str) {
-		_dputc(*str);
+		if (buf->len == sizeof(buf->data))
+			_dprintf_buf_flush(buf);
+		buf->data[buf->len++] = *str;
 		str++;
 		count++;
 	}
@@ -153,25 +171,29 @@ static int _dprintf_output_func(const char *str, size_t len, void *state)
 
 int _dprintf(const char *fmt, ...)
 {
-	char ts_buf[13];
+	struct dprintf_buf buf;
 	int err;
 
-	snprintf(ts_buf, sizeof(ts_buf), "[%lu] ", current_time());
-	dputs(ALWAYS, ts_buf);
+	buf.len = snprintf(buf.data, sizeof(buf.data), "[%lu] ", current_time());
 
 	va_list ap;
 	va_start(ap, fmt);
-	err = _printf_engine(&_dprintf_output_func, NULL, fmt, ap);
+	err = _printf_engine(&_dprintf_output_func, &buf, fmt, ap);
 	va_end(ap);
 
+	_dprintf_buf_flush(&buf);
+
 	return err;
 }
 
 int _dvprintf(const char *fmt, va_list ap)
 {
+	struct dprintf_buf buf;
 	int err;
 
-	err = _printf_engine(&_dprintf_output_func, NULL, fmt, ap);
+	buf.len = 0;
+	err = _printf_engine(&_dprintf_output_func, &buf, fmt, ap);
+	_dprintf_buf_flush(&buf);
 
 	return err;
 }
@@ -23,60 +23,176 @@
 #include <debug.h>
 #include <stddef.h>
 #include <list.h>
-#include <malloc.h>
 #include <err.h>
 #include <lib/dpc.h>
 #include <kernel/thread.h>
 #include <kernel/event.h>
 #include <lk/init.h>
 
-struct dpc {
-	struct list_node node;
-
-	dpc_callback cb;
-	void *arg;
+/* number of work items that can be pending at once */
+#ifndef DPC_POOL_SIZE
+#define DPC_POOL_SIZE 32
+#endif
+
+/* number of worker threads, more than one keeps a slow callback from
+ * holding up everything queued behind it */
+#ifndef DPC_WORKERS
+#define DPC_WORKERS 1
+#endif
+
+/* items a worker takes off the queues per trip through the critical section */
+#define DPC_BATCH 8
+
+enum {
+	DPC_PRIO_HIGH = 0,
+	DPC_PRIO_NORMAL,
+	DPC_PRIO_LOW,
+	DPC_PRIO_COUNT,
 };
 
-static struct list_node dpc_list = LIST_INITIAL_VALUE(dpc_list);
-static event_t dpc_event;
+/* the pool is handed out lazily and everything else is initialized
+ * statically, so work can be queued before the workers are started */
+static struct dpc dpc_pool[DPC_POOL_SIZE];
+static uint dpc_pool_used;
+static struct list_node dpc_free_list = LIST_INITIAL_VALUE(dpc_free_list);
+static struct list_node dpc_list[DPC_PRIO_COUNT] = {
+	[DPC_PRIO_HIGH] = LIST_INITIAL_VALUE(dpc_list[DPC_PRIO_HIGH]),
+	[DPC_PRIO_NORMAL] = LIST_INITIAL_VALUE(dpc_list[DPC_PRIO_NORMAL]),
+	[DPC_PRIO_LOW] = LIST_INITIAL_VALUE(dpc_list[DPC_PRIO_LOW]),
+};
+static event_t dpc_event = EVENT_INITIAL_VALUE(dpc_event, false, 0);
 
 static int dpc_thread_routine(void *arg);
 
+static uint dpc_flags_to_prio(uint flags)
+{
+	if (flags & DPC_FLAG_PRIO_HIGH)
+		return DPC_PRIO_HIGH;
+	if (flags & DPC_FLAG_PRIO_LOW)
+		return DPC_PRIO_LOW;
+	return DPC_PRIO_NORMAL;
+}
+
 status_t dpc_queue(dpc_callback cb, void *arg, uint flags)
 {
+	struct list_node *list = &dpc_list[dpc_flags_to_prio(flags)];
 	struct dpc *dpc;
 
-	dpc = malloc(sizeof(struct dpc));
+	enter_critical_section();
+
+	if (flags & DPC_FLAG_COALESCE) {
+		list_for_every_entry(list, dpc, struct dpc, node) {
+			if (dpc->cb == cb && dpc->arg == arg) {
+				exit_critical_section();
+				return NO_ERROR;
+			}
+		}
+	}
 
-	if (dpc == NULL)
+	dpc = list_remove_head_type(&dpc_free_list, struct dpc, node);
+	if (dpc == NULL && dpc_pool_used < DPC_POOL_SIZE)
+		dpc = &dpc_pool[dpc_pool_used++];
+	if (dpc == NULL) {
+		exit_critical_section();
 		return ERR_NO_MEMORY;
+	}
 
 	dpc->cb = cb;
 	dpc->arg = arg;
-	enter_critical_section();
-	list_add_tail(&dpc_list, &dpc->node);
+	list_add_tail(list, &dpc->node);
 	event_signal(&dpc_event, (flags & DPC_FLAG_NORESCHED) ? false : true);
 	exit_critical_section();
 
 	return NO_ERROR;
 }
 
+void dpc_queue_item(dpc_t *dpc, dpc_callback cb, void *arg, uint flags)
+{
+	enter_critical_section();
+
+	if (!list_in_list(&dpc->node)) {
+		dpc->cb = cb;
+		dpc->arg = arg;
+		list_add_tail(&dpc_list[dpc_flags_to_prio(flags)], &dpc->node);
+		event_signal(&dpc_event, (flags & DPC_FLAG_NORESCHED) ? false : true);
+	}
+
+	exit_critical_section();
+}
+
+static bool dpc_from_pool(struct dpc *dpc)
+{
+	return dpc >= dpc_pool && dpc < dpc_pool + DPC_POOL_SIZE;
+}
+
+/* copy out up to max items of the most urgent priority above limit and
+ * hand the nodes straight back to the pool or their owner, so producers
+ * never wait on callbacks. A batch never mixes priorities. Must be called
+ * in a critical section.
+ */
+static uint dpc_take(struct dpc *batch, uint max, uint limit, uint *prio_out)
+{
+	struct dpc *dpc;
+	uint count = 0;
+	uint prio;
+
+	for (prio = 0; prio < limit; prio++) {
+		if (!list_is_empty(&dpc_list[prio]))
+			break;
+	}
+	if (prio == limit)
+		return 0;
+
+	while (count < max &&
+	       (dpc = list_remove_head_type(&dpc_list[prio], struct dpc, node))) {
+		batch[count++] = *dpc;
+		if (dpc_from_pool(dpc))
+			list_add_head(&dpc_free_list, &dpc->node);
+	}
+
+	*prio_out = prio;
+	return count;
+}
+
+/* run anything more urgent than prio that was queued in the meantime */
+static void dpc_run_preempting(uint prio)
+{
+	struct dpc dpc;
+	uint taken;
+
+	for (;;) {
+		enter_critical_section();
+		if (!dpc_take(&dpc, 1, prio, &taken)) {
+			exit_critical_section();
+			return;
+		}
+		exit_critical_section();
+
+		dpc.cb(dpc.arg);
+	}
+}
+
 static int dpc_thread_routine(void *arg)
 {
+	struct dpc batch[DPC_BATCH];
+	uint count;
+	uint prio;
+	uint i;
+
 	for (;;) {
 		event_wait(&dpc_event);
 
 		enter_critical_section();
-		struct dpc *dpc = list_remove_head_type(&dpc_list, struct dpc, node);
-		if (!dpc)
+		count = dpc_take(batch, DPC_BATCH, DPC_PRIO_COUNT, &prio);
+		if (count == 0)
 			event_unsignal(&dpc_event);
 		exit_critical_section();
 
-		if (dpc) {
-//			dprintf("dpc calling %p, arg %p\n", dpc->cb, dpc->arg);
-			dpc->cb(dpc->arg);
-
-			free(dpc);
+		for (i = 0; i < count; i++) {
+			if (i > 0 && prio > DPC_PRIO_HIGH)
+				dpc_run_preempting(prio);
+//			dprintf("dpc calling %p, arg %p\n", batch[i].cb, batch[i].arg);
+			batch[i].cb(batch[i].arg);
 		}
 	}
 
@@ -85,11 +201,10 @@ static int dpc_thread_routine(void *arg)
 
 static void dpc_init(uint level)
 {
-	event_init(&dpc_event, false, 0);
+	uint i;
 
-	thread_detach_and_resume(thread_create("dpc", &dpc_thread_routine, NULL, DPC_PRIORITY, DEFAULT_STACK_SIZE));
+	for (i = 0; i < DPC_WORKERS; i++)
+		thread_detach_and_resume(thread_create("dpc", &dpc_thread_routine, NULL, DPC_PRIORITY, DEFAULT_STACK_SIZE));
 }
 
 LK_INIT_HOOK(libdpc, &dpc_init, LK_INIT_LEVEL_THREADING);
-
-
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2015, The Linux Foundation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of The Linux Foundation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <debug.h>
+#include <string.h>
+#include <stdlib.h>
+#include <err.h>
+#include <lib/evlog.h>
+#include <lib/evtrace.h>
+#include <kernel/thread.h>
+#include <platform.h>
+
+#define EVTRACE_UNIT    4
+#define EVTRACE_LEN     (EVTRACE_UNIT << EVTRACE_RING_SHIFT)
+
+static uintptr_t evtrace_items[EVTRACE_CAT_MAX][EVTRACE_LEN];
+
+/* statically set up so milestones before the heap are kept too */
+#define EVTRACE_RING(cat) \
+	[(cat)] = { \
+		.head = 0, \
+		.unitsize = EVTRACE_UNIT, \
+		.len_pow2 = EVTRACE_RING_SHIFT + 2, \
+		.items = evtrace_items[(cat)], \
+	}
+
+static evlog_t evtrace_rings[EVTRACE_CAT_MAX] = {
+	EVTRACE_RING(EVTRACE_CAT_KERNEL),
+	EVTRACE_RING(EVTRACE_CAT_STORAGE),
+	EVTRACE_RING(EVTRACE_CAT_USB),
+	EVTRACE_RING(EVTRACE_CAT_BOOT),
+};
+#undef EVTRACE_RING
+
+/* records ever written per ring, saturates at the ring size */
+static uint evtrace_count[EVTRACE_CAT_MAX];
+
+static volatile bool evtrace_enable = true;
+
+void evtrace_add(uint cat, uint id, uintptr_t arg0, uintptr_t arg1)
+{
+	evlog_t *e;
+	uint index;
+
+	if (!evtrace_enable || cat >= EVTRACE_CAT_MAX)
+		return;
+
+	e = &evtrace_rings[cat];
+
+	enter_critical_section();
+	index = evlog_bump_head(e);
+	e->items[index] = (uintptr_t)current_time_hires();
+	e->items[index + 1] = id;
+	e->items[index + 2] = arg0;
+	e->items[index + 3] = arg1;
+	if (evtrace_count[cat] < (1U << EVTRACE_RING_SHIFT))
+		evtrace_count[cat]++;
+	exit_critical_section();
+}
+
+void evtrace_clear(void)
+{
+	uint cat;
+
+	enter_critical_section();
+	for (cat = 0; cat < EVTRACE_CAT_MAX; cat++) {
+		evtrace_rings[cat].head = 0;
+		evtrace_count[cat] = 0;
+	}
+	exit_critical_section();
+}
+
+size_t evtrace_export_size(void)
+{
+	return sizeof(struct evtrace_export_hdr) +
+		EVTRACE_CAT_MAX * sizeof(struct evtrace_export_cat) +
+		sizeof(evtrace_items);
+}
+
+/* copy one ring out oldest record first, returns bytes written */
+static size_t evtrace_export_ring(uint cat, uint8_t *buf)
+{
+	evlog_t *e = &evtrace_rings[cat];
+	uint count = evtrace_count[cat];
+	uint len = EVTRACE_LEN;
+	uint start = (e->head - count * EVTRACE_UNIT) & (len - 1);
+	uint first = MIN(count * EVTRACE_UNIT, len - start);
+	uint rest = count * EVTRACE_UNIT - first;
+
+	memcpy(buf, &e->items[start], first * sizeof(uintptr_t));
+	memcpy(buf + first * sizeof(uintptr_t), &e->items[0], rest * sizeof(uintptr_t));
+
+	return count * EVTRACE_UNIT * sizeof(uintptr_t);
+}
+
+size_t evtrace_export(void *_buf, size_t len)
+{
+	uint8_t *buf = _buf;
+	struct evtrace_export_hdr *hdr = _buf;
+	struct evtrace_export_cat *cats;
+	size_t pos;
+	uint cat;
+
+	if (len < evtrace_export_size())
+		return 0;
+
+	hdr->magic = EVTRACE_EXPORT_MAGIC;
+	hdr->version = EVTRACE_EXPORT_VERSION;
+	hdr->word_size = sizeof(uintptr_t);
+	hdr->num_cats = EVTRACE_CAT_MAX;
+	hdr->ticks_per_sec = 1000000;
+
+	cats = (struct evtrace_export_cat *)(buf + sizeof(*hdr));
+	pos = sizeof(*hdr) + EVTRACE_CAT_MAX * sizeof(*cats);
+
+	/* a consistent snapshot, nothing records while we copy */
+	enter_critical_section();
+	for (cat = 0; cat < EVTRACE_CAT_MAX; cat++) {
+		cats[cat].cat = cat;
+		cats[cat].count = evtrace_count[cat];
+		pos += evtrace_export_ring(cat, buf + pos);
+	}
+	exit_critical_section();
+
+	return pos;
+}
+
+#if WITH_LIB_CONSOLE
+#include <lib/console.h>
+#include <stdio.h>
+
+static const char *evtrace_cat_name[EVTRACE_CAT_MAX] = {
+	[EVTRACE_CAT_KERNEL] = "kernel",
+	[EVTRACE_CAT_STORAGE] = "storage",
+	[EVTRACE_CAT_USB] = "usb",
+	[EVTRACE_CAT_BOOT] = "boot",
+};
+
+static void evtrace_dump_cat(uint cat)
+{
+	evlog_t *e = &evtrace_rings[cat];
+	uint count = evtrace_count[cat];
+	uint index = (e->head - count * EVTRACE_UNIT) & (EVTRACE_LEN - 1);
+
+	printf("%s: %u records\n", evtrace_cat_name[cat], count);
+	while (count--) {
+		const uintptr_t *i = &e->items[index];
+
+		printf("\t%lu: id %lu 0x%lx 0x%lx\n", i[0], i[1], i[2], i[3]);
+		index = (index + EVTRACE_UNIT) & (EVTRACE_LEN - 1);
+	}
+}
+
+static int cmd_evtrace(int argc, const cmd_args *argv)
+{
+	uint cat;
+
+	if (argc < 2) {
+usage:
+		printf("usage:\n");
+		printf("%s dump\n", argv[0].str);
+		printf("%s clear\n", argv[0].str);
+		printf("%s on|off\n", argv[0].str);
+		return ERR_INVALID_ARGS;
+	}
+
+	if (!strcmp(argv[1].str, "dump")) {
+		evtrace_enable = false;
+		for (cat = 0; cat < EVTRACE_CAT_MAX; cat++)
+			evtrace_dump_cat(cat);
+		evtrace_enable = true;
+	} else if (!strcmp(argv[1].str, "clear")) {
+		evtrace_clear();
+	} else if (!strcmp(argv[1].str, "on")) {
+		evtrace_enable = true;
+	} else if (!strcmp(argv[1].str, "off")) {
+		evtrace_enable = false;
+	} else {
+		goto usage;
+	}
+
+	return NO_ERROR;
+}
+
+STATIC_COMMAND_START
+STATIC_COMMAND("evtrace", "binary event trace", &cmd_evtrace)
+STATIC_COMMAND_END(evtrace);
+
+#endif
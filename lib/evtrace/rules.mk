@@ -0,0 +1,11 @@
+LOCAL_DIR := $(GET_LOCAL_DIR)
+
+MODULE := $(LOCAL_DIR)
+
+MODULE_DEPS += \
+	lib/evlog
+
+MODULE_SRCS += \
+	$(LOCAL_DIR)/evtrace.c
+
+include make/module.mk
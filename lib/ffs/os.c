@@ -92,7 +92,7 @@ DSTATUS disk_status(BYTE pdrv)
 	return RES_OK;
 }
 
-DRESULT disk_read(BYTE pdrv, BYTE* buf, DWORD sector, BYTE count)
+DRESULT disk_read(BYTE pdrv, BYTE* buf, DWORD sector, UINT count)
 {
 	ssize_t ret;
 
@@ -108,7 +108,7 @@ DRESULT disk_read(BYTE pdrv, BYTE* buf, DWORD sector, BYTE count)
 }
 
 #if	_READONLY == 0
-DRESULT disk_write(BYTE pdrv, const BYTE* buf, DWORD sector, BYTE count)
+DRESULT disk_write(BYTE pdrv, const BYTE* buf, DWORD sector, UINT count)
 {
 	ssize_t ret;
 
@@ -182,6 +182,45 @@ DWORD get_fattime(void)
 			;
 }
 
+#if _USE_FASTSEEK
+#define LINKMAP_INITIAL_ITEMS 32
+
+/*
+ * Build the cluster link map of an open file so that reads and seeks never
+ * walk the FAT again. The table is sized on a first pass and grown once if
+ * the file is more fragmented than that. On failure the file simply stays
+ * in normal seek mode.
+ */
+static void ffs_create_linkmap(FIL *fil)
+{
+	FRESULT res;
+	DWORD *tbl;
+	DWORD items = LINKMAP_INITIAL_ITEMS;
+	DWORD needed;
+
+	for (;;) {
+		tbl = malloc(items * sizeof(DWORD));
+		if (!tbl)
+			return;
+
+		tbl[0] = items;
+		fil->cltbl = tbl;
+		res = f_lseek(fil, CREATE_LINKMAP);
+		if (res == FR_OK)
+			return;
+
+		/* on a short table, the first item holds the required size */
+		needed = tbl[0];
+		fil->cltbl = NULL;
+		free(tbl);
+		if (res != FR_NOT_ENOUGH_CORE || needed <= items)
+			return;
+
+		items = needed;
+	}
+}
+#endif
+
 FILE *fopen(const char *filename, const char *mode)
 {
 	FRESULT res;
@@ -215,6 +254,12 @@ FILE *fopen(const char *filename, const char *mode)
 		return NULL;
 	}
 
+#if _USE_FASTSEEK
+	/* files opened for reading only get a cluster link map for fast seek */
+	if (flags == FA_READ)
+		ffs_create_linkmap(fil);
+#endif
+
 	return (FILE *) fil;
 }
 
@@ -226,7 +271,10 @@ int fclose(FILE *stream)
 	res = f_close(fil);
 	if (res != FR_OK)
 		return -1;
-	
+
+#if _USE_FASTSEEK
+	free(fil->cltbl);
+#endif
 	free(fil);
 	return 0;
 }
@@ -72,7 +72,7 @@ int ext2_read_file(fsfilecookie fcookie, void *buf, off_t offset, size_t len)
 	}
 
 	// read from the inode
-	err = ext2_read_inode(file->ext2, &file->inode, buf, offset, len);
+	err = ext2_read_inode_cached(file->ext2, &file->inode, file->ind_cache, buf, offset, len);
 
 	return err;
 }
@@ -84,7 +84,7 @@ int ext2_close_file(fsfilecookie fcookie)
 	// see if we need to free any of the cache blocks
 	int i;
 	for (i=0; i < 3; i++) {
-		if (file->ind_cache[i].num != 0) {
+		if (file->ind_cache[i].ptr != NULL) {
 			free(file->ind_cache[i].ptr);
 		}
 	}
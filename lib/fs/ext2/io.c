@@ -23,13 +23,111 @@
 
 #include <string.h>
 #include <stdlib.h>
+#include <err.h>
 #include <debug.h>
 #include <trace.h>
+#include <arch/defines.h>
+#include <kernel/event.h>
 #include <lib/fs/ext2.h>
 #include "ext2_priv.h"
 
 #define LOCAL_TRACE 0
 
+/* contiguous runs kept in flight at once by ext2_read_inode */
+#define EXT2_READ_BATCH 8
+
+struct ext2_read_batch {
+	event_t event;
+	uint submitted;
+	uint outstanding;
+	int err;
+	struct {
+		bio_request_t req;
+		iovec_t iov;
+	} run[EXT2_READ_BATCH];
+};
+
+static void ext2_read_batch_callback(bio_request_t *req, ssize_t result)
+{
+	struct ext2_read_batch *batch = req->cookie;
+
+	enter_critical_section();
+	if (result < (ssize_t)req->iov[0].iov_len && batch->err >= 0)
+		batch->err = (result < 0) ? result : ERR_IO;
+	if (--batch->outstanding == 0)
+		event_signal(&batch->event, false);
+	exit_critical_section();
+}
+
+/* wait for every run queued so far, returns the first error */
+static int ext2_read_batch_wait(struct ext2_read_batch *batch)
+{
+	bool done;
+
+	for (;;) {
+		enter_critical_section();
+		done = (batch->outstanding == 0);
+		if (!done)
+			event_unsignal(&batch->event);
+		exit_critical_section();
+
+		if (done)
+			break;
+		event_wait(&batch->event);
+	}
+
+	batch->submitted = 0;
+	batch->outstanding = 0;
+	return batch->err;
+}
+
+/* queue a run on the device, or read it inline if it doesn't fit the device blocks */
+static int ext2_read_batch_add(ext2_t *ext2, struct ext2_read_batch *batch, void *buf, off_t offset, size_t len)
+{
+	bdev_t *dev = ext2->dev;
+	int err;
+
+	if ((offset % dev->block_size) != 0 || (len % dev->block_size) != 0) {
+		ssize_t ret = bio_read(dev, buf, offset, len);
+		if (ret < (ssize_t)len)
+			return (ret < 0) ? ret : ERR_IO;
+		return 0;
+	}
+
+	if (batch->submitted == EXT2_READ_BATCH) {
+		err = ext2_read_batch_wait(batch);
+		if (err < 0)
+			return err;
+	}
+
+	bio_request_t *req = &batch->run[batch->submitted].req;
+	iovec_t *iov = &batch->run[batch->submitted].iov;
+
+	iov->iov_base = buf;
+	iov->iov_len = len;
+	req->op = BIO_OP_READ;
+	req->block = offset / dev->block_size;
+	req->iov = iov;
+	req->iov_cnt = 1;
+	req->callback = &ext2_read_batch_callback;
+	req->cookie = batch;
+
+	enter_critical_section();
+	batch->outstanding++;
+	exit_critical_section();
+
+	err = bio_submit(dev, req);
+	if (err < 0) {
+		enter_critical_section();
+		batch->outstanding--;
+		exit_critical_section();
+		return err;
+	}
+
+	batch->submitted++;
+	return 0;
+}
+
 int ext2_read_block(ext2_t *ext2, void *buf, blocknum_t bnum)
 {
 	return bcache_read_block(ext2->cache, buf, bnum);
@@ -115,7 +213,8 @@ int ext2_get_indirect_block_pointer_cache_block(ext2_t *ext2, struct ext2_inode
 		}
 
 		if (current_block == 0) {
-			err = -1;
+			/* sparse, no table at this level */
+			err = ERR_NOT_FOUND;
 			goto error;
 		}
 
@@ -143,8 +242,32 @@ error:
 	return err;
 }
 
-/* translate a file block to a physical block */
-static blocknum_t file_block_to_fs_block(ext2_t *ext2, struct ext2_inode *inode, uint fileblock)
+/* return the indirect table at bnum, keeping a private copy of it in the per file cache slot */
+static int ext2_get_cached_ind_table(ext2_t *ext2, struct cache_block *cb, blocknum_t bnum, blocknum_t **table)
+{
+	int err;
+
+	if (cb->num != bnum) {
+		if (!cb->ptr) {
+			cb->ptr = malloc(EXT2_BLOCK_SIZE(ext2->sb));
+			if (!cb->ptr)
+				return ERR_NO_MEMORY;
+		}
+
+		cb->num = 0;
+		err = ext2_read_block(ext2, cb->ptr, bnum);
+		if (err < 0)
+			return err;
+		cb->num = bnum;
+	}
+
+	*table = cb->ptr;
+	return 0;
+}
+
+/* translate a file block to a physical block, 0 for a hole. a table that
+ * can't be read is an error, not a hole */
+static int file_block_to_fs_block(ext2_t *ext2, struct ext2_inode *inode, struct cache_block *ind_cache, uint fileblock, blocknum_t *_block)
 {
 	int err;
 	blocknum_t block;
@@ -160,13 +283,33 @@ static blocknum_t file_block_to_fs_block(ext2_t *ext2, struct ext2_inode *inode,
 	if (level == 0) {
 		/* direct block, just return it directly */
 		block = LE32(inode->i_block[fileblock]);
+	} else if (ind_cache) {
+		/* walk the tables through the open file's cache, one slot per level */
+		blocknum_t *table;
+		uint32_t i;
+
+		block = LE32(inode->i_block[pos[0]]);
+		for (i = 1; i <= level; i++) {
+			if (block == 0)
+				break;
+
+			err = ext2_get_cached_ind_table(ext2, &ind_cache[i - 1], block, &table);
+			if (err < 0)
+				return err;
+
+			block = LE32(table[pos[i]]);
+		}
 	} else {
 		/* at least one level of indirection, get a pointer to the final indirect block table and dereference it */
 		blocknum_t *ind_table;
 		blocknum_t phys_block;
 		err = ext2_get_indirect_block_pointer_cache_block(ext2, inode, &ind_table, level, pos, &phys_block);
-		if (err < 0)
+		if (err == ERR_NOT_FOUND) {
+			*_block = 0;
 			return 0;
+		}
+		if (err < 0)
+			return err;
 
 		/* dereference the final entry in the final table */
 		block = LE32(ind_table[pos[level]]);
@@ -178,10 +321,23 @@ static blocknum_t file_block_to_fs_block(ext2_t *ext2, struct ext2_inode *inode,
 
 	LTRACEF("returning %u\n", block);
 
-	return block;
+	*_block = block;
+	return 0;
+}
+
+int ext2_read_inode(ext2_t *ext2, struct ext2_inode *inode, void *buf, off_t offset, size_t len)
+{
+	return ext2_read_inode_cached(ext2, inode, NULL, buf, offset, len);
 }
 
-int ext2_read_inode(ext2_t *ext2, struct ext2_inode *inode, void *_buf, off_t offset, size_t len)
+/*
+ * read from an inode. whole blocks are gathered into runs of physically
+ * contiguous blocks and read straight into the caller's buffer, bypassing
+ * the block cache. runs are queued with bio_submit so the device can merge
+ * and overlap them. ind_cache, if not NULL,
+ * holds the indirect tables of an open file across calls.
+ */
+int ext2_read_inode_cached(ext2_t *ext2, struct ext2_inode *inode, struct cache_block *ind_cache, void *_buf, off_t offset, size_t len)
 {
 	int err = 0;
 	int bytes_read = 0;
@@ -208,11 +364,16 @@ int ext2_read_inode(ext2_t *ext2, struct ext2_inode *inode, void *_buf, off_t of
 		uint8_t temp[EXT2_BLOCK_SIZE(ext2->sb)];
 
 		/* calculate the block and read it */
-		blocknum_t phys_block = file_block_to_fs_block(ext2, inode, file_block);
+		blocknum_t phys_block;
+		err = file_block_to_fs_block(ext2, inode, ind_cache, file_block, &phys_block);
+		if (err < 0)
+			return err;
 		if (phys_block == 0) {
 			memset(temp, 0, EXT2_BLOCK_SIZE(ext2->sb));
 		} else {
-			ext2_read_block(ext2, temp, phys_block);
+			err = ext2_read_block(ext2, temp, phys_block);
+			if (err < 0)
+				return err;
 		}
 
 		/* copy out what we need */
@@ -227,40 +388,90 @@ int ext2_read_inode(ext2_t *ext2, struct ext2_inode *inode, void *_buf, off_t of
 		buf += tocopy;
 	}
 
-	/* handle middle blocks */
+	/* handle middle blocks, a physically contiguous run at a time, several runs in flight */
+	struct ext2_read_batch batch;
+	event_init(&batch.event, false, 0);
+	batch.submitted = 0;
+	batch.outstanding = 0;
+	batch.err = 0;
+
 	while (len >= EXT2_BLOCK_SIZE(ext2->sb)) {
-		/* calculate the block and read it */
-		blocknum_t phys_block = file_block_to_fs_block(ext2, inode, file_block);
+		uint block_size = EXT2_BLOCK_SIZE(ext2->sb);
+		uint max_blocks = len / block_size;
+		uint count;
+
+		/* calculate the first block and extend the run as far as it goes */
+		blocknum_t phys_block, next;
+		err = file_block_to_fs_block(ext2, inode, ind_cache, file_block, &phys_block);
+		if (err < 0)
+			break;
+		for (count = 1; count < max_blocks; count++) {
+			err = file_block_to_fs_block(ext2, inode, ind_cache, file_block + count, &next);
+			if (err < 0)
+				break;
+
+			/* holes form runs of their own */
+			if (phys_block == 0 ? next != 0 : next != phys_block + count)
+				break;
+		}
+		if (err < 0)
+			break;
+
+		size_t run_len = (size_t)count * block_size;
+		LTRACEF("file_block %u, phys_block %u, count %u\n", file_block, phys_block, count);
+
 		if (phys_block == 0) {
-			memset(buf, 0, EXT2_BLOCK_SIZE(ext2->sb));
+			memset(buf, 0, run_len);
+		} else if (IS_ALIGNED((uintptr_t)buf, CACHE_LINE) && IS_ALIGNED(run_len, CACHE_LINE)) {
+			err = ext2_read_batch_add(ext2, &batch, buf, (off_t)phys_block * block_size, run_len);
+			if (err < 0)
+				break;
 		} else {
-			ext2_read_block(ext2, buf, phys_block);
+			/* the device would dma into lines shared with the caller's
+			 * data, copy through the block cache instead */
+			for (uint i = 0; i < count; i++) {
+				err = ext2_read_block(ext2, buf + i * block_size, phys_block + i);
+				if (err < 0)
+					break;
+			}
+			if (err < 0)
+				break;
 		}
 
 		/* increment our stuff */
-		file_block++;
-		len -= EXT2_BLOCK_SIZE(ext2->sb);
-		bytes_read += EXT2_BLOCK_SIZE(ext2->sb);
-		buf += EXT2_BLOCK_SIZE(ext2->sb);
+		file_block += count;
+		len -= run_len;
+		bytes_read += run_len;
+		buf += run_len;
 	}
 
+	/* the runs must land before the buffer is handed back */
+	int batch_err = ext2_read_batch_wait(&batch);
+	event_destroy(&batch.event);
+	if (err >= 0)
+		err = batch_err;
+
 	/* handle partial last block */
-	if (len > 0) {
+	if (err >= 0 && len > 0) {
 		uint8_t temp[EXT2_BLOCK_SIZE(ext2->sb)];
 
 		/* calculate the block and read it */
-		blocknum_t phys_block = file_block_to_fs_block(ext2, inode, file_block);
-		if (phys_block == 0) {
-			memset(temp, 0, EXT2_BLOCK_SIZE(ext2->sb));
-		} else {
-			ext2_read_block(ext2, temp, phys_block);
+		blocknum_t phys_block;
+		err = file_block_to_fs_block(ext2, inode, ind_cache, file_block, &phys_block);
+		if (err >= 0) {
+			if (phys_block == 0)
+				memset(temp, 0, EXT2_BLOCK_SIZE(ext2->sb));
+			else
+				err = ext2_read_block(ext2, temp, phys_block);
 		}
 
-		/* copy out what we need */
-		memcpy(buf, temp, len);
+		if (err >= 0) {
+			/* copy out what we need */
+			memcpy(buf, temp, len);
 
-		/* increment our stuff */
-		bytes_read += len;
+			/* increment our stuff */
+			bytes_read += len;
+		}
 	}
 
 	LTRACEF("err %d, bytes_read %d\n", err, bytes_read);
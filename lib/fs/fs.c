@@ -36,6 +36,9 @@
 #if WITH_LIB_FS_FAT32
 #include <lib/fs/fat32.h>
 #endif
+#if WITH_LIB_FS_TARFS
+#include <lib/fs/tarfs.h>
+#endif
 
 #define LOCAL_TRACE 0
 
@@ -94,6 +97,17 @@ static struct fs_type types[] = {
 		.close = fat32_close_file,
 	},
 #endif
+#if WITH_LIB_FS_TARFS
+	{
+		.name = "tarfs",
+		.mount = tarfs_mount,
+		.unmount = tarfs_unmount,
+		.open = tarfs_open_file,
+		.stat = tarfs_stat_file,
+		.read = tarfs_read_file,
+		.close = tarfs_close_file,
+	},
+#endif
 };
 
 static void test_normalize(const char *in);
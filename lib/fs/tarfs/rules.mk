@@ -0,0 +1,13 @@
+LOCAL_DIR := $(GET_LOCAL_DIR)
+
+MODULE := $(LOCAL_DIR)
+
+MODULE_DEPS += \
+	lib/fs \
+	lib/bio \
+	lib/tar
+
+MODULE_SRCS += \
+	$(LOCAL_DIR)/tarfs.c
+
+include make/module.mk
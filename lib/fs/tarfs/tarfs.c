@@ -0,0 +1,397 @@
+/* Copyright (c) 2015, The Linux Foundation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of The Linux Fundation, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * Read-only filesystem over a ustar archive. Mounting walks the headers
+ * once and builds a hashed index of the paths; lookups never touch the
+ * device again. When the device is backed by memory (a sideloaded memdisk)
+ * headers are parsed in place and file data is copied straight out of the
+ * backing store rather than through block reads.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <err.h>
+#include <debug.h>
+#include <trace.h>
+#include <lib/tar.h>
+#include <lib/fs/tarfs.h>
+
+#define LOCAL_TRACE 0
+
+#define TAR_BLOCK_SIZE 512
+
+#define TAR_TYPE_REG     '0'
+#define TAR_TYPE_AREG    '\0'
+#define TAR_TYPE_DIR     '5'
+#define TAR_TYPE_LONGNAME 'L' /* GNU: the data is the next entry's name */
+
+struct tarfs_entry {
+	struct tarfs_entry *next;   /* hash chain, or archive order while indexing */
+	off_t offset;               /* of the data in the device */
+	off_t size;
+	bool is_dir;
+	char name[];
+};
+
+typedef struct {
+	bdev_t *dev;
+	const uint8_t *base;        /* backing memory, NULL if not memory mapped */
+	struct tarfs_entry **hash;
+	uint hash_size;             /* power of two */
+	uint count;
+	struct tarfs_entry root;
+} tarfs_t;
+
+typedef struct {
+	tarfs_t *tar;
+	struct tarfs_entry *entry;
+} tarfs_file_t;
+
+/* FNV-1a */
+static uint tarfs_hash(const char *name)
+{
+	uint32_t hash = 2166136261u;
+
+	while (*name) {
+		hash ^= (unsigned char)*name++;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+/*
+ * Strip leading "./" and "/" and trailing "/" so names match normalized
+ * paths. Header fields are not terminated when full, hence maxlen.
+ */
+static const char *tarfs_trim(const char *name, size_t maxlen, size_t *len)
+{
+	size_t n = strnlen(name, maxlen);
+
+	for (;;) {
+		if (n >= 1 && name[0] == '/') {
+			name++;
+			n--;
+		} else if (n >= 2 && name[0] == '.' && name[1] == '/') {
+			name += 2;
+			n -= 2;
+		} else {
+			break;
+		}
+	}
+
+	while (n > 0 && name[n - 1] == '/')
+		n--;
+
+	*len = n;
+	return name;
+}
+
+static struct tarfs_entry *tarfs_lookup(tarfs_t *tar, const char *path)
+{
+	struct tarfs_entry *entry;
+	char name[256];
+	size_t len;
+
+	path = tarfs_trim(path, sizeof(name), &len);
+	if (len == 0)
+		return &tar->root;
+	if (len >= sizeof(name))
+		return NULL;
+
+	memcpy(name, path, len);
+	name[len] = '\0';
+
+	entry = tar->hash[tarfs_hash(name) & (tar->hash_size - 1)];
+	for (; entry; entry = entry->next) {
+		if (!strcmp(entry->name, name))
+			return entry;
+	}
+
+	return NULL;
+}
+
+static const struct posix_header *tarfs_header(tarfs_t *tar, off_t offset,
+		uint8_t *buf)
+{
+	if (tar->base)
+		return (const struct posix_header *)(tar->base + offset);
+
+	if (bio_read(tar->dev, buf, offset, TAR_BLOCK_SIZE) != TAR_BLOCK_SIZE)
+		return NULL;
+
+	return (const struct posix_header *)buf;
+}
+
+static ssize_t tarfs_read(tarfs_t *tar, void *buf, off_t offset, size_t len)
+{
+	if (tar->base) {
+		memcpy(buf, tar->base + offset, len);
+		return len;
+	}
+
+	return bio_read(tar->dev, buf, offset, len);
+}
+
+static struct tarfs_entry *tarfs_new_entry(const char *prefix, size_t prefix_len,
+		const char *name, size_t name_len)
+{
+	struct tarfs_entry *entry;
+	size_t len = prefix_len ? prefix_len + 1 + name_len : name_len;
+
+	entry = malloc(sizeof(*entry) + len + 1);
+	if (!entry)
+		return NULL;
+
+	if (prefix_len) {
+		memcpy(entry->name, prefix, prefix_len);
+		entry->name[prefix_len] = '/';
+		memcpy(entry->name + prefix_len + 1, name, name_len);
+	} else {
+		memcpy(entry->name, name, name_len);
+	}
+	entry->name[len] = '\0';
+
+	return entry;
+}
+
+static void tarfs_free_entries(struct tarfs_entry *entry)
+{
+	struct tarfs_entry *next;
+
+	for (; entry; entry = next) {
+		next = entry->next;
+		free(entry);
+	}
+}
+
+/*
+ * Walk the archive once, collecting entries in archive order. Returns the
+ * number of entries indexed, or < 0.
+ */
+static int tarfs_scan(tarfs_t *tar, struct tarfs_entry **list)
+{
+	uint8_t blkbuf[TAR_BLOCK_SIZE];
+	const struct posix_header *hd;
+	struct tarfs_entry *entry, **tail = list;
+	char longname[256];
+	bool have_longname = false;
+	off_t offset = 0;
+	off_t end = tar->dev->size;
+	uint64_t size;
+	int count = 0;
+
+	*list = NULL;
+
+	while (offset + TAR_BLOCK_SIZE <= end) {
+		hd = tarfs_header(tar, offset, blkbuf);
+		if (!hd)
+			goto err;
+
+		/* a zero block or anything but a ustar header ends the archive */
+		if (memcmp(hd->magic, TMAGIC, TMAGLEN - 1))
+			break;
+
+		size = tar_header_size(hd);
+		offset += TAR_BLOCK_SIZE;
+		if (size > (uint64_t)(end - offset)) {
+			dprintf(CRITICAL, "tarfs: truncated archive\n");
+			goto err;
+		}
+
+		if (hd->typeflag == TAR_TYPE_LONGNAME) {
+			size_t len = MIN(size, sizeof(longname) - 1);
+
+			if (tarfs_read(tar, longname, offset, len) < 0)
+				goto err;
+			longname[len] = '\0';
+			have_longname = true;
+		} else if (hd->typeflag == TAR_TYPE_REG || hd->typeflag == TAR_TYPE_AREG ||
+				hd->typeflag == TAR_TYPE_DIR) {
+			const char *name, *prefix = hd->prefix;
+			size_t name_len, prefix_len;
+
+			if (have_longname) {
+				name = tarfs_trim(longname, sizeof(longname), &name_len);
+				prefix_len = 0;
+			} else {
+				name = tarfs_trim(hd->name, sizeof(hd->name), &name_len);
+				prefix = tarfs_trim(hd->prefix, sizeof(hd->prefix), &prefix_len);
+			}
+
+			if (name_len) {
+				entry = tarfs_new_entry(prefix, prefix_len, name, name_len);
+				if (!entry)
+					goto err;
+
+				entry->offset = offset;
+				entry->size = size;
+				entry->is_dir = hd->typeflag == TAR_TYPE_DIR;
+				entry->next = NULL;
+				*tail = entry;
+				tail = &entry->next;
+				count++;
+			}
+			have_longname = false;
+		} else {
+			/* links, devices, pax headers: not served */
+			have_longname = false;
+		}
+
+		offset += ROUNDUP(size, TAR_BLOCK_SIZE);
+	}
+
+	return count;
+
+err:
+	tarfs_free_entries(*list);
+	*list = NULL;
+	return ERR_IO;
+}
+
+int tarfs_mount(bdev_t *dev, fscookie *cookie)
+{
+	struct tarfs_entry *list, *entry, *next, **bucket;
+	void *base = NULL;
+	tarfs_t *tar;
+	int count;
+
+	tar = calloc(1, sizeof(*tar));
+	if (!tar)
+		return ERR_NO_MEMORY;
+
+	tar->dev = dev;
+	if (bio_ioctl(dev, BIO_IOCTL_GET_MEM_MAP, &base) == NO_ERROR)
+		tar->base = base;
+
+	count = tarfs_scan(tar, &list);
+	if (count <= 0) {
+		free(tar);
+		return count < 0 ? count : ERR_NOT_VALID;
+	}
+
+	for (tar->hash_size = 16; tar->hash_size < (uint)count; tar->hash_size <<= 1)
+		;
+	tar->hash = calloc(tar->hash_size, sizeof(*tar->hash));
+	if (!tar->hash) {
+		tarfs_free_entries(list);
+		free(tar);
+		return ERR_NO_MEMORY;
+	}
+
+	/* later entries push earlier ones of the same name down the chain */
+	for (entry = list; entry; entry = next) {
+		next = entry->next;
+		bucket = &tar->hash[tarfs_hash(entry->name) & (tar->hash_size - 1)];
+		entry->next = *bucket;
+		*bucket = entry;
+	}
+
+	tar->count = count;
+	tar->root.is_dir = true;
+
+	LTRACEF("%u entries, %s\n", tar->count, tar->base ? "memory mapped" : "block io");
+
+	*cookie = (fscookie)tar;
+
+	return 0;
+}
+
+int tarfs_unmount(fscookie cookie)
+{
+	tarfs_t *tar = (tarfs_t *)cookie;
+	uint i;
+
+	for (i = 0; i < tar->hash_size; i++)
+		tarfs_free_entries(tar->hash[i]);
+
+	free(tar->hash);
+	free(tar);
+
+	return 0;
+}
+
+int tarfs_open_file(fscookie cookie, const char *path, filecookie *fcookie)
+{
+	tarfs_t *tar = (tarfs_t *)cookie;
+	struct tarfs_entry *entry;
+	tarfs_file_t *file;
+
+	entry = tarfs_lookup(tar, path);
+	if (!entry)
+		return ERR_NOT_FOUND;
+
+	file = malloc(sizeof(tarfs_file_t));
+	if (!file)
+		return ERR_NO_MEMORY;
+
+	/* the index outlives every open file, the mount is refcounted */
+	file->tar = tar;
+	file->entry = entry;
+	*fcookie = file;
+
+	return 0;
+}
+
+int tarfs_read_file(filecookie fcookie, void *buf, off_t offset, size_t len)
+{
+	tarfs_file_t *file = (tarfs_file_t *)fcookie;
+	struct tarfs_entry *entry = file->entry;
+
+	if (entry->is_dir)
+		return ERR_NOT_FILE;
+
+	if (offset < 0)
+		return ERR_INVALID_ARGS;
+	if (offset >= entry->size)
+		return 0;
+	if (len > (size_t)(entry->size - offset))
+		len = entry->size - offset;
+
+	return tarfs_read(file->tar, buf, entry->offset + offset, len);
+}
+
+int tarfs_close_file(filecookie fcookie)
+{
+	free(fcookie);
+
+	return 0;
+}
+
+int tarfs_stat_file(filecookie fcookie, struct file_stat *stat)
+{
+	tarfs_file_t *file = (tarfs_file_t *)fcookie;
+	struct tarfs_entry *entry = file->entry;
+
+	stat->is_dir = entry->is_dir;
+	stat->size = entry->is_dir ? 0 : entry->size;
+
+	return 0;
+}
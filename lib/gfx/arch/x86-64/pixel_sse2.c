@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2015 Travis Geiselbrecht
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <emmintrin.h>
+#include <compiler.h>
+#include <kernel/thread.h>
+#include "../../pixel_priv.h"
+
+/*
+ * SSE2 pixel kernels. SSE2 is part of the x86-64 baseline so no feature
+ * check is needed, arch_early_init turns on CR4.OSFXSR. Counts are a non
+ * zero multiple of 16 pixels (64 bytes for gfx_arch_copy), pixel.c deals
+ * with the rest.
+ *
+ * The x86-64 context switch does not save the xmm registers. Each kernel
+ * runs out of line with interrupts masked and puts back the sse state it
+ * found, so neither the thread it interrupted nor any other sees a change.
+ */
+
+struct sse_state {
+	uint8_t area[512];
+} __ALIGNED(16);
+
+#define SSE2_CALL(call) do { \
+	struct sse_state state; \
+	enter_critical_section(); \
+	__asm__ volatile("fxsave %0" : "=m" (state)); \
+	call; \
+	__asm__ volatile("fxrstor %0" : : "m" (state)); \
+	exit_critical_section(); \
+} while (0)
+
+static __NO_INLINE void sse2_fill16(uint16_t *dst, uint32_t color, size_t count)
+{
+	__m128i v = _mm_set1_epi16(color);
+
+	for (; count; count -= 16, dst += 16) {
+		_mm_storeu_si128((__m128i *)dst, v);
+		_mm_storeu_si128((__m128i *)(dst + 8), v);
+	}
+}
+
+static __NO_INLINE void sse2_fill32(uint32_t *dst, uint32_t color, size_t count)
+{
+	__m128i v = _mm_set1_epi32(color);
+
+	for (; count; count -= 16, dst += 16) {
+		_mm_storeu_si128((__m128i *)dst, v);
+		_mm_storeu_si128((__m128i *)(dst + 4), v);
+		_mm_storeu_si128((__m128i *)(dst + 8), v);
+		_mm_storeu_si128((__m128i *)(dst + 12), v);
+	}
+}
+
+static __NO_INLINE void sse2_copy(void *dst, const void *src, size_t len)
+{
+	__m128i *d = dst;
+	const __m128i *s = src;
+
+	for (; len; len -= 64, d += 4, s += 4) {
+		__m128i v0 = _mm_loadu_si128(s);
+		__m128i v1 = _mm_loadu_si128(s + 1);
+		__m128i v2 = _mm_loadu_si128(s + 2);
+		__m128i v3 = _mm_loadu_si128(s + 3);
+
+		_mm_storeu_si128(d, v0);
+		_mm_storeu_si128(d + 1, v1);
+		_mm_storeu_si128(d + 2, v2);
+		_mm_storeu_si128(d + 3, v3);
+	}
+}
+
+/* (c * a) / 256 on 16 bit lanes, a holds one factor per pixel */
+static inline __m128i blend_scale(__m128i c, __m128i a)
+{
+	return _mm_srli_epi16(_mm_mullo_epi16(c, a), 8);
+}
+
+/* bit exact with alpha32_add_ignore_destalpha() */
+static inline __m128i blend4(__m128i d, __m128i s)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i sa = _mm_srli_epi32(s, 24);
+	__m128i a = _mm_add_epi32(sa, _mm_set1_epi32(1));
+	__m128i ainv = _mm_sub_epi32(_mm_set1_epi32(255), a);
+
+	/* replicate the per pixel factors into each 16 bit channel lane */
+	a = _mm_or_si128(a, _mm_slli_epi32(a, 16));
+	ainv = _mm_or_si128(ainv, _mm_slli_epi32(ainv, 16));
+
+	__m128i lo = _mm_add_epi16(
+		blend_scale(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi32(a, a)),
+		blend_scale(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi32(ainv, ainv)));
+	__m128i hi = _mm_add_epi16(
+		blend_scale(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi32(a, a)),
+		blend_scale(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi32(ainv, ainv)));
+	__m128i res = _mm_packus_epi16(lo, hi);
+
+	/* alpha becomes sa + 1 */
+	res = _mm_or_si128(_mm_and_si128(res, _mm_set1_epi32(0x00ffffff)),
+		_mm_slli_epi32(_mm_add_epi32(sa, _mm_set1_epi32(1)), 24));
+
+	/* fully transparent and fully opaque pixels pass through */
+	__m128i take_dst = _mm_cmpeq_epi32(sa, zero);
+	__m128i take_src = _mm_cmpeq_epi32(sa, _mm_set1_epi32(255));
+	res = _mm_or_si128(_mm_and_si128(take_dst, d), _mm_andnot_si128(take_dst, res));
+	res = _mm_or_si128(_mm_and_si128(take_src, s), _mm_andnot_si128(take_src, res));
+
+	return res;
+}
+
+static __NO_INLINE void sse2_blend32(uint32_t *dst, const uint32_t *src, size_t count)
+{
+	for (; count; count -= 4, dst += 4, src += 4) {
+		__m128i d = _mm_loadu_si128((const __m128i *)dst);
+		__m128i s = _mm_loadu_si128((const __m128i *)src);
+
+		_mm_storeu_si128((__m128i *)dst, blend4(d, s));
+	}
+}
+
+/*
+ * Swap bytes 0 and 2 of each 3 byte pixel over 48 byte (16 pixel) groups.
+ * Every byte either stays put or comes from two bytes to the left or
+ * right, the shifted copies borrow the edge bytes of the neighbouring
+ * vector. The pixel phase of each vector differs since 16 % 3 == 1.
+ */
+#define SWZ(a, b, c) \
+	_mm_setr_epi8(a, b, c, a, b, c, a, b, c, a, b, c, a, b, c, a)
+
+static __NO_INLINE void sse2_swizzle_rgb888(uint8_t *dst, const uint8_t *src, size_t count)
+{
+	const __m128i keep0 = SWZ(0, -1, 0), right0 = SWZ(-1, 0, 0), left0 = SWZ(0, 0, -1);
+	const __m128i keep1 = SWZ(-1, 0, 0), right1 = SWZ(0, 0, -1), left1 = SWZ(0, -1, 0);
+	const __m128i keep2 = SWZ(0, 0, -1), right2 = SWZ(0, -1, 0), left2 = SWZ(-1, 0, 0);
+
+	for (; count; count -= 16, dst += 48, src += 48) {
+		__m128i v0 = _mm_loadu_si128((const __m128i *)src);
+		__m128i v1 = _mm_loadu_si128((const __m128i *)(src + 16));
+		__m128i v2 = _mm_loadu_si128((const __m128i *)(src + 32));
+
+		__m128i r0 = _mm_or_si128(_mm_srli_si128(v0, 2), _mm_slli_si128(v1, 14));
+		__m128i r1 = _mm_or_si128(_mm_srli_si128(v1, 2), _mm_slli_si128(v2, 14));
+		__m128i r2 = _mm_srli_si128(v2, 2);
+		__m128i l0 = _mm_slli_si128(v0, 2);
+		__m128i l1 = _mm_or_si128(_mm_slli_si128(v1, 2), _mm_srli_si128(v0, 14));
+		__m128i l2 = _mm_or_si128(_mm_slli_si128(v2, 2), _mm_srli_si128(v1, 14));
+
+		v0 = _mm_or_si128(_mm_and_si128(v0, keep0),
+			_mm_or_si128(_mm_and_si128(r0, right0), _mm_and_si128(l0, left0)));
+		v1 = _mm_or_si128(_mm_and_si128(v1, keep1),
+			_mm_or_si128(_mm_and_si128(r1, right1), _mm_and_si128(l1, left1)));
+		v2 = _mm_or_si128(_mm_and_si128(v2, keep2),
+			_mm_or_si128(_mm_and_si128(r2, right2), _mm_and_si128(l2, left2)));
+
+		_mm_storeu_si128((__m128i *)dst, v0);
+		_mm_storeu_si128((__m128i *)(dst + 16), v1);
+		_mm_storeu_si128((__m128i *)(dst + 32), v2);
+	}
+}
+
+static inline __m128i rgb565_4(__m128i p)
+{
+	__m128i v = _mm_or_si128(
+		_mm_and_si128(_mm_srli_epi32(p, 3), _mm_set1_epi32(0x001f)),
+		_mm_or_si128(
+			_mm_and_si128(_mm_srli_epi32(p, 5), _mm_set1_epi32(0x07e0)),
+			_mm_and_si128(_mm_srli_epi32(p, 8), _mm_set1_epi32(0xf800))));
+
+	/* sign extend so the saturating pack keeps all 16 bits */
+	return _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+}
+
+static __NO_INLINE void sse2_convert_8888_to_565(uint16_t *dst, const uint32_t *src, size_t count)
+{
+	for (; count; count -= 8, dst += 8, src += 8) {
+		__m128i lo = rgb565_4(_mm_loadu_si128((const __m128i *)src));
+		__m128i hi = rgb565_4(_mm_loadu_si128((const __m128i *)(src + 4)));
+
+		_mm_storeu_si128((__m128i *)dst, _mm_packs_epi32(lo, hi));
+	}
+}
+
+void gfx_arch_fill16(uint16_t *dst, uint32_t color, size_t count)
+{
+	SSE2_CALL(sse2_fill16(dst, color, count));
+}
+
+void gfx_arch_fill32(uint32_t *dst, uint32_t color, size_t count)
+{
+	SSE2_CALL(sse2_fill32(dst, color, count));
+}
+
+void gfx_arch_copy(void *dst, const void *src, size_t len)
+{
+	SSE2_CALL(sse2_copy(dst, src, len));
+}
+
+void gfx_arch_blend32(uint32_t *dst, const uint32_t *src, size_t count)
+{
+	SSE2_CALL(sse2_blend32(dst, src, count));
+}
+
+void gfx_arch_swizzle_rgb888(uint8_t *dst, const uint8_t *src, size_t count)
+{
+	SSE2_CALL(sse2_swizzle_rgb888(dst, src, count));
+}
+
+void gfx_arch_convert_8888_to_565(uint16_t *dst, const uint32_t *src, size_t count)
+{
+	SSE2_CALL(sse2_convert_8888_to_565(dst, src, count));
+}
@@ -140,38 +140,29 @@ static void putpixel32(gfx_surface *surface, uint x, uint y, uint color)
 	*dest = color;
 }
 
-static void copyrect16(gfx_surface *surface, uint x, uint y, uint width, uint height, uint x2, uint y2)
+static void copyrect(gfx_surface *surface, uint x, uint y, uint width, uint height, uint x2, uint y2)
 {
-	// copy
-	const uint16_t *src = &((const uint16_t *)surface->ptr)[x + y * surface->stride];
-	uint16_t *dest = &((uint16_t *)surface->ptr)[x2 + y2 * surface->stride];
-	uint stride_diff = surface->stride - width;
-
-	if (dest < src) {
-		uint i, j;
+	uint8_t *base = surface->ptr;
+	size_t pitch = surface->stride * surface->pixelsize;
+	size_t len = width * surface->pixelsize;
+	const uint8_t *src = base + x * surface->pixelsize + y * pitch;
+	uint8_t *dest = base + x2 * surface->pixelsize + y2 * pitch;
+	uint i;
+
+	if (dest <= src) {
 		for (i=0; i < height; i++) {
-			for (j=0; j < width; j++) {
-				*dest = *src;
-				dest++;
-				src++;
-			}
-			dest += stride_diff;
-			src += stride_diff;
+			gfx_copy_pixels(dest, src, len);
+			dest += pitch;
+			src += pitch;
 		}
 	} else {
-		// copy backwards
-		src += height * surface->stride + width;
-		dest += height * surface->stride + width;
-
-		uint i, j;
+		// copy backwards so overlapping rows are read before they are overwritten
+		src += (height - 1) * pitch;
+		dest += (height - 1) * pitch;
 		for (i=0; i < height; i++) {
-			for (j=0; j < width; j++) {
-				*dest = *src;
-				dest--;
-				src--;
-			}
-			dest -= stride_diff;
-			src -= stride_diff;
+			gfx_copy_pixels(dest, src, len);
+			dest -= pitch;
+			src -= pitch;
 		}
 	}
 }
@@ -179,117 +170,35 @@ static void copyrect16(gfx_surface *surface, uint x, uint y, uint width, uint he
 static void fillrect16(gfx_surface *surface, uint x, uint y, uint width, uint height, uint color)
 {
 	uint16_t *dest = &((uint16_t *)surface->ptr)[x + y * surface->stride];
-	uint stride_diff = surface->stride - width;
 
 	uint16_t color16 = ARGB8888_to_RGB565(color);
 
-	uint i, j;
+	uint i;
 	for (i=0; i < height; i++) {
-		for (j=0; j < width; j++) {
-			*dest = color16;
-			dest++;
-		}
-		dest += stride_diff;
-	}
-}
-
-static void copyrect32(gfx_surface *surface, uint x, uint y, uint width, uint height, uint x2, uint y2)
-{
-	// copy
-	const uint32_t *src = &((const uint32_t *)surface->ptr)[x + y * surface->stride];
-	uint32_t *dest = &((uint32_t *)surface->ptr)[x2 + y2 * surface->stride];
-	uint stride_diff = surface->stride - width;
-
-	if (dest < src) {
-		uint i, j;
-		for (i=0; i < height; i++) {
-			for (j=0; j < width; j++) {
-				*dest = *src;
-				dest++;
-				src++;
-			}
-			dest += stride_diff;
-			src += stride_diff;
-		}
-	} else {
-		// copy backwards
-		src += height * surface->stride + width;
-		dest += height * surface->stride + width;
-
-		uint i, j;
-		for (i=0; i < height; i++) {
-			for (j=0; j < width; j++) {
-				*dest = *src;
-				dest--;
-				src--;
-			}
-			dest -= stride_diff;
-			src -= stride_diff;
-		}
+		gfx_fill16(dest, color16, width);
+		dest += surface->stride;
 	}
 }
 
 static void fillrect32(gfx_surface *surface, uint x, uint y, uint width, uint height, uint color)
 {
 	uint32_t *dest = &((uint32_t *)surface->ptr)[x + y * surface->stride];
-	uint stride_diff = surface->stride - width;
 
-	uint i, j;
+	uint i;
 	for (i=0; i < height; i++) {
-		for (j=0; j < width; j++) {
-			*dest = color;
-			dest++;
-		}
-		dest += stride_diff;
+		gfx_fill32(dest, color, width);
+		dest += surface->stride;
 	}
 }
 
-uint32_t alpha32_add_ignore_destalpha(uint32_t dest, uint32_t src)
-{
-	uint32_t cdest[3];
-	uint32_t csrc[3];
-
-	uint32_t srca;
-	uint32_t srcainv;
-
-	srca = (src >> 24) & 0xff;
-	if (srca == 0) {
-		return dest;
-	} else if (srca == 255) {
-		return src;
-	}
-	srca++;
-	srcainv = (255 - srca);
-
-	cdest[0] = (dest >> 16) & 0xff;
-	cdest[1] = (dest >> 8) & 0xff;
-	cdest[2] = (dest >> 0) & 0xff;
-
-	csrc[0] = (src >> 16) & 0xff;
-	csrc[1] = (src >> 8) & 0xff;
-	csrc[2] = (src >> 0) & 0xff;
-
-//	if (srca > 0)
-//		printf("s %d %d %d d %d %d %d a %d ai %d\n", csrc[0], csrc[1], csrc[2], cdest[0], cdest[1], cdest[2], srca, srcainv);
-
-	uint32_t cres[3];
-
-	cres[0] = ((csrc[0] * srca) / 256) + ((cdest[0] * srcainv) / 256);
-	cres[1] = ((csrc[1] * srca) / 256) + ((cdest[1] * srcainv) / 256);
-	cres[2] = ((csrc[2] * srca) / 256) + ((cdest[2] * srcainv) / 256);
-
-	return (srca << 24) | (cres[0] << 16) | (cres[1] << 8) | (cres[2]);
-}
-
 /**
  * @brief  Copy pixels from source to dest.
  *
- * Currently does not support alpha channel.
+ * ARGB8888 sources are alpha blended onto ARGB8888 targets, 32 bit sources
+ * are flattened when the target is RGB565.
  */
 void gfx_surface_blend(struct gfx_surface *target, struct gfx_surface *source, uint destx, uint desty)
 {
-	DEBUG_ASSERT(target->format == source->format);
-
 	LTRACEF("target %p, source %p, destx %u, desty %u\n", target, source, destx, desty);
 
 	if (destx >= target->width)
@@ -305,64 +214,35 @@ void gfx_surface_blend(struct gfx_surface *target, struct gfx_surface *source, u
 	if (desty + height > target->height)
 		height = target->height - desty;
 
-	// XXX total hack to deal with various blends
-	if (source->format == GFX_FORMAT_RGB_565 && target->format == GFX_FORMAT_RGB_565) {
-		// 16 bit to 16 bit
-		const uint16_t *src = (const uint16_t *)source->ptr;
-		uint16_t *dest = &((uint16_t *)target->ptr)[destx + desty * target->stride];
-		uint dest_stride_diff = target->stride - width;
-		uint source_stride_diff = source->stride - width;
+	const uint8_t *src = source->ptr;
+	uint8_t *dest = (uint8_t *)target->ptr + (destx + desty * target->stride) * target->pixelsize;
+	size_t dest_pitch = target->stride * target->pixelsize;
+	size_t source_pitch = source->stride * source->pixelsize;
 
-		LTRACEF("w %u h %u dstride %u sstride %u\n", width, height, dest_stride_diff, source_stride_diff);
+	LTRACEF("w %u h %u dpitch %zu spitch %zu\n", width, height, dest_pitch, source_pitch);
 
-		uint i, j;
+	uint i;
+	if (source->format == target->format && source->format != GFX_FORMAT_ARGB_8888) {
+		// same layout and no alpha, straight copy
 		for (i=0; i < height; i++) {
-			for (j=0; j < width; j++) {
-				*dest = *src;
-				dest++;
-				src++;
-			}
-			dest += dest_stride_diff;
-			src += source_stride_diff;
+			gfx_copy_pixels(dest, src, width * target->pixelsize);
+			dest += dest_pitch;
+			src += source_pitch;
 		}
 	} else if (source->format == GFX_FORMAT_ARGB_8888 && target->format == GFX_FORMAT_ARGB_8888) {
 		// both are 32 bit modes, both alpha
-		const uint32_t *src = (const uint32_t *)source->ptr;
-		uint32_t *dest = &((uint32_t *)target->ptr)[destx + desty * target->stride];
-		uint dest_stride_diff = target->stride - width;
-		uint source_stride_diff = source->stride - width;
-
-		LTRACEF("w %u h %u dstride %u sstride %u\n", width, height, dest_stride_diff, source_stride_diff);
-
-		uint i, j;
 		for (i=0; i < height; i++) {
-			for (j=0; j < width; j++) {
-				// XXX ignores destination alpha
-				*dest = alpha32_add_ignore_destalpha(*dest, *src);
-				dest++;
-				src++;
-			}
-			dest += dest_stride_diff;
-			src += source_stride_diff;
+			// XXX ignores destination alpha
+			gfx_blend32((uint32_t *)dest, (const uint32_t *)src, width);
+			dest += dest_pitch;
+			src += source_pitch;
 		}
-	} else if (source->format == GFX_FORMAT_RGB_x888 && target->format == GFX_FORMAT_RGB_x888) {
-		// both are 32 bit modes, no alpha
-		const uint32_t *src = (const uint32_t *)source->ptr;
-		uint32_t *dest = &((uint32_t *)target->ptr)[destx + desty * target->stride];
-		uint dest_stride_diff = target->stride - width;
-		uint source_stride_diff = source->stride - width;
-
-		LTRACEF("w %u h %u dstride %u sstride %u\n", width, height, dest_stride_diff, source_stride_diff);
-
-		uint i, j;
+	} else if (source->pixelsize == 4 && target->format == GFX_FORMAT_RGB_565) {
+		// flatten 32 bit sources, alpha is dropped
 		for (i=0; i < height; i++) {
-			for (j=0; j < width; j++) {
-				*dest = *src;
-				dest++;
-				src++;
-			}
-			dest += dest_stride_diff;
-			src += source_stride_diff;
+			gfx_convert_8888_to_565((uint16_t *)dest, (const uint32_t *)src, width);
+			dest += dest_pitch;
+			src += source_pitch;
 		}
 	} else {
 		panic("gfx_surface_blend: unimplemented colorspace combination (source %d target %d)\n", source->format, target->format);
@@ -426,7 +306,7 @@ gfx_surface *gfx_create_surface(void *ptr, uint width, uint height, uint stride,
 	// set up some function pointers
 	switch (format) {
 		case GFX_FORMAT_RGB_565:
-			surface->copyrect = &copyrect16;
+			surface->copyrect = &copyrect;
 			surface->fillrect = &fillrect16;
 			surface->putpixel = &putpixel16;
 			surface->pixelsize = 2;
@@ -434,7 +314,7 @@ gfx_surface *gfx_create_surface(void *ptr, uint width, uint height, uint stride,
 			break;
 		case GFX_FORMAT_RGB_x888:
 		case GFX_FORMAT_ARGB_8888:
-			surface->copyrect = &copyrect32;
+			surface->copyrect = &copyrect;
 			surface->fillrect = &fillrect32;
 			surface->putpixel = &putpixel32;
 			surface->pixelsize = 4;
@@ -540,6 +420,8 @@ void gfx_draw_pattern_white(void)
 
 #if LK_DEBUGLEVEL > 1
 #include <lib/console.h>
+#include <platform.h>
+#include <arch/defines.h>
 
 static int cmd_gfx(int argc, const cmd_args *argv);
 
@@ -577,12 +459,65 @@ static int gfx_draw_rgb_bars(gfx_surface *surface)
 }
 
 
+static void gfx_bench_report(const char *name, size_t pixels, uint iter, lk_bigtime_t usecs)
+{
+	// pixels per microsecond is megapixels per second, keep one decimal
+	uint64_t mpps10 = usecs ? (uint64_t)pixels * iter * 10 / usecs : 0;
+
+	printf("%-12s %6llu.%llu MP/s\n", name,
+		(unsigned long long)(mpps10 / 10), (unsigned long long)(mpps10 % 10));
+}
+
+#define GFX_BENCH(name, pixels, iter, op) \
+	do { \
+		uint _i; \
+		lk_bigtime_t _t = current_time_hires(); \
+		for (_i = 0; _i < (iter); _i++) \
+			op; \
+		gfx_bench_report(name, pixels, iter, current_time_hires() - _t); \
+	} while (0)
+
+static int gfx_bench(uint width, uint height)
+{
+	const uint iter = 10;
+	size_t pixels = width * height;
+	uint32_t *a = memalign(CACHE_LINE, pixels * 4);
+	uint32_t *b = memalign(CACHE_LINE, pixels * 4);
+	size_t i;
+
+	if (!a || !b) {
+		printf("not enough memory for a %ux%u benchmark\n", width, height);
+		free(a);
+		free(b);
+		return -1;
+	}
+
+	for (i = 0; i < pixels; i++) {
+		a[i] = (i * 0x01010101) ^ (i << 24);
+		b[i] = ~a[i];
+	}
+
+	printf("%ux%u, %u iterations\n", width, height, iter);
+	GFX_BENCH("fill16", pixels, iter, gfx_fill16((uint16_t *)a, 0x1234, pixels));
+	GFX_BENCH("fill32", pixels, iter, gfx_fill32(a, 0x12345678, pixels));
+	GFX_BENCH("copy32", pixels, iter, gfx_copy_pixels(b, a, pixels * 4));
+	GFX_BENCH("blend32", pixels, iter, gfx_blend32(b, a, pixels));
+	GFX_BENCH("swizzle888", pixels, iter, gfx_swizzle_rgb888((uint8_t *)b, (const uint8_t *)b, pixels));
+	GFX_BENCH("8888to565", pixels, iter, gfx_convert_8888_to_565((uint16_t *)b, a, pixels));
+
+	free(a);
+	free(b);
+
+	return 0;
+}
+
 static int cmd_gfx(int argc, const cmd_args *argv)
 {
 	if (argc < 2) {
 		printf("not enough arguments:\n");
 		printf("%s rgb_bars		: Fill frame buffer with rgb bars\n", argv[0].str);
 		printf("%s fill r g b	: Fill frame buffer with RGB565 value and force update\n", argv[0].str);
+		printf("%s bench [w h]	: Measure the pixel kernels, defaults to the display size\n", argv[0].str);
 
 		return -1;
 	}
@@ -590,6 +525,12 @@ static int cmd_gfx(int argc, const cmd_args *argv)
 	struct display_info info;
 	display_get_info(&info);
 
+	if (!strcmp(argv[1].str, "bench")) {
+		if (argc >= 4)
+			return gfx_bench(argv[2].u, argv[3].u);
+		return gfx_bench(info.width, info.height);
+	}
+
 	gfx_surface *surface = gfx_create_surface_from_display(&info);
 
 	if (!strcmp(argv[1].str, "rgb_bars")) {
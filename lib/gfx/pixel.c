@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2015 Travis Geiselbrecht
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file
+ * @brief  Pixel span kernels used by the graphics library
+ *
+ * @ingroup graphics
+ */
+
+#include <debug.h>
+#include <string.h>
+#include <lib/gfx.h>
+#include "pixel_priv.h"
+
+#define ARCH_BLOCKS(count) ((count) & ~(size_t)(GFX_ARCH_PIXEL_BLOCK - 1))
+
+uint32_t alpha32_add_ignore_destalpha(uint32_t dest, uint32_t src)
+{
+	uint32_t cdest[3];
+	uint32_t csrc[3];
+
+	uint32_t srca;
+	uint32_t srcainv;
+
+	srca = (src >> 24) & 0xff;
+	if (srca == 0) {
+		return dest;
+	} else if (srca == 255) {
+		return src;
+	}
+	srca++;
+	srcainv = (255 - srca);
+
+	cdest[0] = (dest >> 16) & 0xff;
+	cdest[1] = (dest >> 8) & 0xff;
+	cdest[2] = (dest >> 0) & 0xff;
+
+	csrc[0] = (src >> 16) & 0xff;
+	csrc[1] = (src >> 8) & 0xff;
+	csrc[2] = (src >> 0) & 0xff;
+
+	uint32_t cres[3];
+
+	cres[0] = ((csrc[0] * srca) / 256) + ((cdest[0] * srcainv) / 256);
+	cres[1] = ((csrc[1] * srca) / 256) + ((cdest[1] * srcainv) / 256);
+	cres[2] = ((csrc[2] * srca) / 256) + ((cdest[2] * srcainv) / 256);
+
+	return (srca << 24) | (cres[0] << 16) | (cres[1] << 8) | (cres[2]);
+}
+
+/**
+ * @brief  Fill count 16 bit pixels with color.
+ */
+void gfx_fill16(uint16_t *dst, uint16_t color, size_t count)
+{
+#if GFX_ARCH_PIXEL_OPS
+	size_t bulk = ARCH_BLOCKS(count);
+
+	if (bulk) {
+		gfx_arch_fill16(dst, color, bulk);
+		dst += bulk;
+		count -= bulk;
+	}
+#endif
+	while (count--)
+		*dst++ = color;
+}
+
+/**
+ * @brief  Fill count 32 bit pixels with color.
+ */
+void gfx_fill32(uint32_t *dst, uint32_t color, size_t count)
+{
+#if GFX_ARCH_PIXEL_OPS
+	size_t bulk = ARCH_BLOCKS(count);
+
+	if (bulk) {
+		gfx_arch_fill32(dst, color, bulk);
+		dst += bulk;
+		count -= bulk;
+	}
+#endif
+	while (count--)
+		*dst++ = color;
+}
+
+/**
+ * @brief  Copy len bytes of pixels, the spans may overlap.
+ */
+void gfx_copy_pixels(void *dst, const void *src, size_t len)
+{
+#if GFX_ARCH_PIXEL_OPS
+	/* the arch copy runs forwards in blocks, only use it when that is safe */
+	if ((uint8_t *)dst + GFX_ARCH_COPY_BLOCK <= (const uint8_t *)src ||
+		(const uint8_t *)src + len <= (uint8_t *)dst) {
+		size_t bulk = len & ~(size_t)(GFX_ARCH_COPY_BLOCK - 1);
+
+		if (bulk) {
+			gfx_arch_copy(dst, src, bulk);
+			dst = (uint8_t *)dst + bulk;
+			src = (const uint8_t *)src + bulk;
+			len -= bulk;
+		}
+	}
+#endif
+	memmove(dst, src, len);
+}
+
+/**
+ * @brief  Alpha blend count ARGB8888 pixels from src over dst.
+ *
+ * Same rules as alpha32_add_ignore_destalpha().
+ */
+void gfx_blend32(uint32_t *dst, const uint32_t *src, size_t count)
+{
+#if GFX_ARCH_PIXEL_OPS
+	size_t bulk = ARCH_BLOCKS(count);
+
+	if (bulk) {
+		gfx_arch_blend32(dst, src, bulk);
+		dst += bulk;
+		src += bulk;
+		count -= bulk;
+	}
+#endif
+	while (count--) {
+		*dst = alpha32_add_ignore_destalpha(*dst, *src);
+		dst++;
+		src++;
+	}
+}
+
+/**
+ * @brief  Convert count packed 24 bit pixels between RGB888 and BGR888.
+ *
+ * dst may be the same buffer as src.
+ */
+void gfx_swizzle_rgb888(uint8_t *dst, const uint8_t *src, size_t count)
+{
+#if GFX_ARCH_PIXEL_OPS
+	size_t bulk = ARCH_BLOCKS(count);
+
+	if (bulk) {
+		gfx_arch_swizzle_rgb888(dst, src, bulk);
+		dst += bulk * 3;
+		src += bulk * 3;
+		count -= bulk;
+	}
+#endif
+	while (count--) {
+		uint8_t t = src[0];
+
+		dst[0] = src[2];
+		dst[1] = src[1];
+		dst[2] = t;
+		dst += 3;
+		src += 3;
+	}
+}
+
+/**
+ * @brief  Convert count ARGB8888 pixels to RGB565.
+ */
+void gfx_convert_8888_to_565(uint16_t *dst, const uint32_t *src, size_t count)
+{
+#if GFX_ARCH_PIXEL_OPS
+	size_t bulk = ARCH_BLOCKS(count);
+
+	if (bulk) {
+		gfx_arch_convert_8888_to_565(dst, src, bulk);
+		dst += bulk;
+		src += bulk;
+		count -= bulk;
+	}
+#endif
+	while (count--) {
+		uint32_t in = *src++;
+
+		*dst++ = ((in >> 3) & 0x1f) | (((in >> 10) & 0x3f) << 5) |
+			(((in >> 19) & 0x1f) << 11);
+	}
+}
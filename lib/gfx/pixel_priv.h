@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2015 Travis Geiselbrecht
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef __LIB_GFX_PIXEL_PRIV_H
+#define __LIB_GFX_PIXEL_PRIV_H
+
+#include <sys/types.h>
+#include <inttypes.h>
+
+/*
+ * Optional arch kernels behind the gfx pixel routines. They only ever see
+ * whole blocks of GFX_ARCH_PIXEL_BLOCK pixels (GFX_ARCH_COPY_BLOCK bytes
+ * for copies), pixel.c handles the remainder in C.
+ */
+#if ARM_WITH_NEON
+#define GFX_ARCH_PIXEL_OPS 1
+#elif defined(__x86_64__)
+#define GFX_ARCH_PIXEL_OPS 1
+#else
+#define GFX_ARCH_PIXEL_OPS 0
+#endif
+
+#define GFX_ARCH_PIXEL_BLOCK 16
+#define GFX_ARCH_COPY_BLOCK 64
+
+#if GFX_ARCH_PIXEL_OPS
+void gfx_arch_fill16(uint16_t *dst, uint32_t color, size_t count);
+void gfx_arch_fill32(uint32_t *dst, uint32_t color, size_t count);
+void gfx_arch_copy(void *dst, const void *src, size_t len);
+void gfx_arch_blend32(uint32_t *dst, const uint32_t *src, size_t count);
+void gfx_arch_swizzle_rgb888(uint8_t *dst, const uint8_t *src, size_t count);
+void gfx_arch_convert_8888_to_565(uint16_t *dst, const uint32_t *src, size_t count);
+#endif
+
+#endif
@@ -3,6 +3,20 @@ LOCAL_DIR := $(GET_LOCAL_DIR)
 MODULE := $(LOCAL_DIR)
 
 MODULE_SRCS += \
-	$(LOCAL_DIR)/gfx.c
+	$(LOCAL_DIR)/gfx.c \
+	$(LOCAL_DIR)/pixel.c
+
+# arch pixel kernels, see pixel_priv.h
+ifeq ($(ARCH),arm)
+ifeq ($(SUBARCH),arm)
+MODULE_SRCS += \
+	$(LOCAL_DIR)/arch/arm/pixel_neon.S
+endif
+endif
+
+ifeq ($(ARCH),x86-64)
+MODULE_SRCS += \
+	$(LOCAL_DIR)/arch/x86-64/pixel_sse2.c
+endif
 
 include make/module.mk
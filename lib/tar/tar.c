@@ -12,6 +12,10 @@ static uint64_t str2number(const char *str, uint64_t size) {
   return ret;
 }
 
+uint64_t tar_header_size(const struct posix_header *hd) {
+	return str2number(hd->size, sizeof(hd->size));
+}
+
 int tar_get_fileinfo(struct tar_io *tio, const char *path, struct tar_fileinfo *fi) {
 	int ret, blkid = 0;
 	char blkbuf[tio->blksz];
@@ -33,7 +37,7 @@ int tar_get_fileinfo(struct tar_io *tio, const char *path, struct tar_fileinfo *
 		if(memcmp(hd->magic, TMAGIC, TMAGLEN-1)!=0)
 			break;
 
-		uint64_t size = str2number(hd->size, sizeof(hd->size));
+		uint64_t size = tar_header_size(hd);
 
 		// found :)
 		if(strcmp(hd->name, path)==0) {
@@ -21,4 +21,23 @@
  * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <debug.h>
+#include <platform/debug.h>
 
+/*
+ * default implementations of these routines, if the platform code
+ * chooses not to implement.
+ */
+__WEAK void platform_dputs(const char *str, size_t len)
+{
+	while (len--)
+		platform_dputc(*str++);
+}
+
+__WEAK void platform_panic_start(void)
+{
+}
+
+__WEAK void dlog_flush(void)
+{
+}
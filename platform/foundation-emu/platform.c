@@ -24,10 +24,27 @@
 #include <debug.h>
 #include <lib/heap.h>
 #include <platform.h>
+#include <arch/arm64/mmu.h>
 #include "platform_p.h"
 
+#define GB (1024ULL * 1024 * 1024)
+
+#define PERIPH_MEMORY   (MMU_MEMORY_TYPE_DEVICE | MMU_MEMORY_AP_READ_WRITE)
+#define RAM_MEMORY      (MMU_MEMORY_TYPE_NORMAL_WRITE_BACK | MMU_MEMORY_AP_READ_WRITE)
+
+static mmu_section_t mmu_section_table[] = {
+/*   Physical addr,    Virtual addr,     Size,    Flags */
+    {0x0,              0x0,              2 * GB,  PERIPH_MEMORY},
+    {MEMBASE,          MEMBASE,          MEMSIZE, RAM_MEMORY},
+    {0x880000000ULL,   0x880000000ULL,   6 * GB,  RAM_MEMORY},
+};
+
 void platform_init_mmu_mappings(void)
 {
+    uint i;
+
+    for (i = 0; i < countof(mmu_section_table); i++)
+        arm64_mmu_map_section(&mmu_section_table[i]);
 }
 
 void platform_early_init(void)
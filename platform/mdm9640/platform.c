@@ -47,10 +47,13 @@ extern struct smem_ram_ptable* target_smem_ram_ptable_init();
 #define MSM_IOMAP_SIZE                      ((MSM_IOMAP_END - MSM_IOMAP_BASE)/MB)
 
 /* LK memory - Strongly ordered, executable */
-#define LK_MEMORY                             (MMU_MEMORY_TYPE_NORMAL_WRITE_THROUGH | \
+#define LK_MEMORY                             (MMU_MEMORY_TYPE_NORMAL_LK | \
                                               MMU_MEMORY_AP_READ_WRITE)
 /* Scratch memory - Strongly ordered, non-executable */
-#define SCRATCH_MEMORY                        (MMU_MEMORY_TYPE_NORMAL_WRITE_THROUGH | \
+#define SCRATCH_MEMORY                        (MMU_MEMORY_TYPE_NORMAL_LK | \
+                                              MMU_MEMORY_AP_READ_WRITE | MMU_MEMORY_XN)
+/* Shared memory - other processors use it too, always write through */
+#define SHARED_MEMORY                         (MMU_MEMORY_TYPE_NORMAL_WRITE_THROUGH | \
                                               MMU_MEMORY_AP_READ_WRITE | MMU_MEMORY_XN)
 /* Peripherals - shared device */
 #define IOMAP_MEMORY                          (MMU_MEMORY_TYPE_DEVICE_SHARED | \
@@ -66,7 +69,7 @@ extern struct smem_ram_ptable* target_smem_ram_ptable_init();
  */
 mmu_section_t mmu_section_table[] = {
 /*   Physical addr,         Virtual addr,               Size (in MB),              Flags   */
-	{MSM_SHARED_BASE,       MSM_SHARED_BASE,            1,                         SCRATCH_MEMORY},
+	{MSM_SHARED_BASE,       MSM_SHARED_BASE,            1,                         SHARED_MEMORY},
 	{MEMBASE,               MEMBASE,                    MEMSIZE / MB,              LK_MEMORY},
 	{MSM_IOMAP_BASE,        MSM_IOMAP_BASE,             MSM_IOMAP_SIZE,            IOMAP_MEMORY},
 	{SCRATCH_REGION1,       SCRATCH_REGION1, SCRATCH_REGION1_SIZE / MB, SCRATCH_MEMORY},
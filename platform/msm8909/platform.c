@@ -40,8 +40,8 @@
 #define MSM_IOMAP_SIZE ((MSM_IOMAP_END - MSM_IOMAP_BASE)/MB)
 #define A7_SS_SIZE    ((A7_SS_END - A7_SS_BASE)/MB)
 
-/* LK memory - cacheable, write through */
-#define LK_MEMORY         (MMU_MEMORY_TYPE_NORMAL_WRITE_THROUGH | \
+/* LK memory - cacheable */
+#define LK_MEMORY         (MMU_MEMORY_TYPE_NORMAL_LK | \
                                         MMU_MEMORY_AP_READ_WRITE)
 
 /* Peripherals - non-shared device */
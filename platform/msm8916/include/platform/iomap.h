@@ -165,6 +165,7 @@
 #define REG_MDP(off)                (MDP_BASE + (off))
 #define MDP_HW_REV                              REG_MDP(0x1000)
 #define MDP_INTR_EN                             REG_MDP(0x1010)
+#define MDP_INTR_STATUS                         REG_MDP(0x1014)
 #define MDP_INTR_CLEAR                          REG_MDP(0x1018)
 #define MDP_HIST_INTR_EN                        REG_MDP(0x101C)
 #define MDP_VP_0_VIG_0_BASE                     REG_MDP(0x5000)
@@ -43,8 +43,8 @@
 #define MSM_IOMAP_SIZE ((MSM_IOMAP_END - MSM_IOMAP_BASE)/MB)
 #define A53_SS_SIZE    ((A53_SS_END - A53_SS_BASE)/MB)
 
-/* LK memory - cacheable, write through */
-#define LK_MEMORY         (MMU_MEMORY_TYPE_NORMAL_WRITE_THROUGH | \
+/* LK memory - cacheable */
+#define LK_MEMORY         (MMU_MEMORY_TYPE_NORMAL_LK | \
 					MMU_MEMORY_AP_READ_WRITE)
 
 /* Peripherals - non-shared device */
@@ -55,6 +55,19 @@
 #define COMMON_MEMORY       (MMU_MEMORY_TYPE_NORMAL_WRITE_THROUGH | \
                            MMU_MEMORY_AP_READ_WRITE | MMU_MEMORY_XN)
 
+/* Scratch memory - cacheable */
+#define SCRATCH_MEMORY      (MMU_MEMORY_TYPE_NORMAL_LK | \
+                           MMU_MEMORY_AP_READ_WRITE | MMU_MEMORY_XN)
+
+/* Display carve-out (MIPI_FB_ADDR) - scanned out by the MDP, write through */
+#define FB_MEMORY           (MMU_MEMORY_TYPE_NORMAL_WRITE_THROUGH | \
+                           MMU_MEMORY_AP_READ_WRITE | MMU_MEMORY_XN)
+
+/* MIPI_FB_ADDR and everything above it in the BASE_ADDR region, including
+ * the back buffer and the LOGO_IMG_OFFSET splash area */
+#define FB_OFFSET_MB        50
+#define FB_SIZE_MB          (90 - FB_OFFSET_MB)
+
 static mmu_section_t mmu_section_table[] = {
 /*           Physical addr,     Virtual addr,     Size (in MB),     Flags */
 	{    MEMBASE,           MEMBASE,          (MEMSIZE / MB),   LK_MEMORY},
@@ -62,9 +75,10 @@ static mmu_section_t mmu_section_table[] = {
 	{    A53_SS_BASE,       A53_SS_BASE,      A53_SS_SIZE,      IOMAP_MEMORY},
 	{    SYSTEM_IMEM_BASE,  SYSTEM_IMEM_BASE, 1,                COMMON_MEMORY},
 	{    MSM_SHARED_BASE,   MSM_SHARED_BASE,  1,                COMMON_MEMORY},
-	{    BASE_ADDR,         BASE_ADDR,        90,               COMMON_MEMORY},
-	{    SCRATCH_ADDR,      SCRATCH_ADDR,     256,              COMMON_MEMORY},
-	{    BASE_ADDR_1,       BASE_ADDR_1,     1024,              COMMON_MEMORY},
+	{    BASE_ADDR,         BASE_ADDR,        FB_OFFSET_MB,     SCRATCH_MEMORY},
+	{    BASE_ADDR + FB_OFFSET_MB * MB, BASE_ADDR + FB_OFFSET_MB * MB, FB_SIZE_MB, FB_MEMORY},
+	{    SCRATCH_ADDR,      SCRATCH_ADDR,     256,              SCRATCH_MEMORY},
+	{    BASE_ADDR_1,       BASE_ADDR_1,     1024,              SCRATCH_MEMORY},
 };
 
 
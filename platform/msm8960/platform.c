@@ -45,16 +45,16 @@ static uint32_t ticks_per_sec = 0;
 
 #define MSM_IOMAP_SIZE ((MSM_IOMAP_END - MSM_IOMAP_BASE)/MB)
 
-/* LK memory - cacheable, write through */
-#define LK_MEMORY         (MMU_MEMORY_TYPE_NORMAL_WRITE_THROUGH | \
+/* LK memory - cacheable */
+#define LK_MEMORY         (MMU_MEMORY_TYPE_NORMAL_LK | \
                            MMU_MEMORY_AP_READ_WRITE)
 
 /* Kernel region - cacheable, write through */
 #define KERNEL_MEMORY     (MMU_MEMORY_TYPE_NORMAL_WRITE_THROUGH   | \
                            MMU_MEMORY_AP_READ_WRITE | MMU_MEMORY_XN)
 
-/* Scratch region - cacheable, write through */
-#define SCRATCH_MEMORY    (MMU_MEMORY_TYPE_NORMAL_WRITE_THROUGH   | \
+/* Scratch region - cacheable */
+#define SCRATCH_MEMORY    (MMU_MEMORY_TYPE_NORMAL_LK | \
                            MMU_MEMORY_AP_READ_WRITE | MMU_MEMORY_XN)
 
 /* Peripherals - non-shared device */
@@ -60,8 +60,8 @@ static uint32_t ticks_per_sec = 0;
 #define KERNEL_MEMORY     (MMU_MEMORY_TYPE_NORMAL_WRITE_THROUGH  | \
                            MMU_MEMORY_AP_READ_WRITE)
 
-/* Scratch region - cacheable, write through */
-#define SCRATCH_MEMORY    (MMU_MEMORY_TYPE_NORMAL_WRITE_THROUGH  | \
+/* Scratch region - cacheable */
+#define SCRATCH_MEMORY    (MMU_MEMORY_TYPE_NORMAL_LK | \
                            MMU_MEMORY_AP_READ_WRITE)
 
 /* Peripherals - non-shared device */
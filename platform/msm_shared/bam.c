@@ -448,6 +448,10 @@ int bam_add_one_desc(struct bam_instance *bam,
 	desc->size     = (uint16_t)len;
 	desc->reserved = 0;
 
+	/* The data must be in memory before the peripheral reads it, and no
+	 * dirty line may be left to be evicted over what the peripheral writes.
+	 */
+	arch_clean_invalidate_cache_range((addr_t) data_ptr, len);
 	arch_clean_invalidate_cache_range((addr_t) desc, BAM_DESC_SIZE);
 
 	/* Update the FIFO to point to the head */
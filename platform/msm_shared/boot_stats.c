@@ -32,13 +32,26 @@
 #include <reg.h>
 #include <platform/iomap.h>
 #include <platform.h>
+#include <printf.h>
+#include <kernel/thread.h>
+#include <lib/evtrace.h>
 
 static uint32_t kernel_load_start;
+
+static struct bs_scope bs_scopes[BS_SCOPE_MAX];
+static unsigned bs_scope_used;
+static int bs_kernel_load_scope = BS_SCOPE_NONE;
+
 void bs_set_timestamp(enum bs_entry bs_id)
 {
 	addr_t bs_imem = get_bs_info_addr();
 	uint32_t clk_count = 0;
 
+	if (bs_id == BS_KERNEL_LOAD_START)
+		bs_kernel_load_scope = bs_scope_begin("kernel_load");
+	else if (bs_id == BS_KERNEL_LOAD_DONE)
+		bs_scope_end(bs_kernel_load_scope);
+
 	if(bs_imem) {
 		if (bs_id >= BS_MAX) {
 			dprintf(CRITICAL, "bad bs id: %u, max: %u\n", bs_id, BS_MAX);
@@ -47,11 +60,13 @@ void bs_set_timestamp(enum bs_entry bs_id)
 
 		if (bs_id == BS_KERNEL_LOAD_START) {
 			kernel_load_start = platform_get_sclk_count();
+			EVTRACE_BOOT_STAMP(bs_id, kernel_load_start);
 			return;
 		}
 
 		if(bs_id == BS_KERNEL_LOAD_DONE){
 			clk_count = platform_get_sclk_count();
+			EVTRACE_BOOT_STAMP(bs_id, clk_count);
 			if(clk_count){
 				writel(clk_count - kernel_load_start,
 					bs_imem + (sizeof(uint32_t) * BS_KERNEL_LOAD_TIME));
@@ -59,6 +74,7 @@ void bs_set_timestamp(enum bs_entry bs_id)
 		}
 		else{
 			clk_count = platform_get_sclk_count();
+			EVTRACE_BOOT_STAMP(bs_id, clk_count);
 			if(clk_count){
 				writel(clk_count,
 					bs_imem + (sizeof(uint32_t) * bs_id));
@@ -66,3 +82,119 @@ void bs_set_timestamp(enum bs_entry bs_id)
 		}
 	}
 }
+
+/* the innermost open scope is per thread (and inherited by threads it
+ * creates), so scopes begun by concurrent init tasks nest under their own
+ * task instead of under each other */
+static int bs_scope_current(void)
+{
+	return (int)tls_get(TLS_ENTRY_BOOT_SCOPE) - 1;
+}
+
+static void bs_scope_set_current(int id)
+{
+	tls_set(TLS_ENTRY_BOOT_SCOPE, (uint32_t)(id + 1));
+}
+
+int bs_scope_begin(const char *name)
+{
+	uint32_t now = platform_get_sclk_count();
+	int id;
+
+	enter_critical_section();
+	if (bs_scope_used == BS_SCOPE_MAX) {
+		exit_critical_section();
+		return BS_SCOPE_NONE;
+	}
+
+	id = bs_scope_used++;
+	bs_scopes[id].name = name;
+	bs_scopes[id].start = now;
+	bs_scopes[id].end = 0;
+	bs_scopes[id].parent = bs_scope_current();
+	bs_scope_set_current(id);
+	exit_critical_section();
+
+	return id;
+}
+
+void bs_scope_end(int id)
+{
+	uint32_t now = platform_get_sclk_count();
+
+	if (id == BS_SCOPE_NONE)
+		return;
+
+	ASSERT((unsigned)id < bs_scope_used);
+
+	enter_critical_section();
+	bs_scopes[id].end = now;
+	/* scopes closed out of order just pop back to their own parent */
+	bs_scope_set_current(bs_scopes[id].parent);
+	exit_critical_section();
+}
+
+unsigned bs_scope_count(void)
+{
+	return bs_scope_used;
+}
+
+const struct bs_scope *bs_scope_get(unsigned id)
+{
+	if (id >= bs_scope_used)
+		return NULL;
+
+	return &bs_scopes[id];
+}
+
+static unsigned bs_sclk_to_us(uint32_t ticks)
+{
+	return (unsigned)(((uint64_t)ticks * 1000000) / BS_SCLK_HZ);
+}
+
+int bs_scope_format(unsigned id, char *buf, size_t len)
+{
+	const struct bs_scope *s = bs_scope_get(id);
+	unsigned depth = 0;
+	int parent;
+
+	if (!s)
+		return -1;
+
+	for (parent = s->parent; parent != BS_SCOPE_NONE; parent = bs_scopes[parent].parent)
+		depth++;
+
+	if (!s->end)
+		return snprintf(buf, len, "%*s%s: start %u us, not finished",
+				depth * 2, "", s->name, bs_sclk_to_us(s->start));
+
+	return snprintf(buf, len, "%*s%s: start %u us, took %u us",
+			depth * 2, "", s->name, bs_sclk_to_us(s->start),
+			bs_sclk_to_us(s->end - s->start));
+}
+
+void bs_scope_dump(void)
+{
+	char line[96];
+	unsigned i;
+
+	for (i = 0; i < bs_scope_used; i++) {
+		bs_scope_format(i, line, sizeof(line));
+		dprintf(ALWAYS, "%s\n", line);
+	}
+}
+
+#if WITH_LIB_CONSOLE
+#include <lib/console.h>
+
+static int cmd_bootstats(int argc, const cmd_args *argv)
+{
+	bs_scope_dump();
+	return 0;
+}
+
+STATIC_COMMAND_START
+STATIC_COMMAND("bootstats", "print boot profiling scopes", &cmd_bootstats)
+STATIC_COMMAND_END(bootstats);
+
+#endif
@@ -34,9 +34,30 @@
 #include <bits.h>
 #include <clock.h>
 #include <string.h>
+#include <kernel/mutex.h>
 
 static struct clk_list msm_clk_list;
 
+/* Reference counts and rate changes are serialized between init tasks.
+ * Clock ops may call back into the framework for their parents, so the
+ * lock nests for the thread that holds it.
+ */
+static mutex_t clk_lock = MUTEX_INITIAL_VALUE(clk_lock);
+static unsigned clk_lock_depth;
+
+static void clk_lock_acquire(void)
+{
+	if (!is_mutex_held(&clk_lock))
+		mutex_acquire(&clk_lock);
+	clk_lock_depth++;
+}
+
+static void clk_lock_release(void)
+{
+	if (--clk_lock_depth == 0)
+		mutex_release(&clk_lock);
+}
+
 int clk_set_parent(struct clk *clk, struct clk *parent)
 {
 	if (!clk->ops->set_parent)
@@ -75,6 +96,7 @@ int clk_enable(struct clk *clk)
 	if (!clk)
 		return 0;
 
+	clk_lock_acquire();
 	if (clk->count == 0) {
 		parent = clk_get_parent(clk);
 		ret = clk_enable(parent);
@@ -90,6 +112,7 @@ int clk_enable(struct clk *clk)
 	}
 	clk->count++;
 out:
+	clk_lock_release();
 	return ret;
 }
 
@@ -100,6 +123,7 @@ void clk_disable(struct clk *clk)
 	if (!clk)
 		return;
 
+	clk_lock_acquire();
 	if (clk->count == 0)
 		goto out;
 	if (clk->count == 1) {
@@ -110,7 +134,7 @@ void clk_disable(struct clk *clk)
 	}
 	clk->count--;
 out:
-	return;
+	clk_lock_release();
 }
 
 unsigned long clk_get_rate(struct clk *clk)
@@ -123,10 +147,16 @@ unsigned long clk_get_rate(struct clk *clk)
 
 int clk_set_rate(struct clk *clk, unsigned long rate)
 {
+	int ret;
+
 	if (!clk->ops->set_rate)
 		return ERR_NOT_VALID;
 
-	return clk->ops->set_rate(clk, rate);
+	clk_lock_acquire();
+	ret = clk->ops->set_rate(clk, rate);
+	clk_lock_release();
+
+	return ret;
 }
 
 void clk_init(struct clk_lookup *clist, unsigned num)
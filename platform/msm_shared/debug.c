@@ -39,6 +39,8 @@
 #include <dev/uart.h>
 #include <platform/timer.h>
 #include <kernel/thread.h>
+#include <kernel/mutex.h>
+#include <lk/init.h>
 #include <platform.h>
 #include <platform/msm_shared.h>
 #include <platform/msm_shared/timer.h>
@@ -51,6 +53,10 @@
 #include <app/menu.h>
 #endif
 
+#if WITH_DEBUG_LOG_DEFERRED
+#include <lib/cbuf.h>
+#endif
+
 static void write_dcc(char c)
 {
 	uint32_t timeout = 10;
@@ -110,29 +116,204 @@ unsigned lk_log_getsize(void) {
 }
 #endif /* WITH_DEBUG_LOG_BUF */
 
-void platform_dputc(char c)
+/* slow, possibly sleeping sinks: fed from the drain thread once it runs */
+static void sinks_write(const char *str, size_t len)
 {
-#if WITH_DEBUG_LOG_BUF
-	log_putc(c);
-#endif
+	size_t i;
+
 #if WITH_DEBUG_DCC
-	if (c == '\n') {
-		write_dcc('\r');
+	for (i = 0; i < len; i++) {
+		if (str[i] == '\n')
+			write_dcc('\r');
+		write_dcc(str[i]);
 	}
-	write_dcc(c) ;
 #endif
 #if WITH_DEBUG_UART
-	uart_putc(0, c);
+	for (i = 0; i < len; i++)
+		uart_putc(0, str[i]);
 #endif
 #if WITH_DEBUG_FBCON && WITH_DEV_FBCON
-	fbcon_putc(c);
+	for (i = 0; i < len; i++)
+		fbcon_putc(str[i]);
 #endif
 #if WITH_DEBUG_JTAG
-	jtag_dputc(c);
+	for (i = 0; i < len; i++)
+		jtag_dputc(str[i]);
 #endif
 #if WITH_APP_MENU
-	menu_putc(c);
+	menu_puts(str, len);
+#endif
+	(void)i;
+}
+
+#if WITH_DEBUG_LOG_DEFERRED
+
+/*
+ * Deferred output: writers only append to a ring, a low priority thread
+ * feeds the sinks a chunk at a time. Output stays synchronous until the
+ * thread exists and again once a panic starts.
+ */
+#ifndef DEBUG_LOG_RING_SIZE
+#define DEBUG_LOG_RING_SIZE    (16384) /* power of 2 */
+#endif
+
+#define DEBUG_LOG_DRAIN_CHUNK  (256)
+
+static cbuf_t log_ring;
+static char log_ring_buf[DEBUG_LOG_RING_SIZE];
+static mutex_t log_sink_lock;
+static volatile bool log_deferred;
+static unsigned log_dropped;
+
+static void log_drain_locked(void)
+{
+	char buf[DEBUG_LOG_DRAIN_CHUNK];
+	size_t len;
+
+	while ((len = cbuf_read(&log_ring, buf, sizeof(buf), false)) > 0)
+		sinks_write(buf, len);
+}
+
+static void log_report_dropped(void)
+{
+	char buf[48];
+	unsigned dropped;
+
+	enter_critical_section();
+	dropped = log_dropped;
+	log_dropped = 0;
+	exit_critical_section();
+
+	if (dropped) {
+		snprintf(buf, sizeof(buf), "\n[debug: %u chars dropped]\n", dropped);
+		sinks_write(buf, strlen(buf));
+	}
+}
+
+static int log_drain_thread(void *arg)
+{
+	char buf[DEBUG_LOG_DRAIN_CHUNK];
+	size_t len;
+
+	for (;;) {
+		len = cbuf_read(&log_ring, buf, sizeof(buf), true);
+
+		mutex_acquire(&log_sink_lock);
+		log_report_dropped();
+		sinks_write(buf, len);
+		mutex_release(&log_sink_lock);
+	}
+
+	return 0;
+}
+
+static void log_deferred_write(const char *str, size_t len)
+{
+	size_t written;
+
+	written = cbuf_write(&log_ring, str, len, false);
+	if (written == len)
+		return;
+
+	/* ring is full: a thread that may block empties it itself,
+	 * anything else (irq, critical section, a sink printing) drops */
+	if (in_critical_section() || is_mutex_held(&log_sink_lock)) {
+		enter_critical_section();
+		log_dropped += len - written;
+		exit_critical_section();
+		return;
+	}
+
+	mutex_acquire(&log_sink_lock);
+	log_drain_locked();
+	log_report_dropped();
+	sinks_write(str + written, len - written);
+	mutex_release(&log_sink_lock);
+}
+
+static void log_deferred_init(uint level)
+{
+	thread_t *thr;
+
+	cbuf_initialize_etc(&log_ring, sizeof(log_ring_buf), log_ring_buf);
+	mutex_init(&log_sink_lock);
+
+	thr = thread_create("dlog", log_drain_thread, NULL, LOW_PRIORITY, DEFAULT_STACK_SIZE);
+	if (!thr)
+		return;
+	thread_detach_and_resume(thr);
+
+	log_deferred = true;
+}
+
+LK_INIT_HOOK(debug_log, &log_deferred_init, LK_INIT_LEVEL_THREADING);
+
+void platform_panic_start(void)
+{
+	if (!log_deferred)
+		return;
+
+	/* nobody else gets to run anymore, write out what is queued
+	 * and everything after it directly */
+	enter_critical_section();
+	log_deferred = false;
+	log_drain_locked();
+	exit_critical_section();
+}
+
+void dlog_flush(void)
+{
+	bool locked = false;
+
+	if (!log_deferred)
+		return;
+
+	/* let the drain thread finish the chunk it already took out */
+	if (!in_critical_section() && !is_mutex_held(&log_sink_lock)) {
+		mutex_acquire(&log_sink_lock);
+		locked = true;
+	}
+
+	/* lk is being left behind (kernel entry, reset, power off),
+	 * write out what is queued and stay synchronous from here on */
+	enter_critical_section();
+	log_deferred = false;
+	log_drain_locked();
+	log_report_dropped();
+	exit_critical_section();
+
+	if (locked)
+		mutex_release(&log_sink_lock);
+}
+
+#endif /* WITH_DEBUG_LOG_DEFERRED */
+
+void platform_dputs(const char *str, size_t len)
+{
+#if WITH_DEBUG_LOG_BUF
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		log_putc(str[i]);
+#endif
+#if WITH_DEBUG_LOG_DEFERRED
+	if (log_deferred) {
+		while (len) {
+			size_t n = MIN(len, DEBUG_LOG_DRAIN_CHUNK);
+
+			log_deferred_write(str, n);
+			str += n;
+			len -= n;
+		}
+		return;
+	}
 #endif
+	sinks_write(str, len);
+}
+
+void platform_dputc(char c)
+{
+	platform_dputs(&c, 1);
 }
 
 int platform_dgetc(char *c, bool wait)
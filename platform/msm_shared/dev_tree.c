@@ -39,6 +39,7 @@
 #include <board.h>
 #include <list.h>
 #include <kernel/thread.h>
+#include <boot_stats.h>
 
 struct dt_entry_v1
 {
@@ -1253,6 +1254,34 @@ int dev_tree_add_mem_info(void *fdt, uint32_t offset, uint64_t addr, uint64_t si
 	return ret;
 }
 
+#if BOOT_STATS_DTB
+/* Publish the boot profiling scopes in /chosen so the kernel can report
+ * them: lk,boot-stats-names is a string list and lk,boot-stats holds
+ * <start end parent> sclk cells for each name, in the same order.
+ * Scopes still open at this point (boot_linux, dtb_fixup) have end 0.
+ */
+static int update_fdt_boot_stats(void *fdt, uint32_t offset)
+{
+	const struct bs_scope *s;
+	unsigned i;
+	int ret;
+
+	ret = fdt_setprop_u32(fdt, offset, "lk,boot-stats-hz", BS_SCLK_HZ);
+
+	for (i = 0; !ret && (s = bs_scope_get(i)); i++) {
+		ret = fdt_appendprop_string(fdt, offset, "lk,boot-stats-names", s->name);
+		if (!ret)
+			ret = fdt_appendprop_u32(fdt, offset, "lk,boot-stats", s->start);
+		if (!ret)
+			ret = fdt_appendprop_u32(fdt, offset, "lk,boot-stats", s->end);
+		if (!ret)
+			ret = fdt_appendprop_u32(fdt, offset, "lk,boot-stats", (uint32_t)s->parent);
+	}
+
+	return ret;
+}
+#endif
+
 /* Top level function that updates the device tree. */
 int update_device_tree(void *fdt, const char *cmdline,
 					   void *ramdisk, uint32_t ramdisk_size)
@@ -1348,6 +1377,12 @@ int update_device_tree(void *fdt, const char *cmdline,
 	}
 #endif
 
+#if BOOT_STATS_DTB
+	/* Boot stats are informational, don't fail the boot over them */
+	if (update_fdt_boot_stats(fdt, offset))
+		dprintf(CRITICAL, "ERROR: Cannot update chosen node [lk,boot-stats]\n");
+#endif
+
 	fdt_pack(fdt);
 
 	return ret;
@@ -29,6 +29,7 @@
 #include <debug.h>
 #include <err.h>
 #include <string.h>
+#include <stdlib.h>
 #include <dev/flash.h>
 #include <msm_panel.h>
 #include <mdp4.h>
@@ -36,9 +37,196 @@
 #include <boot_stats.h>
 #include <target.h>
 #include <malloc.h>
+#include <arch/ops.h>
+#include <kernel/event.h>
+#include <kernel/timer.h>
+#include <platform/msm_shared/timer.h>
 
 static struct msm_fb_panel_data *panel;
 
+#if DISPLAY_TYPE_MDSS && DISPLAY_DOUBLE_BUFFER
+/*
+ * Double buffering for the MDSS DSI panels. fbcon draws into the back
+ * buffer while the source pipe scans out the front one; fbcon_flush()
+ * retargets the pipe and returns immediately, and the flip completes on
+ * the next vsync (video mode) or at the end of the frame transfer
+ * (command mode). The back buffer sits right behind the target's
+ * framebuffer in the display carveout, below the area used for staging
+ * raw splash images (LOGO_IMG_OFFSET).
+ *
+ * Console text does not flip: the rows it changed are copied to the
+ * front buffer instead, so a line of output costs neither a full frame
+ * copy nor a wait for vsync.
+ */
+
+/* a flip that has not landed after this long is given up on, in ms */
+#define MSM_DISPLAY_FLIP_TIMEOUT 100
+
+static struct {
+	uint8_t *buf[2];
+	unsigned front;
+	size_t size;
+	size_t pitch;
+	unsigned height;
+	bool pending;	/* scanout switch not latched yet */
+	bool stale;	/* back buffer does not hold the last frame */
+	event_t done;
+	timer_t poll;
+} dbuf;
+
+/* called with interrupts disabled */
+static void msm_display_flip_complete(void)
+{
+	dbuf.pending = false;
+	timer_cancel(&dbuf.poll);
+	event_signal(&dbuf.done, false);
+}
+
+static enum handler_return msm_display_flip_poll(struct timer *timer,
+						 lk_time_t now, void *arg)
+{
+	if (!dbuf.pending || !mdss_mdp_scanout_done(&panel->panel_info))
+		return INT_NO_RESCHEDULE;
+
+	msm_display_flip_complete();
+	return INT_RESCHEDULE;
+}
+
+/* spin for the scanout switch, a hung mdp must not wedge boot or shutdown */
+static void msm_display_scanout_wait(void)
+{
+	unsigned timeout = MSM_DISPLAY_FLIP_TIMEOUT * 100;
+
+	while (!mdss_mdp_scanout_done(&panel->panel_info)) {
+		if (!timeout--) {
+			dprintf(CRITICAL, "display: scanout switch timed out\n");
+			return;
+		}
+		udelay(10);
+	}
+}
+
+static void msm_display_flip_wait(bool keep)
+{
+	if (dbuf.pending) {
+		if (in_critical_section()) {
+			/* the poll timer can't run, do its job here */
+			msm_display_scanout_wait();
+			msm_display_flip_complete();
+		} else if (event_wait_timeout(&dbuf.done, MSM_DISPLAY_FLIP_TIMEOUT) < 0) {
+			dprintf(CRITICAL, "display: flip timed out\n");
+			enter_critical_section();
+			if (dbuf.pending)
+				msm_display_flip_complete();
+			exit_critical_section();
+		}
+	}
+
+	if (dbuf.stale) {
+		if (keep)
+			memcpy(dbuf.buf[dbuf.front ^ 1], dbuf.buf[dbuf.front],
+			       dbuf.size);
+		dbuf.stale = false;
+	}
+}
+
+static void msm_display_flip(void)
+{
+	unsigned back = dbuf.front ^ 1;
+
+	/* the previous flip has to land before the pipe can be retargeted,
+	 * and a flush without drawing must not bring back an older frame */
+	msm_display_flip_wait(true);
+	arch_clean_cache_range((addr_t) dbuf.buf[back], dbuf.size);
+
+	enter_critical_section();
+	event_unsignal(&dbuf.done);
+	dbuf.pending = true;
+	mdss_mdp_set_scanout(&panel->panel_info, dbuf.buf[back]);
+	dbuf.front = back;
+	dbuf.stale = true;
+	panel->fb.base = dbuf.buf[back ^ 1];
+	timer_set_periodic(&dbuf.poll, 1, msm_display_flip_poll, NULL);
+	exit_critical_section();
+}
+
+/* console text changed rows y..y+count of the back buffer */
+static void msm_display_update_rows(unsigned y, unsigned count)
+{
+	size_t offset, len;
+
+	if (y >= dbuf.height)
+		return;
+	count = MIN(count, dbuf.height - y);
+
+	msm_display_flip_wait(true);
+
+	offset = y * dbuf.pitch;
+	len = count * dbuf.pitch;
+	memcpy(dbuf.buf[dbuf.front] + offset, dbuf.buf[dbuf.front ^ 1] + offset, len);
+	arch_clean_cache_range((addr_t) dbuf.buf[dbuf.front] + offset, len);
+}
+
+static void msm_display_dbuf_init(void)
+{
+	struct fbcon_config *fb = &panel->fb;
+	unsigned stride = fb->stride ? fb->stride : fb->width;
+
+	if (panel->panel_info.type != MIPI_VIDEO_PANEL &&
+	    panel->panel_info.type != MIPI_CMD_PANEL)
+		return;
+	if (fb->update_start || fb->update_wait)
+		return;
+
+	dbuf.size = ROUNDUP(stride * fb->height * (fb->bpp / 8), 4096);
+	if (2 * dbuf.size > LOGO_IMG_OFFSET) {
+		dprintf(INFO, "framebuffer too large for double buffering\n");
+		return;
+	}
+
+	dbuf.buf[0] = fb->base;
+	dbuf.buf[1] = (uint8_t *) fb->base + dbuf.size;
+	dbuf.pitch = stride * (fb->bpp / 8);
+	dbuf.height = fb->height;
+	dbuf.front = 0;
+	dbuf.pending = false;
+	dbuf.stale = false;
+	event_init(&dbuf.done, true, 0);
+	timer_initialize(&dbuf.poll);
+
+	/* the splash is already on screen, continue drawing on a copy */
+	memcpy(dbuf.buf[1], dbuf.buf[0], dbuf.size);
+	fb->base = dbuf.buf[1];
+	fb->update_start = msm_display_flip;
+	fb->update_wait = msm_display_flip_wait;
+	fb->update_rows = msm_display_update_rows;
+}
+
+/* hand the target framebuffer back, continuous splash expects it there */
+static void msm_display_dbuf_release(void)
+{
+	if (!dbuf.buf[0])
+		return;
+
+	msm_display_flip_wait(false);
+	if (dbuf.front) {
+		memcpy(dbuf.buf[0], dbuf.buf[1], dbuf.size);
+		arch_clean_cache_range((addr_t) dbuf.buf[0], dbuf.size);
+		mdss_mdp_set_scanout(&panel->panel_info, dbuf.buf[0]);
+		msm_display_scanout_wait();
+	}
+
+	panel->fb.base = dbuf.buf[0];
+	panel->fb.update_start = NULL;
+	panel->fb.update_wait = NULL;
+	panel->fb.update_rows = NULL;
+	dbuf.buf[0] = NULL;
+}
+#else
+static inline void msm_display_dbuf_init(void) {}
+static inline void msm_display_dbuf_release(void) {}
+#endif
+
 static int msm_fb_alloc(struct fbcon_config *fb)
 {
 	if (fb == NULL)
@@ -262,6 +450,10 @@ msm_display_on_out:
 int msm_display_init(struct msm_fb_panel_data *pdata)
 {
 	int ret = NO_ERROR;
+	int bs_scope, bs_splash;
+	bool fixed_fb;
+
+	bs_scope = bs_scope_begin("display_init");
 
 	panel = pdata;
 	if (!panel) {
@@ -300,6 +492,7 @@ int msm_display_init(struct msm_fb_panel_data *pdata)
 	if (ret)
 		goto msm_display_init_out;
 
+	fixed_fb = panel->fb.base != NULL;
 	ret = msm_fb_alloc(&(panel->fb));
 	if (ret)
 		goto msm_display_init_out;
@@ -309,7 +502,9 @@ int msm_display_init(struct msm_fb_panel_data *pdata)
 #endif
 
 	fbcon_setup(&(panel->fb));
+	bs_splash = bs_scope_begin("splash");
 	display_image_on_screen();
+	bs_scope_end(bs_splash);
 	ret = msm_display_config();
 	if (ret)
 		goto msm_display_init_out;
@@ -318,6 +513,10 @@ int msm_display_init(struct msm_fb_panel_data *pdata)
 	if (ret)
 		goto msm_display_init_out;
 
+	/* a heap framebuffer has no room behind it for a second one */
+	if (fixed_fb)
+		msm_display_dbuf_init();
+
 	if (pdata->post_power_func)
 		ret = pdata->post_power_func(1);
 	if (ret)
@@ -331,6 +530,7 @@ int msm_display_init(struct msm_fb_panel_data *pdata)
 		goto msm_display_init_out;
 
 msm_display_init_out:
+	bs_scope_end(bs_scope);
 	return ret;
 }
 
@@ -344,6 +544,8 @@ int msm_display_off()
 
 	pinfo = &(panel->panel_info);
 
+	msm_display_dbuf_release();
+
 	if (pinfo->pre_off) {
 		ret = pinfo->pre_off();
 		if (ret)
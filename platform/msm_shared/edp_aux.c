@@ -963,7 +963,7 @@ clear:
 void mdss_edp_wait_for_hpd(void)
 {
 	while(1) {
-		udelay(1000);
+		mdelay(1);
 		edp_isr_poll();
 		if (edp_hpd_done) {
 			edp_hpd_done = 0;
@@ -975,7 +975,7 @@ void mdss_edp_wait_for_hpd(void)
 void mdss_edp_wait_for_video_ready(void)
 {
 	while(1) {
-		udelay(1000);
+		mdelay(1);
 		edp_isr_poll();
 		if (edp_video_ready) {
 			edp_video_ready = 0;
@@ -302,7 +302,7 @@ void edp_isr_poll(void)
 	while(cnt--) {
 		if (edp_isr_read(&isr1, &isr2))
 			break;
-		udelay(1000);
+		mdelay(1);
 	}
 
 	if(cnt <= 0) {
@@ -42,6 +42,7 @@
 #include <kernel/thread.h>
 #include <reg.h>
 #include <dev/udc.h>
+#include <lib/evtrace.h>
 #include "hsusb.h"
 
 #if WITH_APP_DISPLAY_SERVER
@@ -135,13 +136,16 @@ __WEAK void hsusb_clock_init(void)
 struct usb_request {
 	struct udc_request req;
 	struct ept_queue_item *item;
+	struct ept_queue_item *last;	/* TD carrying IOC for this transfer */
+	struct usb_request *next;	/* next queued request on the endpoint */
 };
 
 struct udc_endpoint {
 	struct udc_endpoint *next;
 	unsigned bit;
 	struct ept_queue_head *head;
-	struct usb_request *req;
+	struct usb_request *req;	/* oldest request still owned by hw */
+	struct usb_request *tail;
 	unsigned char num;
 	unsigned char in;
 	unsigned short maxpkt;
@@ -171,6 +175,7 @@ struct udc_endpoint *_udc_endpoint_alloc(unsigned num, unsigned in,
 	ept->num = num;
 	ept->in = !!in;
 	ept->req = 0;
+	ept->tail = 0;
 
 	cfg = CONFIG_MAX_PKT(max_pkt) | CONFIG_ZLT;
 
@@ -259,19 +264,59 @@ struct udc_request *udc_request_alloc(void)
 	ASSERT(req);
 	req->req.buf = 0;
 	req->req.length = 0;
+	req->next = 0;
 	req->item = memalign(CACHE_LINE, ROUNDUP(sizeof(struct ept_queue_item),
 								CACHE_LINE));
+	ASSERT(req->item);
+	req->item->next = TERMINATE;
+	req->item->chain = 0;
+	req->last = req->item;
 	return &req->req;
 }
 
-void udc_request_free(struct udc_request *req)
+void udc_request_free(struct udc_request *_req)
 {
+	struct usb_request *req = (struct usb_request *)_req;
+	struct ept_queue_item *item, *next;
+
+	for (item = req->item; item; item = next) {
+		next = (void*)item->chain;
+		free(item);
+	}
 	free(req);
 }
 
 /*
- * Assumes that TDs allocated already are not freed.
- * But it can handle case where TDs are freed as well.
+ * Make sure the request owns enough TDs to move len bytes, so that
+ * queueing it later does not have to allocate.
+ */
+int udc_request_reserve(struct udc_request *_req, unsigned len)
+{
+	struct usb_request *req = (struct usb_request *)_req;
+	struct ept_queue_item *item = req->item;
+
+	while (len > MAX_TD_XFER_SIZE) {
+		if (!item->chain) {
+			struct ept_queue_item *new;
+
+			new = memalign(CACHE_LINE,
+				ROUNDUP(sizeof(struct ept_queue_item), CACHE_LINE));
+			if (!new)
+				return -1;
+			new->next = TERMINATE;
+			new->chain = 0;
+			item->chain = (unsigned)new;
+		}
+		item = (void*)item->chain;
+		len -= MAX_TD_XFER_SIZE;
+	}
+	return 0;
+}
+
+/*
+ * Requests are queued in order. A request queued while the endpoint is
+ * still busy is linked behind the last TD of the previous one, so the
+ * controller moves on without waiting for software.
  */
 int udc_request_queue(struct udc_endpoint *ept, struct udc_request *_req)
 {
@@ -280,141 +325,126 @@ int udc_request_queue(struct udc_endpoint *ept, struct udc_request *_req)
 	struct usb_request *req = (struct usb_request *)_req;
 	unsigned phys = (unsigned)req->req.buf;
 	unsigned len = req->req.length;
-	unsigned int count = 0;
+	unsigned busy = 0;
 
-	curr_item = NULL;
-	xfer = (len > MAX_TD_XFER_SIZE) ? MAX_TD_XFER_SIZE : len;
-	/*
-	 * First TD allocated during request allocation
-	 */
-	item = req->item;
-	item->info = INFO_BYTES(xfer) | INFO_ACTIVE;
-	item->page0 = phys;
-	item->page1 = (phys & 0xfffff000) + 0x1000;
-	item->page2 = (phys & 0xfffff000) + 0x2000;
-	item->page3 = (phys & 0xfffff000) + 0x3000;
-	item->page4 = (phys & 0xfffff000) + 0x4000;
-	phys += xfer;
-	curr_item = item;
-	len -= xfer;
+	EVTRACE_USB_QUEUE(req, len);
+
+	if (udc_request_reserve(_req, len)) {
+		dprintf(ALWAYS, "allocate USB item fail ept%d%s queue\n",
+			ept->num, ept->in ? "in" : "out");
+		return -1;
+	}
 
 	/*
-	 * If transfer length is more then
-	 * accomodate by 1 TD
-	 * we add more transfer descriptors
+	 * The TD chain was sized above; fill as many TDs as the transfer
+	 * needs and leave the rest of the chain for later.
 	 */
-	while (len > 0) {
+	item = req->item;
+	for (;;) {
 		xfer = (len > MAX_TD_XFER_SIZE) ? MAX_TD_XFER_SIZE : len;
-		if (curr_item->next == TERMINATE) {
-			/*
-			 * Allocate new TD only if chain doesnot
-			 * exist already
-			 */
-			item = memalign(CACHE_LINE,
-					ROUNDUP(sizeof(struct ept_queue_item), CACHE_LINE));
-			if (!item) {
-				dprintf(ALWAYS, "allocate USB item fail ept%d"
-							"%s queue\n"
-							"td count = %d\n",
-							ept->num,
-							ept->in ? "in" : "out",
-							count);
-				return -1;
-			} else {
-				count ++;
-				curr_item->next = PA((addr_t)item);
-				item->next = TERMINATE;
-			}
-		} else
-			/* Since next TD in chain already exists */
-			item = (void*)VA((addr_t)curr_item->next);
-
-		/* Update TD with transfer information */
 		item->info = INFO_BYTES(xfer) | INFO_ACTIVE;
 		item->page0 = phys;
 		item->page1 = (phys & 0xfffff000) + 0x1000;
 		item->page2 = (phys & 0xfffff000) + 0x2000;
 		item->page3 = (phys & 0xfffff000) + 0x3000;
 		item->page4 = (phys & 0xfffff000) + 0x4000;
-
-		curr_item = item;
-		len -= xfer;
 		phys += xfer;
+		len -= xfer;
+		if (len == 0)
+			break;
+		item->next = PA((addr_t)item->chain);
+		item = (void*)item->chain;
 	}
 
 	/* Terminate and set interrupt for last TD */
-	curr_item->next = TERMINATE;
-	curr_item->info |= INFO_IOC;
-	enter_critical_section();
-	ept->head->next = PA((addr_t)req->item);
-	ept->head->info = 0;
-	ept->req = req;
-	arch_clean_invalidate_cache_range((addr_t) ept,
-					  sizeof(struct udc_endpoint));
-	arch_clean_invalidate_cache_range((addr_t) ept->head,
-					  sizeof(struct ept_queue_head));
-	arch_clean_invalidate_cache_range((addr_t) ept->req,
-					  sizeof(struct usb_request));
+	item->next = TERMINATE;
+	item->info |= INFO_IOC;
+	req->last = item;
+	req->next = 0;
+
 	arch_clean_invalidate_cache_range((addr_t) VA((addr_t)req->req.buf),
 					  req->req.length);
 
-	item = req->item;
 	/* Write all TD's to memory from cache */
-	while (item != NULL) {
-		curr_item = item;
-		if (curr_item->next == TERMINATE)
-			item = NULL;
-		else
-			item = (void*)curr_item->next;
+	for (item = req->item; ; item = (void*)item->chain) {
+		arch_clean_invalidate_cache_range((addr_t) item,
+					  sizeof(struct ept_queue_item));
+		if (item == req->last)
+			break;
+	}
+
+	enter_critical_section();
+	/* control transfers never overlap, a new stage replaces the old one */
+	if (ept->req && ept->num != 0) {
+		curr_item = ept->tail->last;
+		curr_item->next = PA((addr_t)req->item);
 		arch_clean_invalidate_cache_range((addr_t) curr_item,
 					  sizeof(struct ept_queue_item));
+		ept->tail->next = req;
+		ept->tail = req;
+
+		/*
+		 * The controller may have fetched the old terminator already.
+		 * Sample ENDPTSTAT under the tripwire to know whether the new
+		 * TDs will be picked up or the endpoint must be primed again.
+		 */
+		do {
+			writel(readl(USB_USBCMD) | USBCMD_ATDTW, USB_USBCMD);
+			busy = readl(USB_ENDPTSTAT) & ept->bit;
+		} while (!(readl(USB_USBCMD) & USBCMD_ATDTW));
+		writel(readl(USB_USBCMD) & ~USBCMD_ATDTW, USB_USBCMD);
+	} else {
+		ept->req = req;
+		ept->tail = req;
 	}
 
-	DBG("ept%d %s queue req=%p\n", ept->num, ept->in ? "in" : "out", req);
-	writel(ept->bit, USB_ENDPTPRIME);
+	if (!busy) {
+		ept->head->next = PA((addr_t)req->item);
+		ept->head->info = 0;
+		arch_clean_invalidate_cache_range((addr_t) ept->head,
+					  sizeof(struct ept_queue_head));
+		DBG("ept%d %s queue req=%p\n", ept->num, ept->in ? "in" : "out", req);
+		writel(ept->bit, USB_ENDPTPRIME);
+	}
 	exit_critical_section();
 	return 0;
 }
 
-static void handle_ept_complete(struct udc_endpoint *ept)
+/*
+ * Retire finished requests from the head of the endpoint queue. With abort
+ * set every queued request is completed with an error, the hardware has
+ * been flushed by the caller.
+ */
+static void handle_ept_complete(struct udc_endpoint *ept, bool abort)
 {
 	struct ept_queue_item *item;
-	unsigned actual, total_len;
+	unsigned actual, total_len, remain;
 	int status;
-	struct usb_request *req=NULL;
+	struct usb_request *req;
 
 	DBG("ept%d %s complete req=%p\n",
 	    ept->num, ept->in ? "in" : "out", ept->req);
 
-	arch_invalidate_cache_range((addr_t) ept,
-					  sizeof(struct udc_endpoint));
-
-	if(ept->req)
-	{
-		req = (void*)VA((addr_t)ept->req);
-		arch_invalidate_cache_range((addr_t) ept->req,
-						sizeof(struct usb_request));
-	}
-
-	if (req) {
-		item = (void*)VA((addr_t)req->item);
+	while ((req = ept->req) != NULL) {
 		/* total transfer length for transacation */
 		total_len = req->req.length;
-		ept->req = 0;
 		actual = 0;
-		while(1) {
+		status = 0;
+		item = req->item;
 
-			do {
-				/*
-				 * Must clean/invalidate cached item
-				 * data before checking the status
-				 * every time.
-				 */
-				arch_invalidate_cache_range((addr_t)(item),
-							sizeof(
-							struct ept_queue_item));
+		while (!abort) {
+			/*
+			 * Must clean/invalidate cached item
+			 * data before checking the status
+			 * every time.
+			 */
+			arch_invalidate_cache_range((addr_t)(item),
+						sizeof(struct ept_queue_item));
 
-			} while(readl(&item->info) & INFO_ACTIVE);
+			if (readl(&item->info) & INFO_ACTIVE) {
+				/* still in flight, so is everything behind it */
+				return;
+			}
 
 			if ((item->info) & 0xff) {
 				/* error */
@@ -423,37 +453,65 @@ static void handle_ept_complete(struct udc_endpoint *ept)
 					ept->num, ept->in ? "in" : "out",
 					item->info,
 					item->page0);
-				goto out;
+				/* the endpoint halted, nothing queued will finish */
+				abort = true;
+				break;
 			}
 
+			remain = (item->info >> 16) & 0x7FFF;
 			/* Check if we are processing last TD */
-			if (item->next == TERMINATE) {
+			if (item == req->last) {
 				/*
 				 * Record the data transferred for the last TD
 				 */
-				actual += total_len - ((item->info >> 16) & 0x7FFF);
-				total_len = 0;
+				actual += total_len - remain;
 				break;
-			} else {
-				/*
-				 * Since we are not in last TD
-				 * the total assumed transfer ascribed to this
-				 * TD woulb the max possible TD transfer size
-				 * (16K)
-				 */
-				actual += MAX_TD_XFER_SIZE - ((item->info >> 16) & 0x7FFF);
-				total_len -= MAX_TD_XFER_SIZE - ((item->info >> 16) & 0x7FFF);
-				/*Move to next item in chain*/
-				item = (void*)VA(item->next);
 			}
+
+			/*
+			 * Since we are not in last TD
+			 * the total assumed transfer ascribed to this
+			 * TD woulb the max possible TD transfer size
+			 * (16K)
+			 */
+			actual += MAX_TD_XFER_SIZE - remain;
+			total_len -= MAX_TD_XFER_SIZE;
+			/*Move to next item in chain*/
+			item = (void*)item->chain;
 		}
-		status = 0;
-out:
+
+		if (abort)
+			status = -1;
+
+		ept->req = req->next;
+		if (!ept->req)
+			ept->tail = 0;
+
+		EVTRACE_USB_COMPLETE(req, actual, status);
 		if (req->req.complete)
 			req->req.complete(&req->req, actual, status);
 	}
 }
 
+/*
+ * Stop the endpoint and hand every request still queued on it back with
+ * an error. Used to drop reads queued past a short transfer.
+ */
+int udc_request_cancel(struct udc_endpoint *ept, struct udc_request *req)
+{
+	enter_critical_section();
+	do {
+		writel(ept->bit, USB_ENDPTFLUSH);
+		while (readl(USB_ENDPTFLUSH) & ept->bit);
+	} while (readl(USB_ENDPTSTAT) & ept->bit);
+
+	/* reap what finished before the flush, error out the rest */
+	handle_ept_complete(ept, false);
+	handle_ept_complete(ept, true);
+	exit_critical_section();
+	return 0;
+}
+
 static const char *reqname(unsigned r)
 {
 	switch (r) {
@@ -763,13 +821,7 @@ enum handler_return udc_interrupt(void *arg)
 
 		/* error out any pending reqs */
 		for (ept = ept_list; ept; ept = ept->next) {
-			/* ensure that ept_complete considers
-			 * this to be an error state
-			 */
-			if (ept->req) {
-				ept->req->item->info = INFO_HALTED;
-				handle_ept_complete(ept);
-			}
+			handle_ept_complete(ept, true);
 		}
 		usb_status(0, usb_highspeed);
 	}
@@ -811,7 +863,7 @@ enum handler_return udc_interrupt(void *arg)
 
 		for (ept = ept_list; ept; ept = ept->next) {
 			if (n & ept->bit) {
-				handle_ept_complete(ept);
+				handle_ept_complete(ept, false);
 				ret = INT_RESCHEDULE;
 			}
 		}
@@ -81,6 +81,7 @@
 
 #define USBCMD_RESET   2
 #define USBCMD_ATTACH  1
+#define USBCMD_ATDTW   (1 << 14)	/* add dTD tripwire */
 
 #define USBMODE_DEVICE 2
 #define USBMODE_HOST   3
@@ -118,7 +119,9 @@ struct ept_queue_item {
 	unsigned page2;
 	unsigned page3;
 	unsigned page4;
-	unsigned reserved;
+	/* not seen by the controller: next TD owned by the same request,
+	 * kept across transfers so the chain is only allocated once */
+	unsigned chain;
 };
 
 #define TERMINATE 1
@@ -30,6 +30,9 @@
 #ifndef __BOOT_STATS_H
 #define __BOOT_STATS_H
 
+#include <sys/types.h>
+#include <stdint.h>
+
 /* The order of the entries in this enum does not correspond to bootup order.
  * It is mandated by the expected order of the entries in imem when the values
  * are read in the kernel.
@@ -45,4 +48,28 @@ enum bs_entry {
 };
 void bs_set_timestamp(enum bs_entry bs_id);
 
+/* Named boot profiling scopes, timestamped with the sclk (32768 Hz).
+ * Scopes nest: a scope begun while another is open on the same thread
+ * becomes its child, a new thread starts out inside its creator's scope.
+ * The table is fixed size, scopes begun once it is full are not recorded.
+ */
+#define BS_SCOPE_MAX    48
+#define BS_SCOPE_NONE   -1
+#define BS_SCLK_HZ      32768
+
+struct bs_scope {
+	const char *name;
+	uint32_t start;
+	uint32_t end;   /* 0 while the scope is still open */
+	int parent;     /* index of the enclosing scope or BS_SCOPE_NONE */
+};
+
+int bs_scope_begin(const char *name);
+void bs_scope_end(int id);
+unsigned bs_scope_count(void);
+const struct bs_scope *bs_scope_get(unsigned id);
+/* one human readable line per scope, indented by nesting depth */
+int bs_scope_format(unsigned id, char *buf, size_t len);
+void bs_scope_dump(void);
+
 #endif
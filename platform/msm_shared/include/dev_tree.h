@@ -44,7 +44,12 @@
 #define DTB_MAGIC               0xedfe0dd0
 #define DTB_OFFSET              0x2C
 
+#if BOOT_STATS_DTB
+/* room for the lk,boot-stats properties as well */
+#define DTB_PAD_SIZE            4096
+#else
 #define DTB_PAD_SIZE            1024
+#endif
 
 /*
  * For DTB V1: The DTB entries would be of the format
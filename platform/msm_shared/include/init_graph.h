@@ -0,0 +1,63 @@
+/* Copyright (c) 2015, The Linux Foundation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of The Linux Fundation, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef __INIT_GRAPH_H
+#define __INIT_GRAPH_H
+
+#include <sys/types.h>
+#include <kernel/event.h>
+
+#define INIT_TASK_MAX_DEPS 4
+
+/*
+ * A piece of bring-up work that runs on its own thread as soon as every
+ * task in deps (NULL terminated) has finished. Targets declare them
+ * statically; done and started belong to init_graph.c. Each task gets a
+ * boot_stats scope of its own name covering the time it actually ran.
+ */
+struct init_task {
+	const char *name;
+	void (*func)(void);
+	struct init_task *deps[INIT_TASK_MAX_DEPS];
+
+	event_t done;
+	bool started;
+};
+
+/* start a task; whatever it depends on has to be started first */
+void init_task_start(struct init_task *task);
+
+/* wait for a task to finish, any number of threads may join the same task.
+ * joining a task that was never started returns straight away */
+void init_task_join(struct init_task *task);
+
+/* start every task of a graph in array order, then join all of them */
+void init_graph_run(struct init_task **tasks, unsigned count);
+
+#endif
@@ -88,7 +88,12 @@
 
 #define MDP_HW_REV                              REG_MDP(0x0100)
 #define MDP_INTR_EN                             REG_MDP(0x0110)
+#define MDP_INTR_STATUS                         REG_MDP(0x0114)
 #define MDP_INTR_CLEAR                          REG_MDP(0x0118)
+
+#define MDP_INTR_PP0_DONE                       BIT(8)
+#define MDP_INTR_PP1_DONE                       BIT(9)
+#define MDP_INTR_PP_DONE_MASK                   (MDP_INTR_PP0_DONE | MDP_INTR_PP1_DONE)
 #define MDP_HIST_INTR_EN                        REG_MDP(0x011C)
 
 #define MDP_DISP_INTF_SEL                       REG_MDP(0x0104)
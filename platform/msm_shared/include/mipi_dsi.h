@@ -286,6 +286,8 @@ int mdp_get_revision(void);
 int mdp_dsi_cmd_off(void);
 int mdp_dma_on(struct msm_panel_info *pinfo);
 int mdp_dma_off(void);
+void mdss_mdp_set_scanout(struct msm_panel_info *pinfo, void *base);
+bool mdss_mdp_scanout_done(struct msm_panel_info *pinfo);
 int mdss_hdmi_init(void);
 int mdp_dsi_cmd_config(struct msm_panel_info *pinfo,
                 struct fbcon_config *fb);
@@ -170,6 +170,8 @@ unsigned long long partition_get_size(int index);
 unsigned long long partition_get_offset(int index);
 uint8_t partition_get_lun(int index);
 unsigned int partition_read_table(void);
+unsigned int partition_read_table_from_buffer(uint8_t *buffer, uint32_t len,
+					      uint32_t block_size, uint8_t lun);
 unsigned int write_partition(unsigned size, unsigned char *partition);
 bool partition_gpt_exists(void);
 /* Return the partition offset & size to app layer
@@ -180,6 +182,7 @@ struct partition_info partition_get_info(const char *name);
 
 /* For Debugging */
 void partition_dump(void);
+unsigned int calculate_crc32(unsigned char *buffer, int len);
 /* Read only attribute for partition */
 int partition_read_only(int index);
 #endif
@@ -124,6 +124,26 @@
 
 #define SDCC_HC_VENDOR_SPECIFIC_CAPABILITIES0     0x11C
 
+/*
+ * Tuning result remembered across boots. The mmc layer loads it for the
+ * card being initialized and stores it back once it changed.
+ */
+#define SDHCI_MSM_TUNING_REC_MAGIC                0x4e555443 /* "CTUN" */
+#define SDHCI_MSM_TUNING_REC_VERSION              1
+#define SDHCI_MSM_TUNING_PHASE_NONE               0xFFFFFFFF
+
+struct sdhci_msm_tuning_rec
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t cid[4];      /* raw CID of the card the phase belongs to */
+	uint32_t clk_rate;    /* host clock the sweep ran at */
+	uint32_t timing;      /* MMC_HS200_TIMING or MMC_HS400_TIMING */
+	uint32_t bus_width;
+	uint32_t phase;       /* selected DLL phase */
+	uint32_t crc;         /* crc32 of everything above */
+};
+
 struct sdhci_msm_data
 {
 	uint32_t pwrctl_base;
@@ -134,6 +154,8 @@ struct sdhci_msm_data
 	uint8_t slot;
 	uint8_t use_io_switch;
 	event_t*  sdhc_event;
+	struct sdhci_msm_tuning_rec *tuning_rec; /* NULL when not cached */
+	bool tuning_rec_dirty;
 };
 
 void sdhci_msm_init(struct sdhci_host *host, struct sdhci_msm_data *data);
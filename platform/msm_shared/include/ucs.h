@@ -164,6 +164,7 @@ struct scsi_failure_sense_data
 
 int ucs_scsi_send_inquiry(struct ufs_dev *dev);
 int ucs_do_scsi_read(struct ufs_dev *dev, struct scsi_rdwr_req *req);
+int ucs_do_scsi_read_batch(struct ufs_dev *dev, struct scsi_rdwr_req *req, int *status, uint32_t count);
 int ucs_do_scsi_write(struct ufs_dev *dev, struct scsi_rdwr_req *req);
 int ucs_do_scsi_unmap(struct ufs_dev *dev, struct scsi_unmap_req *req);
 /*
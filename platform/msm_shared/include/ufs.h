@@ -108,6 +108,16 @@ struct ufs_dev
 	struct ufs_uic_meta_data     uic_data;
 };
 
+/* One read of a ufs_read_batch(). start is a byte offset like ufs_read(). */
+struct ufs_read_req
+{
+	uint8_t  lun;
+	uint64_t start;
+	addr_t   buffer;
+	uint32_t num_blocks;
+	int      status;
+};
+
 /* Define all the basic WLUN type  */
 #define UFS_WLUN_REPORT          0x81
 #define UFS_UFS_DEVICE           0xD0
@@ -117,6 +127,7 @@ struct ufs_dev
 int ufs_init(struct ufs_dev *dev);
 int ufs_read(struct ufs_dev* dev, uint64_t start_lba, addr_t buffer, uint32_t num_blocks);
 int ufs_write(struct ufs_dev* dev, uint64_t start_lba, addr_t buffer, uint32_t num_blocks);
+int ufs_read_batch(struct ufs_dev* dev, struct ufs_read_req *req, uint32_t count);
 int ufs_erase(struct ufs_dev* dev, uint64_t start_lba, uint32_t num_blocks);
 uint64_t ufs_get_dev_capacity(struct ufs_dev* dev);
 uint32_t ufs_get_serial_num(struct ufs_dev* dev);
@@ -49,6 +49,9 @@
 #define UTP_GENERIC_CMD_TIMEOUT                            40000
 #define UTP_MAX_COMMAND_RETRY                              5000000
 
+/* Max requests queued by a single utp_enqueue_upiu_batch(). */
+#define UTP_MAX_BATCH                                      8
+
 struct utp_prdt_entry
 {
 	uint32_t data_base_addr;
@@ -145,6 +148,8 @@ struct utp_bitmap_access_type
 };
 
 int utp_enqueue_upiu(struct ufs_dev *dev, struct upiu_req_build_type *upiu_data);
+int utp_enqueue_upiu_batch(struct ufs_dev *dev, struct upiu_req_build_type *upiu_data,
+						   int *status, uint32_t count);
 void utp_process_req_completion(struct ufs_req_irq_type *irq);
 int utp_poll_utrd_complete(struct ufs_dev *dev);
 #endif
@@ -0,0 +1,100 @@
+/* Copyright (c) 2015, The Linux Foundation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of The Linux Fundation, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <debug.h>
+#include <assert.h>
+#include <kernel/thread.h>
+#include <kernel/event.h>
+#include <boot_stats.h>
+#include <init_graph.h>
+
+static int init_task_thread(void *arg)
+{
+	struct init_task *task = arg;
+	int bs_scope;
+	unsigned i;
+
+	for (i = 0; i < INIT_TASK_MAX_DEPS && task->deps[i]; i++)
+		event_wait(&task->deps[i]->done);
+
+	bs_scope = bs_scope_begin(task->name);
+	task->func();
+	bs_scope_end(bs_scope);
+
+	event_signal(&task->done, true);
+
+	return 0;
+}
+
+void init_task_start(struct init_task *task)
+{
+	unsigned i;
+
+	ASSERT(task && task->func);
+	ASSERT(!task->started);
+
+	/* a dependency started later could never be waited for */
+	for (i = 0; i < INIT_TASK_MAX_DEPS && task->deps[i]; i++)
+		ASSERT(task->deps[i]->started);
+
+	event_init(&task->done, false, 0);
+	task->started = true;
+
+#if WITH_INIT_GRAPH
+	thread_t *thr = thread_create(task->name, init_task_thread, task,
+			DEFAULT_PRIORITY, DEFAULT_STACK_SIZE);
+	if (thr) {
+		thread_detach_and_resume(thr);
+		return;
+	}
+
+	dprintf(CRITICAL, "init task %s: no thread, running it inline\n", task->name);
+#endif
+
+	init_task_thread(task);
+}
+
+void init_task_join(struct init_task *task)
+{
+	if (!task->started)
+		return;
+
+	event_wait(&task->done);
+}
+
+void init_graph_run(struct init_task **tasks, unsigned count)
+{
+	unsigned i;
+
+	for (i = 0; i < count; i++)
+		init_task_start(tasks[i]);
+
+	for (i = 0; i < count; i++)
+		init_task_join(tasks[i]);
+}
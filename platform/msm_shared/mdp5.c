@@ -1016,6 +1016,58 @@ int mdp_dma_on(struct msm_panel_info *pinfo)
 	return NO_ERROR;
 }
 
+/*
+ * Point the source pipe(s) at a new framebuffer and kick the flush. The
+ * SSPP address registers are double buffered, so a video interface keeps
+ * scanning the old buffer until the next vsync; a command panel latches
+ * it when the frame transfer started by CTL_START begins.
+ */
+void mdss_mdp_set_scanout(struct msm_panel_info *pinfo, void *base)
+{
+	uint32_t left_pipe, right_pipe;
+	uint32_t ctl0_reg_val, ctl1_reg_val;
+
+	mdp_select_pipe_type(pinfo, &left_pipe, &right_pipe);
+	writel((unsigned)base, left_pipe + PIPE_SSPP_SRC0_ADDR);
+	if (pinfo->lcdc.dual_pipe)
+		writel((unsigned)base, right_pipe + PIPE_SSPP_SRC0_ADDR);
+
+	if (pinfo->type == MIPI_CMD_PANEL)
+		writel(MDP_INTR_PP_DONE_MASK, MDP_INTR_CLEAR);
+
+	mdss_mdp_set_flush(pinfo, &ctl0_reg_val, &ctl1_reg_val);
+	writel(ctl0_reg_val, MDP_CTL_0_BASE + CTL_FLUSH);
+	if (pinfo->mipi.dual_dsi)
+		writel(ctl1_reg_val, MDP_CTL_1_BASE + CTL_FLUSH);
+
+	if (pinfo->type == MIPI_CMD_PANEL)
+		writel(0x01, MDP_CTL_0_BASE + CTL_START);
+}
+
+/*
+ * Returns true once the buffer handed to mdss_mdp_set_scanout() is the one
+ * being scanned out: the flush bits self clear when the hardware latches
+ * them, and command mode additionally waits for the ping-pong done of the
+ * frame transfer so the old buffer is no longer being read.
+ */
+bool mdss_mdp_scanout_done(struct msm_panel_info *pinfo)
+{
+	uint32_t pp_done = MDP_INTR_PP0_DONE;
+
+	if (readl(MDP_CTL_0_BASE + CTL_FLUSH))
+		return false;
+	if (pinfo->mipi.dual_dsi) {
+		if (readl(MDP_CTL_1_BASE + CTL_FLUSH))
+			return false;
+		pp_done |= MDP_INTR_PP1_DONE;
+	}
+
+	if (pinfo->type == MIPI_CMD_PANEL)
+		return (readl(MDP_INTR_STATUS) & pp_done) == pp_done;
+
+	return true;
+}
+
 void mdp_disable(void)
 {
 
@@ -32,6 +32,7 @@
 #include <smem.h>
 #include <mipi_dsi.h>
 #include <platform/iomap.h>
+#include <platform/msm_shared/timer.h>
 
 #define LPFR_LUT_SIZE 10
 
@@ -123,7 +124,7 @@ uint32_t mdss_dsi_pll_20nm_lock_status(uint32_t pll_base)
 {
 	uint32_t cnt, status;
 
-	udelay(1000);
+	mdelay(1);
 
 	/* check pll lock first */
 	for (cnt = 0; cnt < 5; cnt++) {
@@ -133,7 +134,7 @@ uint32_t mdss_dsi_pll_20nm_lock_status(uint32_t pll_base)
 		status &= 0x20; /* bit 5 */
 		if (status)
 			break;
-		udelay(5000);
+		mdelay(5);
 	}
 
 	if (!status)
@@ -147,7 +148,7 @@ uint32_t mdss_dsi_pll_20nm_lock_status(uint32_t pll_base)
 		status &= 0x40; /* bit 6 */
 		if (status)
 			break;
-		udelay(5000);
+		mdelay(5);
 	}
 
 pll_done:
@@ -201,7 +202,7 @@ static void pll_20nm_phy_config(uint32_t pll_base)
 	writel(0x00, pll_base + MMSS_DSI_PHY_PLL_ATB_SEL1);
 	writel(0x00, pll_base + MMSS_DSI_PHY_PLL_ATB_SEL2);
 	writel(0x4b, pll_base + MMSS_DSI_PHY_PLL_SYSCLK_EN_SEL_TXBAND);
-	udelay(1000);
+	mdelay(1);
 
 	pll_20nm_phy_kvco_config(pll_base);
 
@@ -222,7 +223,7 @@ static void pll_20nm_phy_config(uint32_t pll_base)
 	writel(0x0f, pll_base + MMSS_DSI_PHY_PLL_PLL_RXTXEPCLK_EN);
 
 	writel(0x0f, pll_base + MMSS_DSI_PHY_PLL_LOW_POWER_RO_CONTROL);
-	udelay(1000);
+	mdelay(1);
 
 	pll_20nm_phy_loop_bw_config(pll_base);
 }
@@ -289,6 +290,6 @@ int32_t mdss_dsi_auto_pll_20nm_config(uint32_t pll_base, uint32_t ctl_base,
 	 * Make sure that PLL vco configuration is complete
 	 * before controlling the state machine.
 	 */
-	udelay(1000);
+	mdelay(1);
 	dmb();
 }
@@ -213,7 +213,7 @@ void mdss_dsi_phy_sw_reset(uint32_t ctl_base)
 {
 	/* start phy sw reset */
 	writel(0x0001, ctl_base + 0x012c);
-	udelay(1000);
+	mdelay(1);
 
 	/* end phy sw reset */
 	writel(0x0000, ctl_base + 0x012c);
@@ -232,7 +232,7 @@ int mdss_dsi_phy_regulator_init(struct mdss_dsi_phy_ctrl *pd, uint32_t phy_base)
 		/* Regulator ctrl - CAL_PWD_CFG */
 		writel(pd->regulator[6], DSI0_PHY_BASE + off + (4 * 6));
 		/* Add h/w recommended delay */
-		udelay(1000);
+		mdelay(1);
 		/* Regulator ctrl - TEST */
 		writel(pd->regulator[5], DSI0_PHY_BASE + off + (4 * 5));
 		/* Regulator ctrl 3 */
@@ -257,7 +257,7 @@ int mdss_dsi_phy_regulator_init(struct mdss_dsi_phy_ctrl *pd, uint32_t phy_base)
 		/* Regulator ctrl - CAL_PWD_CFG */
 		writel(pd->regulator[6], DSI0_PHY_BASE + off + (4 * 6));
 		/* Add h/w recommended delay */
-		udelay(1000);
+		mdelay(1);
 		/* Regulator ctrl 1 */
 		writel(pd->regulator[1], DSI0_PHY_BASE + off + (4 * 1));
 		/* Regulator ctrl 2 */
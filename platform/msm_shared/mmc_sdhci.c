@@ -27,6 +27,7 @@
  */
 
 #include <err.h>
+#include <stddef.h>
 #include <string.h>
 #include <stdlib.h>
 #include <debug.h>
@@ -42,6 +43,7 @@
 #include <platform.h>
 #include <kernel/mutex.h>
 #include <printf.h>
+#include <boot_stats.h>
 
 #if WITH_LIB_BIO
 #include <lib/bio.h>
@@ -296,6 +298,8 @@ static uint32_t mmc_decode_and_save_cid(struct mmc_card *card,
 		return 1;
 	}
 
+	memcpy(card->raw_cid, raw_cid, sizeof(card->raw_cid));
+
 	mmc_sizeof = sizeof(uint32_t) * 8;
 
 	if (MMC_CARD_SD(card)) {
@@ -1487,6 +1491,160 @@ uint32_t mmc_sd_set_hs(struct sdhci_host *host, struct mmc_card *card)
  *           to the host.
  */
 
+#if MMC_TUNING_CACHE
+/*
+ * The HS200/HS400 tuning phase is cached in the last block of the
+ * MMC_TUNING_CACHE_PTN partition. With VERIFIED_BOOT the device info
+ * lives in the first block of devinfo, so a partition too small to keep
+ * the two apart is not used. The card is still at high speed
+ * timing and 1-bit width when the cache is loaded, so the partition is
+ * looked up straight from the primary GPT instead of through the
+ * partition parser, which needs a fully initialized device.
+ */
+#ifndef MMC_TUNING_CACHE_PTN
+#define MMC_TUNING_CACHE_PTN "devinfo"
+#endif
+
+static struct sdhci_msm_tuning_rec mmc_tuning_rec;
+static uint64_t mmc_tuning_rec_lba;
+
+static bool mmc_gpt_name_match(const uint8_t *utf16, const char *name)
+{
+	uint32_t i;
+
+	for (i = 0; i < MAX_GPT_NAME_SIZE / 2; i++) {
+		if (utf16[2 * i] != (uint8_t)name[i] || utf16[2 * i + 1])
+			return false;
+		if (!name[i])
+			return true;
+	}
+	return false;
+}
+
+/* Looks up the first and last lba of the named partition, returns 0 if found */
+static int mmc_gpt_find_ptn(struct mmc_device *dev, uint8_t *buf, const char *name,
+							uint64_t *first_lba, uint64_t *last_lba)
+{
+	uint64_t entries_lba;
+	uint32_t count, entry_size, i;
+	uint8_t *entry;
+
+	if (mmc_sdhci_read(dev, buf, 1, 1))
+		return -1;
+
+	if (((uint32_t *) buf)[0] != GPT_SIGNATURE_2 ||
+		((uint32_t *) buf)[1] != GPT_SIGNATURE_1)
+		return -1;
+
+	entries_lba = GET_LLWORD_FROM_BYTE(&buf[PARTITION_ENTRIES_OFFSET]);
+	count = GET_LWORD_FROM_BYTE(&buf[PARTITION_COUNT_OFFSET]);
+	entry_size = GET_LWORD_FROM_BYTE(&buf[PENTRY_SIZE_OFFSET]);
+
+	if (entry_size < ENTRY_SIZE || (BLOCK_SIZE % entry_size) || count > NUM_PARTITIONS)
+		return -1;
+
+	for (i = 0; i < count; i++) {
+		if ((i * entry_size) % BLOCK_SIZE == 0 &&
+			mmc_sdhci_read(dev, buf, entries_lba + (i * entry_size) / BLOCK_SIZE, 1))
+			return -1;
+
+		entry = buf + (i * entry_size) % BLOCK_SIZE;
+		if (mmc_gpt_name_match(entry + PARTITION_NAME_OFFSET, name)) {
+			*first_lba = GET_LLWORD_FROM_BYTE(&entry[FIRST_LBA_OFFSET]);
+			*last_lba = GET_LLWORD_FROM_BYTE(&entry[LAST_LBA_OFFSET]);
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+/*
+ * Function: mmc tuning cache load
+ * Arg     : mmc device structure
+ * Return  : None
+ * Flow    : Read the cached tuning record and hand it to the host. A record
+ *           for another card is dropped, the host then runs a full sweep
+ *           and fills in the phase for this one.
+ */
+static void mmc_tuning_cache_load(struct mmc_device *dev)
+{
+	struct sdhci_msm_tuning_rec *rec = &mmc_tuning_rec;
+	struct mmc_card *card = &dev->card;
+	uint64_t first_lba, last_lba;
+	uint8_t *buf;
+
+	if (card->type == MMC_TYPE_STD_MMC)
+		return;
+
+	buf = memalign(CACHE_LINE, ROUNDUP(BLOCK_SIZE, CACHE_LINE));
+	if (!buf)
+		return;
+
+	card->block_size = MMC_BLK_SZ;
+	if (mmc_gpt_find_ptn(dev, buf, MMC_TUNING_CACHE_PTN, &first_lba, &last_lba))
+		goto out;
+
+	/* the first block belongs to the device info */
+	if (last_lba <= first_lba) {
+		dprintf(INFO, "%s too small to cache the tuning phase\n", MMC_TUNING_CACHE_PTN);
+		goto out;
+	}
+	mmc_tuning_rec_lba = last_lba;
+
+	if (mmc_sdhci_read(dev, buf, mmc_tuning_rec_lba, 1))
+		memset(buf, 0, sizeof(*rec));
+	memcpy(rec, buf, sizeof(*rec));
+
+	if (rec->magic != SDHCI_MSM_TUNING_REC_MAGIC ||
+		rec->version != SDHCI_MSM_TUNING_REC_VERSION ||
+		rec->crc != calculate_crc32((unsigned char *) rec, offsetof(struct sdhci_msm_tuning_rec, crc)) ||
+		memcmp(rec->cid, card->raw_cid, sizeof(rec->cid))) {
+		memset(rec, 0, sizeof(*rec));
+		rec->magic = SDHCI_MSM_TUNING_REC_MAGIC;
+		rec->version = SDHCI_MSM_TUNING_REC_VERSION;
+		memcpy(rec->cid, card->raw_cid, sizeof(rec->cid));
+		rec->phase = SDHCI_MSM_TUNING_PHASE_NONE;
+	}
+
+	dev->host.msm_host->tuning_rec = rec;
+	dev->host.msm_host->tuning_rec_dirty = false;
+out:
+	free(buf);
+}
+
+/*
+ * Function: mmc tuning cache store
+ * Arg     : mmc device structure
+ * Return  : None
+ * Flow    : Write the record back if the host tuned to a different phase
+ */
+static void mmc_tuning_cache_store(struct mmc_device *dev)
+{
+	struct sdhci_msm_data *msm_host = dev->host.msm_host;
+	struct sdhci_msm_tuning_rec *rec = msm_host->tuning_rec;
+	uint8_t *buf;
+
+	if (!rec || !msm_host->tuning_rec_dirty)
+		return;
+
+	buf = memalign(CACHE_LINE, ROUNDUP(BLOCK_SIZE, CACHE_LINE));
+	if (!buf)
+		return;
+
+	rec->crc = calculate_crc32((unsigned char *) rec, offsetof(struct sdhci_msm_tuning_rec, crc));
+	memset(buf, 0, BLOCK_SIZE);
+	memcpy(buf, rec, sizeof(*rec));
+
+	if (mmc_sdhci_write(dev, buf, mmc_tuning_rec_lba, 1))
+		dprintf(CRITICAL, "Failed to store the tuning record\n");
+	else
+		msm_host->tuning_rec_dirty = false;
+
+	free(buf);
+}
+#endif
+
 static uint32_t mmc_card_init(struct mmc_device *dev)
 {
 	uint32_t mmc_return = 0;
@@ -1595,6 +1753,12 @@ static uint32_t mmc_card_init(struct mmc_device *dev)
 		else
 				bus_width = DATA_BUS_WIDTH_1BIT;
 
+#if MMC_TUNING_CACHE
+		/* Read the cached tuning record while still in 1-bit mode */
+		if (host->caps.hs400_support || host->caps.sdr104_support)
+			mmc_tuning_cache_load(dev);
+#endif
+
 		/* Set 4/8 bit SDR bus width in controller */
 		mmc_return = sdhci_set_bus_width(host, bus_width);
 
@@ -1702,6 +1866,11 @@ static uint32_t mmc_card_init(struct mmc_device *dev)
 		}
 	}
 
+#if MMC_TUNING_CACHE
+	if (!is_sdcard)
+		mmc_tuning_cache_store(dev);
+#endif
+
 	return mmc_return;
 }
 
@@ -1802,6 +1971,7 @@ struct mmc_device *mmc_init(struct mmc_config_data *data)
 {
 	uint8_t mmc_ret = 0;
 	struct mmc_device *dev;
+	int bs_scope;
 
 	dev = (struct mmc_device *) malloc (sizeof(struct mmc_device));
 
@@ -1816,12 +1986,15 @@ struct mmc_device *mmc_init(struct mmc_config_data *data)
 
 	memset((struct mmc_card *)&dev->card, 0, sizeof(struct mmc_card));
 
+	bs_scope = bs_scope_begin("mmc_init");
+
 	/* Initialize the host & clock */
 	dprintf(SPEW, " Initializing MMC host data structure and clock!\n");
 
 	mmc_ret = mmc_host_init(dev);
 	if (mmc_ret) {
 		dprintf(CRITICAL, "Error Initializing MMC host : %u\n", mmc_ret);
+		bs_scope_end(bs_scope);
 		return NULL;
 	}
 
@@ -1830,6 +2003,7 @@ struct mmc_device *mmc_init(struct mmc_config_data *data)
 	if (mmc_ret) {
 		dprintf(CRITICAL, "Failed detecting MMC/SDC @ slot%d\n",
 						  dev->config.slot);
+		bs_scope_end(bs_scope);
 		return NULL;
 	}
 
@@ -1858,6 +2032,8 @@ struct mmc_device *mmc_init(struct mmc_config_data *data)
 #endif
 #endif
 
+	bs_scope_end(bs_scope);
+
 	return dev;
 }
 
@@ -2198,7 +2374,7 @@ static uint32_t mmc_send_erase(struct mmc_device *dev, uint64_t erase_timeout)
 			dprintf(CRITICAL, "Write Protect set for the region, only partial space was erased\n");
 
 		retry++;
-		udelay(1000);
+		mdelay(1);
 		if (retry == MMC_MAX_CARD_STAT_RETRY)
 		{
 			dprintf(CRITICAL, "Card status check timed out after sending erase command\n");
@@ -2445,7 +2621,7 @@ uint32_t mmc_set_clr_power_on_wp_user(struct mmc_device *dev, uint32_t addr, uin
 
 		/* Time out for WP command */
 		retry++;
-		udelay(1000);
+		mdelay(1);
 		if (retry == MMC_MAX_CARD_STAT_RETRY)
 		{
 			dprintf(CRITICAL, "Card status timed out after sending write protect command\n");
@@ -39,6 +39,8 @@
 #include <partition_parser.h>
 #include <dme.h>
 #include <boot_device.h>
+#include <lib/evtrace.h>
+#include <boot_stats.h>
 
 /*
  * Weak function for UFS.
@@ -56,6 +58,11 @@ __WEAK int ufs_read(struct ufs_dev *dev, uint64_t data_addr, addr_t in, uint32_t
 	return 0;
 }
 
+__WEAK int ufs_read_batch(struct ufs_dev *dev, struct ufs_read_req *req, uint32_t count)
+{
+	return 1;
+}
+
 __WEAK uint32_t ufs_get_page_size(struct ufs_dev *dev)
 {
 	return 0;
@@ -127,6 +134,8 @@ uint32_t mmc_write(uint64_t data_addr, uint32_t data_len, void *in)
 	if (data_len % block_size)
 		data_len = ROUNDUP(data_len, block_size);
 
+	EVTRACE_STORAGE_WRITE(data_addr, data_len);
+
 	if (platform_boot_dev_isemmc())
 	{
 		/* TODO: This function is aware of max data that can be
@@ -139,6 +148,7 @@ uint32_t mmc_write(uint64_t data_addr, uint32_t data_len, void *in)
 			if (val)
 			{
 				dprintf(CRITICAL, "Failed Writing block @ %llx\n", (data_addr / block_size));
+				EVTRACE_STORAGE_WRITE_DONE(val, data_len);
 				return val;
 			}
 			sptr += write_size;
@@ -165,6 +175,8 @@ uint32_t mmc_write(uint64_t data_addr, uint32_t data_len, void *in)
 		}
 	}
 
+	EVTRACE_STORAGE_WRITE_DONE(val, data_len);
+
 	return val;
 }
 
@@ -188,6 +200,7 @@ uint32_t mmc_read(uint64_t data_addr, uint32_t *out, uint32_t data_len)
 	ASSERT(!(data_addr % block_size));
 	ASSERT(!(data_len % block_size));
 
+	EVTRACE_STORAGE_READ(data_addr, data_len);
 
 	if (platform_boot_dev_isemmc())
 	{
@@ -201,6 +214,7 @@ uint32_t mmc_read(uint64_t data_addr, uint32_t *out, uint32_t data_len)
 			if (ret)
 			{
 				dprintf(CRITICAL, "Failed Reading block @ %llx\n", (data_addr / block_size));
+				EVTRACE_STORAGE_READ_DONE(ret, data_len);
 				return ret;
 			}
 			sptr += read_size;
@@ -225,6 +239,8 @@ uint32_t mmc_read(uint64_t data_addr, uint32_t *out, uint32_t data_len)
 		arch_invalidate_cache_range((addr_t)out, data_len);
 	}
 
+	EVTRACE_STORAGE_READ_DONE(ret, data_len);
+
 	return ret;
 }
 
@@ -558,11 +574,56 @@ uint8_t mmc_get_lun(void)
 	return lun;
 }
 
+/*
+ * Function: ufs read gpt batch
+ * Arg     : ufs device, first and last + 1 lun, per lun table buffers
+ * Return  : 0 on success, non zero if the batch could not be issued
+ * Flow    : Queue the reads of the protective MBR, primary GPT header and
+ *           entry array of every lun with one door bell write, so the luns
+ *           are read back to back instead of with several small synchronous
+ *           reads each.
+ */
+static int ufs_read_gpt_batch(struct ufs_dev *dev, uint8_t first, uint8_t last,
+							  uint8_t *buf, uint32_t lun_len, uint32_t block_size)
+{
+	struct ufs_read_req *req;
+	uint8_t lun;
+	int ret;
+
+	req = (struct ufs_read_req *) calloc(last - first, sizeof(struct ufs_read_req));
+	if (!req)
+		return 1;
+
+	for (lun = first; lun < last; lun++)
+	{
+		req[lun - first].lun        = lun;
+		req[lun - first].start      = 0;
+		req[lun - first].buffer     = (addr_t) (buf + (lun - first) * lun_len);
+		req[lun - first].num_blocks = lun_len / block_size;
+	}
+
+	ret = ufs_read_batch(dev, req, last - first);
+
+	/* A lun whose read failed is left to the per lun fallback. */
+	for (lun = first; !ret && lun < last; lun++)
+	{
+		if (req[lun - first].status)
+			memset(buf + (lun - first) * lun_len, 0, lun_len);
+	}
+
+	free(req);
+	return ret;
+}
+
 void mmc_read_partition_table(uint8_t arg)
 {
 	void *dev;
 	uint8_t lun = 0;
 	uint8_t max_luns;
+	uint32_t block_size;
+	uint32_t lun_len;
+	uint8_t *buf = NULL;
+	int bs_scope;
 
 	dev = target_mmc_device();
 
@@ -572,8 +633,29 @@ void mmc_read_partition_table(uint8_t arg)
 
 		ASSERT(max_luns);
 
+		/* Protective MBR, primary GPT header and the full entry array. */
+		block_size = mmc_get_device_blocksize();
+		lun_len = block_size * 2 + ROUNDUP(NUM_PARTITIONS * ENTRY_SIZE, block_size);
+
+		bs_scope = bs_scope_begin("ufs_gpt_batch");
+		if (arg < max_luns)
+		{
+			buf = (uint8_t *) memalign(CACHE_LINE, ROUNDUP(lun_len * (max_luns - arg), CACHE_LINE));
+			if (buf && ufs_read_gpt_batch((struct ufs_dev *) dev, arg, max_luns, buf, lun_len, block_size))
+			{
+				dprintf(INFO, "UFS batched GPT read failed, reading luns one by one\n");
+				free(buf);
+				buf = NULL;
+			}
+		}
+		bs_scope_end(bs_scope);
+
 		for(lun = arg; lun < max_luns; lun++)
 		{
+			/* Only the primary GPT is batched, anything else takes the slow path. */
+			if (buf && !partition_read_table_from_buffer(buf + (lun - arg) * lun_len, lun_len, block_size, lun))
+				continue;
+
 			mmc_set_lun(lun);
 
 			if(partition_read_table())
@@ -582,6 +664,8 @@ void mmc_read_partition_table(uint8_t arg)
 			}
 		}
 		mmc_set_lun(0);
+
+		free(buf);
 	}
 	else
 	{
@@ -32,6 +32,7 @@
 #include <assert.h>
 #include <mmc.h>
 #include <partition_parser.h>
+#include <boot_stats.h>
 
 __WEAK void mmc_set_lun(uint8_t lun)
 {
@@ -68,6 +69,7 @@ static uint32_t partition_parse_gpt_header(uint8_t *buffer,
 										   uint32_t *header_size,
 										   uint32_t *max_partition_count);
 
+static unsigned int partition_fill_gpt_entry(uint8_t *entry, uint8_t lun);
 static uint32_t write_mbr(uint32_t, uint8_t *mbrImage, uint32_t block_size);
 static uint32_t write_gpt(uint32_t size, uint8_t *gptImage, uint32_t block_size);
 
@@ -86,6 +88,7 @@ unsigned int partition_read_table()
 {
 	unsigned int ret;
 	uint32_t block_size;
+	int bs_scope;
 
 	block_size = mmc_get_device_blocksize();
 
@@ -96,10 +99,13 @@ unsigned int partition_read_table()
 		ASSERT(partition_entries);
 	}
 
+	bs_scope = bs_scope_begin("partition_read_table");
+
 	/* Read MBR of the card */
 	ret = mmc_boot_read_mbr(block_size);
 	if (ret) {
 		dprintf(CRITICAL, "MMC Boot: MBR read failed!\n");
+		bs_scope_end(bs_scope);
 		return 1;
 	}
 
@@ -108,9 +114,12 @@ unsigned int partition_read_table()
 		ret = mmc_boot_read_gpt(block_size);
 		if (ret) {
 			dprintf(CRITICAL, "MMC Boot: GPT read failed!\n");
+			bs_scope_end(bs_scope);
 			return 1;
 		}
 	}
+
+	bs_scope_end(bs_scope);
 	return 0;
 }
 
@@ -253,8 +262,6 @@ static unsigned int mmc_boot_read_gpt(uint32_t block_size)
 	unsigned int partition_entry_size;
 	unsigned int i = 0;	/* Counter for each block */
 	unsigned int j = 0;	/* Counter for each entry in a block */
-	unsigned int n = 0;	/* Counter for UTF-16 -> 8 conversion */
-	unsigned char UTF16_name[MAX_GPT_NAME_SIZE];
 	/* LBA of first partition -- 1 Block after Protected MBR + 1 for PT */
 	unsigned long long partition_0;
 	uint64_t device_density;
@@ -327,59 +334,11 @@ static unsigned int mmc_boot_read_gpt(uint32_t block_size)
 		}
 
 		for (j = 0; j < part_entry_cnt; j++) {
-			memcpy(&(partition_entries[partition_count].type_guid),
-			       &data[(j * partition_entry_size)],
-			       PARTITION_TYPE_GUID_SIZE);
-			if (partition_entries[partition_count].type_guid[0] ==
-			    0x00
-			    && partition_entries[partition_count].
-			    type_guid[1] == 0x00) {
-#if WITH_XIAOMI_DUALBOOT && TARGET_MSM8960_ARIES
-				if(partition_count==1 || partition_count==18 || partition_count==23) {
-					partition_count++;
-					continue;
-				}
-#endif
+			if (partition_fill_gpt_entry(&data[(j * partition_entry_size)],
+						     mmc_get_lun())) {
 				i = ROUNDUP(max_partition_count, part_entry_cnt);
 				break;
 			}
-			memcpy(&
-			       (partition_entries[partition_count].
-				unique_partition_guid),
-			       &data[(j * partition_entry_size) +
-				     UNIQUE_GUID_OFFSET],
-			       UNIQUE_PARTITION_GUID_SIZE);
-			partition_entries[partition_count].first_lba =
-			    GET_LLWORD_FROM_BYTE(&data
-						 [(j * partition_entry_size) +
-						  FIRST_LBA_OFFSET]);
-			partition_entries[partition_count].last_lba =
-			    GET_LLWORD_FROM_BYTE(&data
-						 [(j * partition_entry_size) +
-						  LAST_LBA_OFFSET]);
-			partition_entries[partition_count].size =
-			    partition_entries[partition_count].last_lba -
-			    partition_entries[partition_count].first_lba + 1;
-			partition_entries[partition_count].attribute_flag =
-			    GET_LLWORD_FROM_BYTE(&data
-						 [(j * partition_entry_size) +
-						  ATTRIBUTE_FLAG_OFFSET]);
-
-			memset(&UTF16_name, 0x00, MAX_GPT_NAME_SIZE);
-			memcpy(UTF16_name, &data[(j * partition_entry_size) +
-						 PARTITION_NAME_OFFSET],
-			       MAX_GPT_NAME_SIZE);
-			partition_entries[partition_count].lun = mmc_get_lun();
-
-			/*
-			 * Currently partition names in *.xml are UTF-8 and lowercase
-			 * Only supporting english for now so removing 2nd byte of UTF-16
-			 */
-			for (n = 0; n < MAX_GPT_NAME_SIZE / 2; n++) {
-				partition_entries[partition_count].name[n] =
-				    UTF16_name[n * 2];
-			}
-			partition_count++;
 		}
 	}
 end:
@@ -389,6 +348,130 @@ end:
 	return ret;
 }
 
+/*
+ * Fill the next slot of partition_entries from one GPT partition entry.
+ * Return 1 once the unused entry terminating the array is reached.
+ */
+static unsigned int partition_fill_gpt_entry(uint8_t *entry, uint8_t lun)
+{
+	unsigned int n = 0;	/* Counter for UTF-16 -> 8 conversion */
+	unsigned char UTF16_name[MAX_GPT_NAME_SIZE];
+
+	memcpy(&(partition_entries[partition_count].type_guid), entry,
+	       PARTITION_TYPE_GUID_SIZE);
+	if (partition_entries[partition_count].type_guid[0] == 0x00 &&
+	    partition_entries[partition_count].type_guid[1] == 0x00) {
+#if WITH_XIAOMI_DUALBOOT && TARGET_MSM8960_ARIES
+		if(partition_count==1 || partition_count==18 || partition_count==23) {
+			partition_count++;
+			return 0;
+		}
+#endif
+		return 1;
+	}
+	memcpy(&(partition_entries[partition_count].unique_partition_guid),
+	       &entry[UNIQUE_GUID_OFFSET], UNIQUE_PARTITION_GUID_SIZE);
+	partition_entries[partition_count].first_lba =
+	    GET_LLWORD_FROM_BYTE(&entry[FIRST_LBA_OFFSET]);
+	partition_entries[partition_count].last_lba =
+	    GET_LLWORD_FROM_BYTE(&entry[LAST_LBA_OFFSET]);
+	partition_entries[partition_count].size =
+	    partition_entries[partition_count].last_lba -
+	    partition_entries[partition_count].first_lba + 1;
+	partition_entries[partition_count].attribute_flag =
+	    GET_LLWORD_FROM_BYTE(&entry[ATTRIBUTE_FLAG_OFFSET]);
+
+	memset(&UTF16_name, 0x00, MAX_GPT_NAME_SIZE);
+	memcpy(UTF16_name, &entry[PARTITION_NAME_OFFSET], MAX_GPT_NAME_SIZE);
+	partition_entries[partition_count].lun = lun;
+
+	/*
+	 * Currently partition names in *.xml are UTF-8 and lowercase
+	 * Only supporting english for now so removing 2nd byte of UTF-16
+	 */
+	for (n = 0; n < MAX_GPT_NAME_SIZE / 2; n++) {
+		partition_entries[partition_count].name[n] =
+		    UTF16_name[n * 2];
+	}
+	partition_count++;
+
+	return 0;
+}
+
+/*
+ * Parse the partition table of one LUN from a buffer holding its first
+ * blocks: protective MBR, primary GPT header and the entry array. Both
+ * GPT CRCs are checked since nothing re-reads the table from the device.
+ * Returns non zero if the buffer does not hold a valid primary GPT, in
+ * which case the caller should fall back to partition_read_table(), which
+ * also knows about plain MBR layouts and the backup GPT.
+ */
+unsigned int partition_read_table_from_buffer(uint8_t *buffer, uint32_t len,
+					      uint32_t block_size, uint8_t lun)
+{
+	uint8_t *header = buffer + block_size;
+	unsigned long long first_usable_lba;
+	unsigned long long partition_0;
+	unsigned int partition_entry_size;
+	unsigned int header_size;
+	unsigned int max_partition_count;
+	unsigned int crc;
+	unsigned int i;
+
+	if (!partition_entries)
+	{
+		partition_entries = (struct partition_entry *) calloc(NUM_PARTITIONS, sizeof(struct partition_entry));
+		ASSERT(partition_entries);
+	}
+
+	if (len < 2 * block_size || partition_verify_mbr_signature(block_size, buffer))
+		return 1;
+
+	if (buffer[TABLE_ENTRY_0 + OFFSET_TYPE] != MBR_PROTECTED_TYPE)
+		return 1;
+
+	if (partition_parse_gpt_header(header, &first_usable_lba,
+				       &partition_entry_size, &header_size,
+				       &max_partition_count)) {
+		dprintf(INFO, "GPT: (WARNING) Primary signature invalid\n");
+		return 1;
+	}
+
+	if (header_size < PARTITION_CRC_OFFSET + 4 || header_size > block_size)
+		return 1;
+
+	crc = GET_LWORD_FROM_BYTE(&header[HEADER_CRC_OFFSET]);
+	PUT_LONG(header + HEADER_CRC_OFFSET, 0);
+	if (calculate_crc32(header, header_size) != crc) {
+		dprintf(INFO, "GPT: (WARNING) Primary header crc mismatch\n");
+		return 1;
+	}
+
+	partition_0 = GET_LLWORD_FROM_BYTE(&header[PARTITION_ENTRIES_OFFSET]);
+	if (partition_entry_size != ENTRY_SIZE || partition_0 < 2 ||
+	    max_partition_count > NUM_PARTITIONS ||
+	    partition_0 * block_size + max_partition_count * ENTRY_SIZE > len)
+		return 1;
+
+	crc = GET_LWORD_FROM_BYTE(&header[PARTITION_CRC_OFFSET]);
+	if (calculate_crc32(buffer + partition_0 * block_size,
+			    max_partition_count * ENTRY_SIZE) != crc) {
+		dprintf(INFO, "GPT: (WARNING) Primary entry array crc mismatch\n");
+		return 1;
+	}
+
+	gpt_partitions_exist = 1;
+
+	for (i = 0; i < max_partition_count; i++) {
+		ASSERT(partition_count < NUM_PARTITIONS);
+		if (partition_fill_gpt_entry(buffer + partition_0 * block_size +
+					     i * ENTRY_SIZE, lun))
+			break;
+	}
+
+	return 0;
+}
+
 static unsigned int write_mbr_in_blocks(uint32_t size, uint8_t *mbrImage, uint32_t block_size)
 {
 	unsigned int dtype;
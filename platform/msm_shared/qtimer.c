@@ -89,12 +89,39 @@ static void delay(uint64_t ticks)
 }
 
 
+#if WITH_INIT_GRAPH
+/* thread_sleep() returns on the first scheduler tick (10ms, see
+ * kernel/timer.c) past its deadline */
+#define DELAY_SLEEP_SLACK_MS	10
+#endif
+
+/*
+ * Millisecond waits (panel, pmic and card power sequencing mostly) give
+ * the cpu away once threads run: the whole scheduler ticks they span are
+ * slept through, the rest is spent yielding to any other ready thread
+ * until the exact deadline. Early init, interrupt context and callers
+ * with interrupts off still spin. udelay() always spins; anything of a
+ * millisecond or more belongs here.
+ */
 void mdelay(unsigned msecs)
 {
 	uint64_t ticks;
 
 	ticks = ((uint64_t) msecs * ticks_per_sec) / 1000;
 
+#if WITH_INIT_GRAPH
+	if (!in_critical_section()) {
+		uint64_t timeout = qtimer_get_phy_timer_cnt() + ticks;
+
+		if (msecs > DELAY_SLEEP_SLACK_MS)
+			thread_sleep(msecs - DELAY_SLEEP_SLACK_MS);
+
+		while (qtimer_get_phy_timer_cnt() < timeout)
+			thread_yield();
+		return;
+	}
+#endif
+
 	delay(ticks);
 }
 
@@ -35,6 +35,7 @@
 #include <debug.h>
 #include <stdlib.h>
 #include <platform/timer.h>
+#include <kernel/mutex.h>
 
 #define RPM_REQ_MAGIC 0x00716572
 #define RPM_CMD_MAGIC 0x00646d63
@@ -44,6 +45,8 @@
 
 static uint32_t msg_id;
 smd_channel_info_t ch;
+/* one request and its ack at a time on the channel */
+static mutex_t rpm_lock = MUTEX_INITIAL_VALUE(rpm_lock);
 
 void rpm_smd_init()
 {
@@ -79,6 +82,8 @@ int rpm_send_data(uint32_t *data, uint32_t len, msg_type type)
 	uint32_t rlen = 0;
 	void *smd_data = NULL;
 
+	mutex_acquire(&rpm_lock);
+
 	switch(type)
 	{
 		case RPM_REQUEST_TYPE:
@@ -124,6 +129,8 @@ int rpm_send_data(uint32_t *data, uint32_t len, msg_type type)
 		break;
 	}
 
+	mutex_release(&rpm_lock);
+
 	return ret;
 }
 
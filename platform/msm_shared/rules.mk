@@ -5,6 +5,30 @@ MODULE := $(LOCAL_DIR)
 MODULE_DEPS += \
 	lib/openssl
 
+# hand debug output to a low priority drain thread instead of feeding
+# every sink inline, one character at a time
+ENABLE_DEFERRED_DEBUG_LOG ?= 1
+ifeq ($(ENABLE_DEFERRED_DEBUG_LOG),1)
+MODULE_DEPS += lib/cbuf
+GLOBAL_DEFINES += WITH_DEBUG_LOG_DEFERRED=1
+endif
+
+# map LK memory write back, write allocate instead of write through; the
+# dma drivers do their own clean/invalidate around every transfer. the
+# platforms map LK and scratch memory with MMU_MEMORY_TYPE_NORMAL_LK, and
+# keep framebuffers the MDP scans out of write through
+ENABLE_LK_WRITE_BACK ?= 0
+ifeq ($(ENABLE_LK_WRITE_BACK),1)
+GLOBAL_DEFINES += LK_MEMORY_WRITE_BACK=1
+endif
+
+# run init tasks on threads of their own and let mdelay() sleep instead
+# of spinning; with this off every task runs inline when it is started
+ENABLE_INIT_GRAPH ?= 1
+ifeq ($(ENABLE_INIT_GRAPH),1)
+GLOBAL_DEFINES += WITH_INIT_GRAPH=1
+endif
+
 GLOBAL_INCLUDES += \
 	$(LOCAL_DIR) \
 	$(LOCAL_DIR)/include
@@ -21,6 +45,7 @@ MODULE_SRCS += \
 	$(LOCAL_DIR)/partition_parser.c \
 	$(LOCAL_DIR)/hsusb.c \
 	$(LOCAL_DIR)/boot_stats.c \
+	$(LOCAL_DIR)/init_graph.c \
 	$(LOCAL_DIR)/qgic_common.c
 	
 ifeq ($(ENABLE_QGIC3), 1)
@@ -566,6 +591,27 @@ ifeq ($(ENABLE_USB30_SUPPORT),1)
 		$(LOCAL_DIR)/usb30_wrapper.c
 endif
 
+# cache the eMMC HS200/HS400 tuning phase across boots
+ENABLE_MMC_TUNING_CACHE ?= 1
+ifeq ($(ENABLE_MMC_TUNING_CACHE),1)
+GLOBAL_DEFINES += MMC_TUNING_CACHE=1
+endif
+
+# export the boot_stats scopes to the kernel under /chosen; grows the
+# dtb padding aboot reserves, so it is global
+ENABLE_BOOT_STATS_DTB ?= 0
+ifeq ($(ENABLE_BOOT_STATS_DTB),1)
+GLOBAL_DEFINES += BOOT_STATS_DTB=1
+endif
+
+# page flipping needs the mdp5 source pipe, mdp3 targets keep one buffer
+ENABLE_DISPLAY_DOUBLE_BUFFER ?= 1
+ifeq ($(ENABLE_DISPLAY_DOUBLE_BUFFER),1)
+ifneq ($(filter $(LOCAL_DIR)/mdp5.c,$(MODULE_SRCS)),)
+GLOBAL_DEFINES += DISPLAY_DOUBLE_BUFFER=1
+endif
+endif
+
 include make/module.mk
 
 include target/$(TARGET)/tools/makefile
@@ -40,6 +40,7 @@
 #include <sdhci.h>
 #include <sdhci_msm.h>
 #include <platform/msm_shared/timer.h>
+#include <lib/evtrace.h>
 
 static void sdhci_dumpregs(struct sdhci_host *host)
 {
@@ -701,6 +702,12 @@ static struct desc_entry *sdhci_adma_transfer(struct sdhci_host *host,
 	else
 		sz = num_blks * SDHCI_MMC_BLK_SZ;
 
+	/*
+	 * Writes need the cpu's data in memory. Reads are cleaned too so
+	 * that no dirty line gets evicted on top of the incoming data.
+	 */
+	arch_clean_invalidate_cache_range((addr_t) data, sz);
+
 	/* Prepare adma descriptor table */
 	adma_addr = sdhci_prep_desc_table(data, sz);
 
@@ -743,17 +750,18 @@ uint32_t sdhci_send_command(struct sdhci_host *host, struct mmc_command *cmd)
 	DBG("\n %s: START: cmd:%04d, arg:0x%08x, resp_type:0x%04x, data_present:%d\n",
 				__func__, cmd->cmd_index, cmd->argument, cmd->resp_type, cmd->data_present);
 
+	EVTRACE_SDHCI_CMD(cmd->cmd_index, cmd->argument);
+
 	if (cmd->data_present)
 		ASSERT(cmd->data.data_ptr);
 
 	/*
 	 * Assert if the data buffer is not aligned to cache
 	 * line size for read operations.
-	 * For write operations this function assumes that
-	 * the cache is already flushed by the caller. As
-	 * the data buffer we receive for write operation
-	 * may not be aligned to cache boundary due to
-	 * certain image formats like sparse image.
+	 * Write buffers are not checked, as the data buffer
+	 * we receive for write operation may not be aligned
+	 * to cache boundary due to certain image formats like
+	 * sparse image; cleaning them is harmless.
 	 */
 	if (cmd->trans_mode == SDHCI_READ_MODE)
 		ASSERT(IS_CACHE_LINE_ALIGNED(cmd->data.data_ptr));
@@ -765,7 +773,7 @@ uint32_t sdhci_send_command(struct sdhci_host *host, struct mmc_command *cmd)
 
 		if (!present_state)
 			break;
-		udelay(1000);
+		mdelay(1);
 		retry++;
 		if (retry == 10) {
 			dprintf(CRITICAL, "Error: CMD or DAT lines were never freed\n");
@@ -222,6 +222,8 @@ void sdhci_msm_init(struct sdhci_host *host, struct sdhci_msm_data *config)
 
 	config->tuning_done = false;
 	config->calibration_done = false;
+	config->tuning_rec = NULL;
+	config->tuning_rec_dirty = false;
 	host->tuning_in_progress = false;
 }
 
@@ -653,6 +655,79 @@ static uint32_t sdhci_msm_hs400_calibration(struct sdhci_host *host)
 	return 0;
 }
 
+/* Read the tuning block with the current DLL setting, 0 if it matched */
+static int sdhci_msm_send_tuning_block(struct sdhci_host *host, uint32_t *tuning_data,
+									   const uint32_t *tuning_block, uint32_t size)
+{
+	struct mmc_command cmd = {0};
+
+	cmd.cmd_index = CMD21_SEND_TUNING_BLOCK;
+	cmd.argument = 0x0;
+	cmd.cmd_type = SDHCI_CMD_TYPE_NORMAL;
+	cmd.resp_type = SDHCI_CMD_RESP_R1;
+	cmd.trans_mode = SDHCI_MMC_READ;
+	cmd.data_present = 0x1;
+	cmd.data.data_ptr = tuning_data;
+	cmd.data.blk_sz = size;
+	cmd.data.num_blocks = 0x1;
+
+	/* send command */
+	if (sdhci_send_command(host, &cmd))
+		return 1;
+
+	return memcmp(tuning_data, tuning_block, size) ? 1 : 0;
+}
+
+/*
+ * Apply the phase cached from an earlier boot and check it with a single
+ * tuning block. Any mismatch in the key, a CRC error or bad data sends
+ * the caller back to the full sweep.
+ */
+static bool sdhci_msm_use_cached_phase(struct sdhci_host *host, uint32_t bus_width,
+									   uint32_t *tuning_data,
+									   const uint32_t *tuning_block, uint32_t size)
+{
+	struct sdhci_msm_tuning_rec *rec = host->msm_host->tuning_rec;
+
+	if (!rec || rec->phase >= MAX_PHASES)
+		return false;
+
+	if (rec->clk_rate != host->cur_clk_rate || rec->timing != host->timing ||
+		rec->bus_width != bus_width)
+		return false;
+
+	if (sdhci_msm_config_dll(host, rec->phase))
+		return false;
+
+	if (sdhci_msm_send_tuning_block(host, tuning_data, tuning_block, size))
+	{
+		dprintf(INFO, "Cached tuning phase %u failed, running full tuning\n", rec->phase);
+		return false;
+	}
+
+	host->msm_host->saved_phase = rec->phase;
+	return true;
+}
+
+static void sdhci_msm_update_cached_phase(struct sdhci_host *host, uint32_t bus_width,
+										  uint32_t phase)
+{
+	struct sdhci_msm_tuning_rec *rec = host->msm_host->tuning_rec;
+
+	if (!rec)
+		return;
+
+	if (rec->phase == phase && rec->clk_rate == host->cur_clk_rate &&
+		rec->timing == host->timing && rec->bus_width == bus_width)
+		return;
+
+	rec->phase = phase;
+	rec->clk_rate = host->cur_clk_rate;
+	rec->timing = host->timing;
+	rec->bus_width = bus_width;
+	host->msm_host->tuning_rec_dirty = true;
+}
+
 /*
  * Function: sdhci msm execute tuning
  * Arg     : Host structure & bus width
@@ -711,14 +786,16 @@ uint32_t sdhci_msm_execute_tuning(struct sdhci_host *host, struct mmc_card *card
 			goto free;
 	}
 
+	/* Skip the sweep when the phase from the last boot still works */
+	if (sdhci_msm_use_cached_phase(host, bus_width, tuning_data, tuning_block, size))
+		goto free;
+
 retry_tuning:
 	tuned_phase_cnt = 0;
 	phase = 0;
 
 	while (phase < MAX_PHASES)
 	{
-		struct mmc_command cmd = {0};
-
 		/* configure dll to set phase delay */
 		if (sdhci_msm_config_dll(host, phase))
 		{
@@ -726,18 +803,7 @@ retry_tuning:
 			goto free;
 		}
 
-		cmd.cmd_index = CMD21_SEND_TUNING_BLOCK;
-		cmd.argument = 0x0;
-		cmd.cmd_type = SDHCI_CMD_TYPE_NORMAL;
-		cmd.resp_type = SDHCI_CMD_RESP_R1;
-		cmd.trans_mode = SDHCI_MMC_READ;
-		cmd.data_present = 0x1;
-		cmd.data.data_ptr = tuning_data;
-		cmd.data.blk_sz = size;
-		cmd.data.num_blocks = 0x1;
-
-		/* send command */
-		if (!sdhci_send_command(host, &cmd) && !memcmp(tuning_data, tuning_block, size))
+		if (!sdhci_msm_send_tuning_block(host, tuning_data, tuning_block, size))
 				tuned_phases[tuned_phase_cnt++] = phase;
 
 		phase++;
@@ -790,6 +856,7 @@ retry_tuning:
 
 		/* Save the tuned phase */
 		host->msm_host->saved_phase = phase;
+		sdhci_msm_update_cached_phase(host, bus_width, phase);
 	}
 	else
 	{
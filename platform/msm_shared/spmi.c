@@ -35,6 +35,7 @@
 #include <platform/iomap.h>
 #include <platform/irqs.h>
 #include <platform/interrupts.h>
+#include <kernel/thread.h>
 
 #define PMIC_ARB_V2 0x20010000
 #define CHNL_IDX(sid, pid) ((sid << 8) | pid)
@@ -125,8 +126,8 @@ static void write_wdata_from_array(uint8_t *array,
  *
  * return value : 0 if success, the error bit set on error
  */
-unsigned int pmic_arb_write_cmd(struct pmic_arb_cmd *cmd,
-                                struct pmic_arb_param *param)
+static unsigned int __pmic_arb_write_cmd(struct pmic_arb_cmd *cmd,
+                                         struct pmic_arb_param *param)
 {
 	uint8_t bytes_written = 0;
 	uint32_t error;
@@ -237,8 +238,8 @@ static void read_rdata_into_array(uint8_t *array,
  *
  * return value : 0 if success, the error bit set on error
  */
-unsigned int pmic_arb_read_cmd(struct pmic_arb_cmd *cmd,
-                               struct pmic_arb_param *param)
+static unsigned int __pmic_arb_read_cmd(struct pmic_arb_cmd *cmd,
+                                        struct pmic_arb_param *param)
 {
 	uint32_t val = 0;
 	uint32_t error;
@@ -321,6 +322,35 @@ unsigned int pmic_arb_read_cmd(struct pmic_arb_cmd *cmd,
 }
 
 
+/* The channel number and the channel registers are shared by every
+ * caller: init tasks on other threads and timer callbacks (the vibrator)
+ * included. Each command is issued with interrupts off so it runs to
+ * completion on its own; a command only takes a few microseconds.
+ */
+unsigned int pmic_arb_write_cmd(struct pmic_arb_cmd *cmd,
+                                struct pmic_arb_param *param)
+{
+	unsigned int ret;
+
+	enter_critical_section();
+	ret = __pmic_arb_write_cmd(cmd, param);
+	exit_critical_section();
+
+	return ret;
+}
+
+unsigned int pmic_arb_read_cmd(struct pmic_arb_cmd *cmd,
+                               struct pmic_arb_param *param)
+{
+	unsigned int ret;
+
+	enter_critical_section();
+	ret = __pmic_arb_read_cmd(cmd, param);
+	exit_critical_section();
+
+	return ret;
+}
+
 /* Funtion to determine if the peripheral that caused the interrupt
  * is of interest.
  * Also handles callback function and interrupt clearing if the
@@ -31,6 +31,7 @@
 #include <endian.h>
 #include <string.h>
 #include <utp.h>
+#include <lib/evtrace.h>
 
 static int ucs_do_request_sense(struct ufs_dev *dev);
 
@@ -40,6 +41,8 @@ int ucs_do_scsi_cmd(struct ufs_dev *dev, struct scsi_req_build_type *req)
 	struct upiu_basic_hdr      resp_upiu;
 	int                        ret;
 
+	EVTRACE_UFS_SCSI_CMD(*((uint8_t *)(req->cdb)), req->lun);
+
 	memset(&req_upiu, 0 , sizeof(struct upiu_req_build_type));
 
 	req_upiu.cmd_set_type	   = UPIU_SCSI_CMD_SET;
@@ -58,12 +61,23 @@ int ucs_do_scsi_cmd(struct ufs_dev *dev, struct scsi_req_build_type *req)
 	req_upiu.resp_len		   = sizeof(resp_upiu);
 	req_upiu.timeout_msecs	   = UTP_GENERIC_CMD_TIMEOUT;
 
+	/*
+	 * Write back anything the cpu put in the data buffer and drop any
+	 * lines that could otherwise be evicted on top of incoming data.
+	 */
+	if (req->data_len)
+		arch_clean_invalidate_cache_range((addr_t) req->data_buffer_addr, req->data_len);
+
 	if (utp_enqueue_upiu(dev, &req_upiu))
 	{
 		dprintf(CRITICAL, "ucs_do_scsi_cmd: enqueue failed\n");
 		return -UFS_FAILURE;
 	}
 
+	/* Drop anything speculatively fetched while the device was writing. */
+	if (req->data_len && (req->flags & UPIU_FLAGS_READ))
+		arch_invalidate_cache_range((addr_t) req->data_buffer_addr, req->data_len);
+
 	if (resp_upiu.status != SCSI_STATUS_GOOD)
 	{
 		if (resp_upiu.status == SCSI_STATUS_CHK_COND && (*((uint8_t *)(req->cdb)) != SCSI_CMD_SENSE_REQ))
@@ -244,6 +258,87 @@ int ucs_do_scsi_read(struct ufs_dev *dev, struct scsi_rdwr_req *req)
 	return UFS_SUCCESS;
 }
 
+/* Issue several independent reads as queued UFS commands. Each request must fit in a
+ * single READ10; status[i] reports the outcome of req[i].
+ */
+int ucs_do_scsi_read_batch(struct ufs_dev *dev, struct scsi_rdwr_req *req, int *status, uint32_t count)
+{
+	struct scsi_rdwr_cdb       cdb[UTP_MAX_BATCH];
+	struct upiu_req_build_type req_upiu[UTP_MAX_BATCH];
+	struct upiu_basic_hdr      resp_upiu[UTP_MAX_BATCH];
+	uint32_t                   data_len;
+	uint32_t                   batch;
+	uint32_t                   i;
+
+	while (count)
+	{
+		batch = MIN(count, UTP_MAX_BATCH);
+
+		for (i = 0; i < batch; i++)
+		{
+			if (!req[i].num_blocks || req[i].num_blocks > SCSI_MAX_DATA_TRANS_BLK_LEN)
+				return -UFS_FAILURE;
+
+			data_len = req[i].num_blocks * UFS_DEFAULT_SECTORE_SIZE;
+
+			memset(&cdb[i], 0, sizeof(struct scsi_rdwr_cdb));
+			cdb[i].opcode    = SCSI_CMD_READ10;
+			cdb[i].cdb1      = SCSI_READ_WRITE_10_CDB1(0, 0, 1, 0);
+			cdb[i].lba       = BE32(req[i].start_lba);
+			cdb[i].trans_len = BE16(req[i].num_blocks);
+
+			EVTRACE_UFS_SCSI_CMD(SCSI_CMD_READ10, req[i].lun);
+
+			memset(&req_upiu[i], 0, sizeof(struct upiu_req_build_type));
+
+			req_upiu[i].cmd_set_type      = UPIU_SCSI_CMD_SET;
+			req_upiu[i].trans_type        = UPIU_TYPE_COMMAND;
+			req_upiu[i].data_buffer_addr  = req[i].data_buffer_base;
+			req_upiu[i].expected_data_len = data_len;
+			req_upiu[i].flags             = UPIU_FLAGS_READ;
+			req_upiu[i].lun               = req[i].lun;
+			req_upiu[i].cdb               = (addr_t) &cdb[i];
+			req_upiu[i].cmd_type          = UTRD_SCSCI_CMD;
+			req_upiu[i].dd                = UTRD_TARGET_TO_SYSTEM;
+			req_upiu[i].resp_ptr          = &resp_upiu[i];
+			req_upiu[i].resp_len          = sizeof(struct upiu_basic_hdr);
+			req_upiu[i].timeout_msecs     = UTP_GENERIC_CMD_TIMEOUT;
+
+			arch_clean_invalidate_cache_range((addr_t) req[i].data_buffer_base, data_len);
+		}
+
+		if (utp_enqueue_upiu_batch(dev, req_upiu, status, batch))
+		{
+			dprintf(CRITICAL, "ucs_do_scsi_read_batch: enqueue failed\n");
+			return -UFS_FAILURE;
+		}
+
+		for (i = 0; i < batch; i++)
+		{
+			arch_invalidate_cache_range((addr_t) req[i].data_buffer_base,
+										req[i].num_blocks * UFS_DEFAULT_SECTORE_SIZE);
+
+			if (status[i])
+				continue;
+
+			if (resp_upiu[i].status != SCSI_STATUS_GOOD)
+			{
+				if (resp_upiu[i].status == SCSI_STATUS_CHK_COND && ucs_do_request_sense(dev))
+					dprintf(CRITICAL, "SCSI request sense failed.\n");
+
+				dprintf(CRITICAL, "ucs_do_scsi_read_batch: lun %u failed status = %x\n", req[i].lun, resp_upiu[i].status);
+				status[i] = -UFS_FAILURE;
+			}
+		}
+
+		req    += batch;
+		status += batch;
+		count  -= batch;
+	}
+
+	return UFS_SUCCESS;
+}
+
 int ucs_do_scsi_write(struct ufs_dev *dev, struct scsi_rdwr_req *req)
 {
 	struct scsi_req_build_type     req_upiu;
@@ -336,7 +431,7 @@ int ucs_do_scsi_unmap(struct ufs_dev *dev, struct scsi_unmap_req *req)
 
         /* Flush cdb to memory. */
 	dsb();
-	arch_invalidate_cache_range((addr_t) cdb_param, SCSI_CDB_PARAM_LEN);
+	arch_clean_invalidate_cache_range((addr_t) cdb_param, SCSI_CDB_PARAM_LEN);
 
 	memset((void*)&req_upiu, 0 , sizeof(struct scsi_req_build_type));
 
@@ -372,7 +467,7 @@ int ucs_scsi_send_inquiry(struct ufs_dev *dev)
 
 	/* Flush cdb to memory. */
 	dsb();
-	arch_invalidate_cache_range((addr_t) cdb_param, SCSI_CDB_PARAM_LEN);
+	arch_clean_invalidate_cache_range((addr_t) cdb_param, SCSI_CDB_PARAM_LEN);
 
 	memset(&req_upiu, 0 , sizeof(struct scsi_req_build_type));
 
@@ -411,7 +506,7 @@ static int ucs_do_request_sense(struct ufs_dev *dev)
 	STACKBUF_DMA_ALIGN(cdb, sizeof(struct scsi_sense_cdb));
 	struct scsi_req_build_type req_upiu;
 	struct scsi_sense_cdb      *cdb_param;
-	uint8_t                    buf[SCSI_SENSE_BUF_LEN];
+	STACKBUF_DMA_ALIGN(buf, SCSI_SENSE_BUF_LEN);
 
 	cdb_param = (struct scsi_sense_cdb *) cdb;
 
@@ -422,7 +517,7 @@ static int ucs_do_request_sense(struct ufs_dev *dev)
 
 	/* Flush cdb to memory. */
 	dsb();
-	arch_invalidate_cache_range((addr_t) cdb_param, SCSI_CDB_PARAM_LEN);
+	arch_clean_invalidate_cache_range((addr_t) cdb_param, SCSI_CDB_PARAM_LEN);
 
 	memset(&req_upiu, 0 , sizeof(struct scsi_req_build_type));
 
@@ -439,9 +534,6 @@ static int ucs_do_request_sense(struct ufs_dev *dev)
 		return -UFS_FAILURE;
 	}
 
-	/* Flush buffer. */
-	arch_invalidate_cache_range((addr_t) buf, SCSI_INQUIRY_LEN);
-
 	dump_sense_buffer(buf, SCSI_SENSE_BUF_LEN);
 
 	return UFS_SUCCESS;
@@ -36,9 +36,11 @@
 #include <dme.h>
 #include <qgic.h>
 #include <string.h>
+#include <stdlib.h>
 #include <platform/iomap.h>
 #include <platform/irqs.h>
 #include <kernel/mutex.h>
+#include <boot_stats.h>
 
 static int ufs_dev_init(struct ufs_dev *dev)
 {
@@ -134,6 +136,48 @@ int ufs_read(struct ufs_dev* dev, uint64_t start_lba, addr_t buffer, uint32_t nu
 	return ret;
 }
 
+/* Read from several LUNs with a single door bell write per UTP_MAX_BATCH requests.
+ * The return value covers the batch as a whole, req[i].status the individual reads.
+ */
+int ufs_read_batch(struct ufs_dev* dev, struct ufs_read_req *req, uint32_t count)
+{
+	struct scsi_rdwr_req rdwr[UTP_MAX_BATCH];
+	int                  status[UTP_MAX_BATCH];
+	uint32_t             batch;
+	uint32_t             i;
+	int                  ret;
+
+	while (count)
+	{
+		batch = MIN(count, UTP_MAX_BATCH);
+
+		for (i = 0; i < batch; i++)
+		{
+			rdwr[i].data_buffer_base = req[i].buffer;
+			rdwr[i].lun              = req[i].lun;
+			rdwr[i].num_blocks       = req[i].num_blocks;
+			rdwr[i].start_lba        = req[i].start / dev->block_size;
+			status[i]                = -UFS_FAILURE;
+		}
+
+		ret = ucs_do_scsi_read_batch(dev, rdwr, status, batch);
+		if (ret)
+		{
+			dprintf(CRITICAL, "UFS batch read failed.\n");
+			ufs_dump_hc_registers(dev);
+			return ret;
+		}
+
+		for (i = 0; i < batch; i++)
+			req[i].status = status[i];
+
+		req   += batch;
+		count -= batch;
+	}
+
+	return UFS_SUCCESS;
+}
+
 int ufs_write(struct ufs_dev* dev, uint64_t start_lba, addr_t buffer, uint32_t num_blocks)
 {
 	struct scsi_rdwr_req req;
@@ -220,9 +264,12 @@ int ufs_init(struct ufs_dev *dev)
 {
 	uint32_t ret = UFS_SUCCESS;
 	uint8_t lun = 0;
+	int bs_scope;
 
 	dev->block_size = 4096;
 
+	bs_scope = bs_scope_begin("ufs_init");
+
 	/* Init dev struct. */
 	ret = ufs_dev_init(dev);
 	if (ret != UFS_SUCCESS)
@@ -291,6 +338,8 @@ ufs_init_err:
 		ufs_dump_hc_registers(dev);
 	}
 
+	bs_scope_end(bs_scope);
+
 	return ret;
 }
 
@@ -46,6 +46,7 @@
 #include <smem.h>
 #include <board.h>
 #include <platform/timer.h>
+#include <lib/evtrace.h>
 
 //#define DEBUG_USB
 
@@ -708,6 +709,8 @@ void udc_request_complete(void *context, uint32_t actual, int status)
 	/* clear the queued request. */
 	((udc_t *) context)->queued_req = NULL;
 
+	EVTRACE_USB_COMPLETE(req, actual, status);
+
 	if (req->complete)
 	{
 		req->complete(req, actual, status);
@@ -741,9 +744,14 @@ int usb30_udc_request_queue(struct udc_endpoint *ept, struct udc_request *req)
 
 	DBG("\n udc_request_queue: entry: ep_usb_num = %d", ept->num);
 
+	/* write back tx data and make sure no dirty line can land on rx data */
+	arch_clean_invalidate_cache_range((addr_t) req->buf, req->length);
+
 	/* save the queued request. */
 	udc_dev->queued_req = req;
 
+	EVTRACE_USB_QUEUE(req, req->length);
+
 	ret = dwc_transfer_request(dwc_dev,
 							   ept->num,
 							   ept->in ? DWC_EP_DIRECTION_IN : DWC_EP_DIRECTION_OUT,
@@ -94,6 +94,7 @@ struct udc_endpoint {
 
 struct udc_request *usb30_udc_request_alloc(void);
 struct udc_endpoint *usb30_udc_endpoint_alloc(unsigned type, unsigned maxpkt);
+void usb30_udc_endpoint_free(struct udc_endpoint *ept);
 void usb30_udc_request_free(struct udc_request *req);
 int usb30_udc_request_queue(struct udc_endpoint *ept, struct udc_request *req);
 int usb30_udc_request_cancel(struct udc_endpoint *ept, struct udc_request *req);
@@ -325,7 +325,7 @@ static int utp_enqueue_utrd(struct ufs_dev *dev, struct utp_utrd_req_build_type
 
 		/* Force read UTRD from memory. */
 		dsb();
-		cache_clean_invalidate_unaligned_start_addr((addr_t) desc, sizeof(struct ufs_req_node));
+		cache_clean_invalidate_unaligned_start_addr((addr_t) desc, sizeof(struct utp_trans_req_desc));
 
 		/* Check the response. */
 		if (desc->overall_cmd_status != UTRD_OCS_SUCCESS)
@@ -444,13 +444,17 @@ static void utp_fill_prdt_entries(struct upiu_req_build_type *upiu_data, struct
 
 }
 
-int utp_enqueue_upiu(struct ufs_dev *dev, struct upiu_req_build_type *upiu_data)
+/* Allocate and fill the command descriptor (req upiu, resp upiu and prdt) for upiu_data
+ * and describe it in utrd. On success the descriptor has been flushed to memory and is
+ * owned by the caller.
+ */
+static int utp_build_cmd_desc(struct ufs_dev *dev, struct upiu_req_build_type *upiu_data,
+							  struct utp_utrd_req_build_type *utrd, struct upiu_gen_hdr **cmd_upiu,
+							  uint32_t *cmd_len)
 {
 	struct upiu_gen_hdr            *req_upiu;
-	struct utp_utrd_req_build_type utrd;
 	uint32_t                       num_prdt;
 	struct utp_prdt_entry          *prdt_entry;
-	int                            ret = UFS_SUCCESS;
 	uint32_t                       resp_len;
 	uint32_t                       cmd_desc_len;
 	struct utrd_cmd_desc           cmd_desc;
@@ -475,17 +479,17 @@ int utp_enqueue_upiu(struct ufs_dev *dev, struct upiu_req_build_type *upiu_data)
 	}
 
 	/* Fill req upiu. */
-	ret = utp_fill_req_upiu(dev, upiu_data, req_upiu);
-	if (ret)
+	if (utp_fill_req_upiu(dev, upiu_data, req_upiu))
 	{
-		goto utp_enqueue_upiu_err;
+		free(req_upiu);
+		return -UFS_FAILURE;
 	}
 
 	/* Fill UTRD properties. */
 	cmd_desc.num_prdt      = num_prdt;
 	cmd_desc.req_upiu      = req_upiu;
 	cmd_desc.resp_upiu_len = resp_len;
-	utp_fill_utrd_properties(upiu_data, &utrd, &cmd_desc);
+	utp_fill_utrd_properties(upiu_data, utrd, &cmd_desc);
 
 	prdt_entry         = (struct utp_prdt_entry *) ((uint32_t) req_upiu + UPIU_HDR_LEN + resp_len);
 
@@ -497,6 +501,32 @@ int utp_enqueue_upiu(struct ufs_dev *dev, struct upiu_req_build_type *upiu_data)
 	dsb();
 	arch_clean_invalidate_cache_range((addr_t) req_upiu, cmd_desc_len);
 
+	*cmd_upiu = req_upiu;
+	*cmd_len  = cmd_desc_len;
+
+	return UFS_SUCCESS;
+}
+
+static void utp_save_resp(struct upiu_req_build_type *upiu_data, struct upiu_gen_hdr *req_upiu, uint32_t cmd_desc_len)
+{
+	/* UPIU processed. Invalidate cache to update resp. */
+	arch_invalidate_cache_range((addr_t) req_upiu, cmd_desc_len);
+
+	/* Save the response. */
+	memcpy(upiu_data->resp_ptr, (void *) ((uint32_t)req_upiu + UPIU_HDR_LEN), upiu_data->resp_len);
+	memcpy((void *) upiu_data->resp_data_ptr, (void *) ((uint32_t)req_upiu + 2 * UPIU_HDR_LEN), upiu_data->resp_data_len);
+}
+
+int utp_enqueue_upiu(struct ufs_dev *dev, struct upiu_req_build_type *upiu_data)
+{
+	struct upiu_gen_hdr            *req_upiu;
+	struct utp_utrd_req_build_type utrd;
+	int                            ret = UFS_SUCCESS;
+	uint32_t                       cmd_desc_len;
+
+	if (utp_build_cmd_desc(dev, upiu_data, &utrd, &req_upiu, &cmd_desc_len))
+		return -UFS_FAILURE;
+
 	/* Check the response. */
 	ret = utp_enqueue_utrd(dev, &utrd);
 	if (ret)
@@ -505,14 +535,112 @@ int utp_enqueue_upiu(struct ufs_dev *dev, struct upiu_req_build_type *upiu_data)
 		goto utp_enqueue_upiu_err;
 	}
 
-	/* UPIU processed. Invalidate cache to update resp. */
-	arch_invalidate_cache_range((addr_t) req_upiu, cmd_desc_len);
-
-	/* Save the response. */
-	memcpy(upiu_data->resp_ptr, (void *) ((uint32_t)req_upiu + UPIU_HDR_LEN), upiu_data->resp_len);
-	memcpy((void *) upiu_data->resp_data_ptr, (void *) ((uint32_t)req_upiu + 2 * UPIU_HDR_LEN), upiu_data->resp_data_len);
+	utp_save_resp(upiu_data, req_upiu, cmd_desc_len);
 
 utp_enqueue_upiu_err:
 	free(req_upiu);
 	return ret;
 }
+
+/* Queue up to UTP_MAX_BATCH requests in free UTRD slots and ring the door bell once
+ * for all of them, so the device can work on them back to back instead of idling
+ * between synchronous round trips. status[i] is set to UFS_SUCCESS or -UFS_FAILURE
+ * for every request that was issued; the return value is only non zero when the
+ * batch could not be issued or did not complete.
+ */
+int utp_enqueue_upiu_batch(struct ufs_dev *dev, struct upiu_req_build_type *upiu_data,
+						   int *status, uint32_t count)
+{
+	struct utp_utrd_req_build_type utrd;
+	struct utp_trans_req_desc      *desc[UTP_MAX_BATCH];
+	struct upiu_gen_hdr            *req_upiu[UTP_MAX_BATCH];
+	uint32_t                       cmd_desc_len[UTP_MAX_BATCH];
+	uint32_t                       door_bell_bit[UTP_MAX_BATCH];
+	struct utp_bitmap_access_type  bitmap_req;
+	uint32_t                       pending = 0;
+	uint32_t                       retry = 0;
+	uint32_t                       queued;
+	uint32_t                       i;
+	int                            ret = UFS_SUCCESS;
+
+	if (!count || count > UTP_MAX_BATCH)
+		return -UFS_FAILURE;
+
+	for (queued = 0; queued < count; queued++)
+	{
+		if (utp_build_cmd_desc(dev, &upiu_data[queued], &utrd, &req_upiu[queued], &cmd_desc_len[queued]))
+			break;
+
+		desc[queued] = utp_get_desc_slot_addr(dev, &utrd, &door_bell_bit[queued]);
+		if (!desc[queued])
+		{
+			free(req_upiu[queued]);
+			break;
+		}
+
+		utp_enqueue_utrd_fill_desc(desc[queued], &utrd);
+		pending |= door_bell_bit[queued];
+	}
+
+	if (queued != count || !readl(UFS_UTRLRSR(dev->base)))
+	{
+		dprintf(CRITICAL, "%s:%d Unable to queue %u requests\n", __func__, __LINE__, count);
+		ret = -UFS_FAILURE;
+		goto utp_enqueue_upiu_batch_err;
+	}
+
+	dsb();
+
+	utp_ring_door_bell(UFS_UTRLDBR(dev->base), pending);
+
+	dsb();
+
+	/* The controller clears a door bell bit once that slot has completed. */
+	while (readl(UFS_UTRLDBR(dev->base)) & pending)
+	{
+		retry++;
+		udelay(1);
+		if (retry == UTP_MAX_COMMAND_RETRY)
+		{
+			dprintf(CRITICAL, "%s:%d Batch timeout after polling %d times\n", __func__, __LINE__, UTP_MAX_COMMAND_RETRY);
+			writel(~pending, UFS_UTRLCLR(dev->base));
+			ret = ERR_TIMED_OUT;
+			break;
+		}
+	}
+
+	/* Ack the completion so the next synchronous request does not see it as its own. */
+	writel(UFS_IS_UTRCS, UFS_IS(dev->base));
+
+	if (ret)
+		goto utp_enqueue_upiu_batch_err;
+
+	for (i = 0; i < count; i++)
+	{
+		/* Force read UTRD from memory. */
+		cache_clean_invalidate_unaligned_start_addr((addr_t) desc[i], sizeof(struct utp_trans_req_desc));
+
+		if (desc[i]->overall_cmd_status != UTRD_OCS_SUCCESS)
+		{
+			dprintf(CRITICAL, "%s:%d Command %u of batch failed, ocs = %x\n", __func__, __LINE__, i, desc[i]->overall_cmd_status);
+			status[i] = -UFS_FAILURE;
+			continue;
+		}
+
+		utp_save_resp(&upiu_data[i], req_upiu[i], cmd_desc_len[i]);
+		status[i] = UFS_SUCCESS;
+	}
+
+utp_enqueue_upiu_batch_err:
+	bitmap_req.bitmap = &dev->utrd_data.bitmap;
+	bitmap_req.mutx   = &(dev->utrd_data.bitmap_mutex);
+
+	for (i = 0; i < queued; i++)
+	{
+		bitmap_req.door_bell_bit = door_bell_bit[i];
+		utp_remove_from_bitmap(&bitmap_req);
+		free(req_upiu[i]);
+	}
+
+	return ret;
+}
@@ -0,0 +1,15 @@
+# top level project rules for the pc-x86-fastboot project
+#
+# fastboot over udp on the pcnet interface, e.g.
+#   qemu-system-i386 -kernel build-pc-x86-fastboot/lk.elf \
+#       -netdev user,id=n0,hostfwd=udp::5554-:5554 -device pcnet,netdev=n0
+#   fastboot -s udp:localhost getvar version
+#
+LOCAL_DIR := $(GET_LOCAL_DIR)
+
+ARCH := x86
+TARGET := pc-x86
+FASTBOOT_STANDALONE := 1
+MODULES += \
+	app/aboot \
+	app/shell
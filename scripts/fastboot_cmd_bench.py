@@ -0,0 +1,153 @@
+# Copyright (c) 2024, The Linux Foundation. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above
+#       copyright notice, this list of conditions and the following
+#       disclaimer in the documentation and/or other materials provided
+#       with the distribution.
+#     * Neither the name of The Linux Foundation nor the names of its
+#       contributors may be used to endorse or promote products derived
+#       from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+# WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+# ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+# BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+# BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+# * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+# IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+
+#!/usr/bin/env python3
+
+#
+# Fastboot command dispatch benchmark. Talks to the device directly over
+# USB with pyusb (no fastboot process per command), sends the same short
+# command over and over and reports commands per second and the latency
+# spread. Pair it with a command that does no work on the device, e.g.
+# "getvar:version", to measure the dispatch path.
+#
+
+import sys
+import time
+import getopt
+
+import usb.core
+import usb.util
+
+FASTBOOT_CLASS = 0xff
+FASTBOOT_SUBCLASS = 0x42
+FASTBOOT_PROTOCOL = 0x03
+
+#
+# Find the first fastboot interface and its bulk endpoints
+#
+def fastboot_open():
+	def is_fastboot(intf):
+		return (intf.bInterfaceClass == FASTBOOT_CLASS and
+			intf.bInterfaceSubClass == FASTBOOT_SUBCLASS and
+			intf.bInterfaceProtocol == FASTBOOT_PROTOCOL)
+
+	for dev in usb.core.find(find_all=True):
+		try:
+			cfg = dev.get_active_configuration()
+		except usb.core.USBError:
+			continue
+		for intf in cfg:
+			if not is_fastboot(intf):
+				continue
+			ep_out = usb.util.find_descriptor(intf, custom_match=lambda e:
+				usb.util.endpoint_direction(e.bEndpointAddress) == usb.util.ENDPOINT_OUT)
+			ep_in = usb.util.find_descriptor(intf, custom_match=lambda e:
+				usb.util.endpoint_direction(e.bEndpointAddress) == usb.util.ENDPOINT_IN)
+			usb.util.claim_interface(dev, intf)
+			return dev, ep_out, ep_in
+
+	print("No fastboot device found, please make sure device is in fastboot mode ... [FAIL]")
+	sys.exit(-1)
+
+#
+# Send one command and read responses until OKAY or FAIL
+#
+def fastboot_command(ep_out, ep_in, command, timeout):
+	ep_out.write(command.encode(), timeout)
+	while True:
+		rsp = bytes(ep_in.read(64, timeout))
+		if rsp.startswith(b"OKAY"):
+			return True
+		if rsp.startswith(b"FAIL"):
+			return False
+		if not rsp.startswith(b"INFO"):
+			print("unexpected response:", rsp)
+			return False
+
+def percentile(samples, pct):
+	return samples[min(len(samples) - 1, int(len(samples) * pct / 100))]
+
+#
+# Run the benchmark & print the results
+#
+def bench(command, count, timeout):
+	dev, ep_out, ep_in = fastboot_open()
+	failed = 0
+	samples = []
+
+	# warm up the path once before timing it
+	fastboot_command(ep_out, ep_in, command, timeout)
+
+	start_time = time.perf_counter()
+	for i in range(count):
+		t0 = time.perf_counter()
+		if not fastboot_command(ep_out, ep_in, command, timeout):
+			failed += 1
+		samples.append(time.perf_counter() - t0)
+	elapsed = time.perf_counter() - start_time
+
+	usb.util.dispose_resources(dev)
+
+	samples.sort()
+	print("command:", command)
+	print("commands:", count, "failed:", failed)
+	print("commands/sec: %.1f" % (count / elapsed))
+	print("latency usec: min %.0f p50 %.0f p90 %.0f p99 %.0f max %.0f" % (
+		samples[0] * 1e6, percentile(samples, 50) * 1e6,
+		percentile(samples, 90) * 1e6, percentile(samples, 99) * 1e6,
+		samples[-1] * 1e6))
+	return failed
+
+def usage():
+	print("fastboot_cmd_bench.py [-n <count>] [-t <timeout ms>] [-c <command>]")
+	sys.exit(2)
+
+# Main function to parse i/p args
+def main(argv):
+	command = "getvar:version"
+	count = 1000
+	timeout = 1000
+	try:
+		opts, args = getopt.getopt(argv, "hn:t:c:", ["count=", "timeout=", "command="])
+	except getopt.GetoptError:
+		usage()
+	for opt, arg in opts:
+		if opt == '-h':
+			usage()
+		elif opt in ("-n", "--count"):
+			count = int(arg)
+		elif opt in ("-t", "--timeout"):
+			timeout = int(arg)
+		elif opt in ("-c", "--command"):
+			command = arg
+	if count < 1:
+		usage()
+	sys.exit(1 if bench(command, count, timeout) else 0)
+
+if __name__ == "__main__":
+	main(sys.argv[1:])
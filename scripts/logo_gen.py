@@ -0,0 +1,151 @@
+#!/usr/bin/python
+#
+# Copyright (c) 2015, The Linux Foundation. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above
+#       copyright notice, this list of conditions and the following
+#       disclaimer in the documentation and/or other materials provided
+#       with the distribution.
+#     * Neither the name of The Linux Foundation nor the names of its
+#       contributors may be used to endorse or promote products derived
+#       from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+# WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+# ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+# BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+# BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+# OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+# IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+
+#
+# Generate a splash partition image from a raw RGB888 dump
+#
+#   logo_gen.py [-t raw|rle|lz4] <width> <height> <input.rgb> <splash.img>
+#
+# raw images use the original "SPLASH!!" layout, rle and lz4 images use
+# the "SPLASHZ!" header with the type and payload size filled in. The
+# header is padded to 512 bytes, the payload follows it.
+#
+
+import struct
+import sys
+import getopt
+
+LOGO_IMG_TYPE = { "raw" : 0, "rle" : 1, "lz4" : 2 }
+# LOGO_IMG_HEADER_SIZE in include/dev/fbcon.h, where the payload starts
+LOGO_IMG_HEADER_SIZE = 512
+
+def rle_encode(data, bpp):
+    px = [data[i:i + bpp] for i in range(0, len(data), bpp)]
+    out = bytearray()
+    i = 0
+    n = len(px)
+    while i < n:
+        j = i
+        while j < n and j - i < 128 and px[j] == px[i]:
+            j += 1
+        if j - i >= 2:
+            out.append(0x80 | (j - i - 1))
+            out += px[i]
+            i = j
+            continue
+        j = i + 1
+        while j < n and j - i < 128 and not (j + 1 < n and px[j] == px[j + 1]):
+            j += 1
+        out.append(j - i - 1)
+        for k in range(i, j):
+            out += px[k]
+        i = j
+    return out
+
+def lz4_length(out, n):
+    while n >= 255:
+        out.append(255)
+        n -= 255
+    out.append(n)
+
+def lz4_sequence(out, literals, match_len, offset):
+    lit = len(literals)
+    token = min(lit, 15) << 4
+    if match_len:
+        token |= min(match_len - 4, 15)
+    out.append(token)
+    if lit >= 15:
+        lz4_length(out, lit - 15)
+    out += literals
+    if match_len:
+        out += struct.pack("<H", offset)
+        if match_len - 4 >= 15:
+            lz4_length(out, match_len - 4 - 15)
+
+def lz4_encode(data):
+    # greedy single probe matcher, good enough for splash images
+    out = bytearray()
+    table = {}
+    n = len(data)
+    anchor = 0
+    i = 0
+    # the format wants the last 5 bytes as literals
+    limit = n - 12
+    while i < limit:
+        key = bytes(data[i:i + 4])
+        cand = table.get(key)
+        table[key] = i
+        if cand is None or i - cand > 65535:
+            i += 1
+            continue
+        length = 4
+        while i + length < n - 5 and data[cand + length] == data[i + length]:
+            length += 1
+        lz4_sequence(out, data[anchor:i], length, i - cand)
+        i += length
+        anchor = i
+    lz4_sequence(out, data[anchor:], 0, 0)
+    return out
+
+def main():
+    opts, args = getopt.getopt(sys.argv[1:], "t:")
+    kind = "rle"
+    for o, a in opts:
+        if o == "-t":
+            kind = a
+    if kind not in LOGO_IMG_TYPE or len(args) != 4:
+        print("usage: %s [-t raw|rle|lz4] <width> <height> <input.rgb> <splash.img>" % sys.argv[0])
+        sys.exit(1)
+
+    width = int(args[0])
+    height = int(args[1])
+    data = open(args[2], "rb").read()
+    if len(data) != width * height * 3:
+        print("input is %d bytes, expected %d" % (len(data), width * height * 3))
+        sys.exit(1)
+
+    if kind == "raw":
+        header = struct.pack("<8sIII", b"SPLASH!!", width, height, 0)
+        payload = data
+    else:
+        if kind == "rle":
+            payload = rle_encode(data, 3)
+        else:
+            payload = lz4_encode(data)
+        header = struct.pack("<8sIIIII", b"SPLASHZ!", width, height, 0,
+                             LOGO_IMG_TYPE[kind], len(payload))
+
+    with open(args[3], "wb") as f:
+        f.write(header + b"\0" * (LOGO_IMG_HEADER_SIZE - len(header)))
+        f.write(payload)
+        f.write(b"\0" * (-len(payload) % LOGO_IMG_HEADER_SIZE))
+
+if __name__ == "__main__":
+    main()
@@ -581,6 +581,8 @@ void reboot_device(unsigned reboot_reason)
 {
 	uint8_t reset_type = 0;
 
+	dlog_flush();
+
 	/* Write the reboot reason */
 	writel(reboot_reason, RESTART_REASON_ADDR);
 
@@ -601,6 +603,8 @@ void reboot_device(unsigned reboot_reason)
 
 void shutdown_device()
 {
+	dlog_flush();
+
 	dprintf(CRITICAL, "Going down for shutdown.\n");
 
 	/* Configure PMIC for shutdown. */
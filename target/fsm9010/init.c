@@ -317,6 +317,8 @@ unsigned check_reboot_mode(void)
 
 void reboot_device(unsigned reboot_reason)
 {
+	dlog_flush();
+
 	/* Write the reboot reason */
 	writel(reboot_reason, RESTART_REASON_ADDR);
 
@@ -397,6 +399,8 @@ void target_uninit(void)
 
 void shutdown_device()
 {
+	dlog_flush();
+
 	dprintf(CRITICAL, "Going down for shutdown.\n");
 
 	/* Drop PS_HOLD for MSM */
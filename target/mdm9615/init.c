@@ -247,6 +247,8 @@ unsigned board_machtype(void)
 
 void reboot_device(unsigned reboot_reason)
 {
+	dlog_flush();
+
 	/* Write reboot reason */
 	writel(reboot_reason, RESTART_REASON_ADDR);
 
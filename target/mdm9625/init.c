@@ -154,6 +154,8 @@ void reboot_device(unsigned reboot_reason)
 {
 	uint32_t version = board_soc_version();
 
+	dlog_flush();
+
 	/* Write the reboot reason */
 	if(version >= 0x20000)
 		writel(reboot_reason, RESTART_REASON_ADDR_V2);
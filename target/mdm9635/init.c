@@ -218,6 +218,8 @@ void reboot_device(unsigned reboot_reason)
 {
 	uint8_t reset_type = 0;
 
+	dlog_flush();
+
 	/* Clear the boot partition select cookie to indicate
 	 * its a normal reset and avoid going to download mode */
 	scm_clear_boot_partition_select();
@@ -166,6 +166,8 @@ void target_init(void)
 /* reboot */
 void reboot_device(unsigned reboot_reason)
 {
+	dlog_flush();
+
 	/* Write the reboot reason */
 	writel(reboot_reason, RESTART_REASON_ADDR);
 
@@ -245,6 +245,8 @@ unsigned board_machtype(void)
 
 void reboot_device(unsigned reboot_reason)
 {
+    dlog_flush();
+
     reboot(reboot_reason);
 }
 
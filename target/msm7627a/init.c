@@ -396,6 +396,8 @@ crypto_engine_type board_ce_type(void)
 
 void reboot_device(unsigned reboot_reason)
 {
+	dlog_flush();
+
 	reboot(reboot_reason);
 }
 
@@ -395,6 +395,8 @@ void reboot_device(unsigned reboot_reason)
 {
 	int ret = 0;
 
+	dlog_flush();
+
 	writel(reboot_reason, RESTART_REASON_ADDR);
 
 	/* Configure PMIC for warm reset */
@@ -415,6 +417,8 @@ void reboot_device(unsigned reboot_reason)
 /* Configure PMIC and Drop PS_HOLD for shutdown */
 void shutdown_device()
 {
+	dlog_flush();
+
 	dprintf(CRITICAL, "Going down for shutdown.\n");
 
 	/* Configure PMIC for shutdown */
@@ -379,6 +379,8 @@ void reboot_device(unsigned reboot_reason)
 {
 	int ret = 0;
 
+	dlog_flush();
+
 	writel(reboot_reason, RESTART_REASON_ADDR);
 
 	/* Configure PMIC for warm reset */
@@ -565,6 +567,8 @@ int set_download_mode(enum dload_mode mode)
 /* Configure PMIC and Drop PS_HOLD for shutdown */
 void shutdown_device(void)
 {
+	dlog_flush();
+
 	dprintf(CRITICAL, "Going down for shutdown.\n");
 
 	/* Configure PMIC for shutdown */
@@ -228,6 +228,8 @@ unsigned board_machtype(void)
 
 void shutdown_device()
 {
+	dlog_flush();
+
 	gpio_config_pshold();
 	pm8058_reset_pwr_off(0);
 	pm8901_reset_pwr_off(0);
@@ -239,6 +241,8 @@ void shutdown_device()
 
 void reboot_device(unsigned reboot_reason)
 {
+	dlog_flush();
+
 	/* Reset WDG0 counter */
 	writel(1, MSM_WDT0_RST);
 	/* Disable WDG0 */
@@ -405,6 +405,8 @@ static int scm_dload_mode(int mode)
 /* Configure PMIC and Drop PS_HOLD for shutdown */
 void shutdown_device()
 {
+	dlog_flush();
+
 	dprintf(CRITICAL, "Going down for shutdown.\n");
 
 	/* Configure PMIC for shutdown */
@@ -422,6 +424,8 @@ void reboot_device(unsigned reboot_reason)
 	uint8_t reset_type = 0;
 	uint32_t ret = 0;
 
+	dlog_flush();
+
 	/* Need to clear the SW_RESET_ENTRY register and
 	* write to the BOOT_MISC_REG for known reset cases
 	*/
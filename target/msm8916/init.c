@@ -48,6 +48,7 @@
 #include <crypto5_wrapper.h>
 #include <partition_parser.h>
 #include <stdlib.h>
+#include <init_graph.h>
 
 #if LONG_PRESS_POWER_ON
 #include <shutdown_detect.h>
@@ -185,32 +186,56 @@ uint32_t is_user_force_reset(void)
 }
 #endif
 
-void target_init(void)
+static void target_pmic_init(void)
 {
-	uint32_t base_addr;
-	uint8_t slot;
-
-	dprintf(INFO, "target_init()\n");
+	target_keystatus();
 
-	spmi_init(PMIC_ARB_CHANNEL_NUM, PMIC_ARB_OWNER_ID);
+#if LONG_PRESS_POWER_ON
+	shutdown_detect();
+#endif
 
-	target_keystatus();
+#if PON_VIB_SUPPORT
+	/* turn on vibrator to indicate that phone is booting up to end user */
+	vib_timed_turn_on(VIBRATE_TIME);
+#endif
+}
 
+static void target_storage_init(void)
+{
 	target_sdc_init();
 	if (partition_read_table())
 	{
 		dprintf(CRITICAL, "Error reading the partition table info\n");
 		ASSERT(0);
 	}
+}
 
-#if LONG_PRESS_POWER_ON
-	shutdown_detect();
-#endif
+/* the pmic work and card enumeration share nothing but the cpu */
+static struct init_task pmic_task = {
+	.name = "pmic",
+	.func = target_pmic_init,
+};
 
-#if PON_VIB_SUPPORT
-	/* turn on vibrator to indicate that phone is booting up to end user */
-	vib_timed_turn_on(VIBRATE_TIME);
-#endif
+static struct init_task storage_task = {
+	.name = "storage",
+	.func = target_storage_init,
+};
+
+static struct init_task *target_init_tasks[] = {
+	&storage_task,
+	&pmic_task,
+};
+
+void target_init(void)
+{
+	uint32_t base_addr;
+	uint8_t slot;
+
+	dprintf(INFO, "target_init()\n");
+
+	spmi_init(PMIC_ARB_CHANNEL_NUM, PMIC_ARB_OWNER_ID);
+
+	init_graph_run(target_init_tasks, ARRAY_SIZE(target_init_tasks));
 
 	if (target_use_signed_kernel())
 		target_crypto_init_params();
@@ -267,6 +292,8 @@ static int scm_dload_mode(int mode)
 /* Configure PMIC and Drop PS_HOLD for shutdown */
 void shutdown_device()
 {
+	dlog_flush();
+
 	dprintf(CRITICAL, "Going down for shutdown.\n");
 
 	/* Configure PMIC for shutdown */
@@ -287,6 +314,8 @@ void reboot_device(unsigned reboot_reason)
 	uint8_t reset_type = 0;
 	uint32_t ret = 0;
 
+	dlog_flush();
+
 	/* Need to clear the SW_RESET_ENTRY register and
 	 * write to the BOOT_MISC_REG for known reset cases
 	 */
@@ -14,6 +14,9 @@ SCRATCH_ADDR     := 0x90000000
 DEFINES += DISPLAY_SPLASH_SCREEN=1
 DEFINES += DISPLAY_TYPE_MIPI=1
 DEFINES += DISPLAY_TYPE_DSI6G=1
+# the display bring-up only touches spmi, clocks and rpm here, all of which
+# lock, so aboot may run it on its own thread next to the boot image load
+DEFINES += DISPLAY_INIT_TASK=1
 
 MODULES += \
 	dev/keys \
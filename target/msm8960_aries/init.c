@@ -83,6 +83,8 @@ void target_early_init(void)
 
 void shutdown_device(void)
 {
+	dlog_flush();
+
 	dprintf(CRITICAL, "Shutdown system.\n");
 	pm8921_config_reset_pwr_off(0);
 
@@ -212,6 +214,8 @@ int set_download_mode(enum dload_mode mode)
 
 void reboot_device(unsigned reboot_reason)
 {
+	dlog_flush();
+
 	writel(reboot_reason, RESTART_REASON_ADDR);
 
 	/* Actually reset the chip */
@@ -511,6 +511,8 @@ void reboot_device(unsigned reboot_reason)
 	uint32_t soc_ver = 0;
 	uint8_t reset_type = 0;
 
+	dlog_flush();
+
 	soc_ver = board_soc_version();
 
 	/* Write the reboot reason */
@@ -693,6 +695,8 @@ void target_uninit(void)
 
 void shutdown_device()
 {
+	dlog_flush();
+
 	dprintf(CRITICAL, "Going down for shutdown.\n");
 
 	/* Configure PMIC for shutdown. */
@@ -436,6 +436,8 @@ void reboot_device(unsigned reboot_reason)
 {
 	uint8_t reset_type = 0;
 
+	dlog_flush();
+
 	/* Write the reboot reason */
 	writel(reboot_reason, RESTART_REASON_ADDR);
 
@@ -542,6 +544,8 @@ crypto_engine_type board_ce_type(void)
 
 void shutdown_device()
 {
+	dlog_flush();
+
 	dprintf(CRITICAL, "Going down for shutdown.\n");
 
 	/* Configure PMIC for shutdown. */
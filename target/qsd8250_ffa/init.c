@@ -162,6 +162,8 @@ unsigned board_machtype(void)
 
 void reboot_device(unsigned reboot_reason)
 {
+    dlog_flush();
+
     reboot(reboot_reason);
 }
 
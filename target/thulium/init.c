@@ -289,6 +289,8 @@ void reboot_device(unsigned reboot_reason)
 {
 	uint8_t reset_type = 0;
 
+	dlog_flush();
+
 	/* Write the reboot reason */
 	writel(reboot_reason, RESTART_REASON_ADDR);
 
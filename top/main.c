@@ -131,6 +131,10 @@ void lk_main(void)
 
 static int bootstrap2(void *arg)
 {
+#if WITH_PLATFORM_MSM_SHARED
+	int bs_scope;
+#endif
+
 	dprintf(SPEW, "top of bootstrap2()\n");
 
 	lk_init_level(LK_INIT_LEVEL_ARCH - 1);
@@ -139,12 +143,24 @@ static int bootstrap2(void *arg)
 	// initialize the rest of the platform
 	dprintf(SPEW, "initializing platform\n");
 	lk_init_level(LK_INIT_LEVEL_PLATFORM - 1);
+#if WITH_PLATFORM_MSM_SHARED
+	bs_scope = bs_scope_begin("platform_init");
+#endif
 	platform_init();
+#if WITH_PLATFORM_MSM_SHARED
+	bs_scope_end(bs_scope);
+#endif
 
 	// initialize the target
 	dprintf(SPEW, "initializing target\n");
 	lk_init_level(LK_INIT_LEVEL_TARGET - 1);
+#if WITH_PLATFORM_MSM_SHARED
+	bs_scope = bs_scope_begin("target_init");
+#endif
 	target_init();
+#if WITH_PLATFORM_MSM_SHARED
+	bs_scope_end(bs_scope);
+#endif
 
 	dprintf(SPEW, "calling apps_init()\n");
 	lk_init_level(LK_INIT_LEVEL_APPS - 1);